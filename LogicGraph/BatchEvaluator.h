@@ -0,0 +1,195 @@
+/// Asynchronous evaluation of input vector batches on a worker pool.
+#ifndef LOGIC_BATCH_EVALUATOR
+#define LOGIC_BATCH_EVALUATOR
+
+#include "Netlist.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Evaluates batches of input vectors against a snapshot of a logic graph
+    /// without blocking the caller. A batch is cut into slices that the workers
+    /// simulate 64 vectors at a time, so consecutive batches overlap and keep
+    /// every worker busy.
+    /// </summary>
+    class BatchEvaluator
+    {
+    public:
+
+        typedef LogicGraph::SByte SByte;
+        typedef Netlist::Word Word;
+
+        /// <summary>
+        /// Called on a worker thread once every result of a batch is written.
+        /// </summary>
+        typedef void (*Callback)(void* user);
+
+        /// <summary>
+        /// The progress of one submitted batch.
+        /// </summary>
+        class Batch
+        {
+        public:
+
+            Batch(const Batch&) = delete;
+            Batch& operator=(const Batch&) = delete;
+
+            bool isDone() const
+            {
+                return remaining.load() == 0;
+            }
+
+            /// <summary>
+            /// Blocks until the batch is done or the timeout passes; a negative timeout waits for good.
+            /// </summary>
+            /// <returns>
+            /// Whether the batch is done.
+            /// </returns>
+            bool wait(int timeoutMs = -1)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+
+                if(timeoutMs < 0){
+
+                    done.wait(lock,[this]{ return isDone(); });
+                    return true;
+                }
+
+                return done.wait_for(lock,std::chrono::milliseconds(timeoutMs),[this]{ return isDone(); });
+            }
+
+            unsigned getVectorCount() const
+            {
+                return vectorCount;
+            }
+
+        private:
+
+            friend class BatchEvaluator;
+
+            Batch(const char* v,unsigned count,unsigned inCount,SByte* r,Callback c,void* u)
+                : vectors(v,(size_t)count * inCount),vectorCount(count),results(r),callback(c),user(u),remaining(0)
+            {
+            }
+
+            /// <summary>
+            /// Marks one slice done; the last one wakes the waiters and calls back.
+            /// </summary>
+            void finishSlice()
+            {
+                if(--remaining != 0) return;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                }
+
+                done.notify_all();
+
+                if(callback != nullptr) callback(user);
+            }
+
+            std::string vectors;
+            unsigned vectorCount;
+            SByte* results;
+            Callback callback;
+            void* user;
+            std::atomic<unsigned> remaining;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        BatchEvaluator() = delete;
+
+        /// <params>
+        /// threadCount: The number of workers; 0 for one per hardware thread.
+        /// </params>
+        explicit BatchEvaluator(const LogicGraph& graph,unsigned threadCount = 0) : netlist(graph),pool(threadCount)
+        {
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        /// <summary>
+        /// Queues a batch and returns at once. The vectors are copied; the results are
+        /// written in place as the workers get to them.
+        /// </summary>
+        /// <params>
+        /// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back.
+        /// results: Room for vectorCount * output count values, kept alive until the batch is done.
+        /// Vector v, output o lands at v * output count + o, coded as LogicGraph.getOutput.
+        /// callback: Null, or called on a worker thread once the batch is done.
+        /// </params>
+        std::shared_ptr<Batch> submit(const char* vectors,unsigned vectorCount,SByte* results,Callback callback = nullptr,void* user = nullptr)
+        {
+            std::shared_ptr<Batch> batch(new Batch(vectors,vectorCount,netlist.getInputCount(),results,callback,user));
+
+            unsigned slices = (vectorCount + SLICE - 1) / SLICE;
+
+            if(slices == 0){
+
+                batch->remaining = 1;
+                batch->finishSlice();
+                return batch;
+            }
+
+            batch->remaining = slices;
+
+            for(unsigned s = 0; s < slices; ++s){
+
+                pool.post([this,batch,s]{
+                    evaluate(*batch,s * SLICE,std::min(batch->vectorCount,(s + 1) * SLICE));
+                    batch->finishSlice();
+                });
+            }
+
+            return batch;
+        }
+
+    private:
+
+        /// <summary>
+        /// Vectors per task: enough to amortize the queue, few enough to spread a batch over the workers.
+        /// </summary>
+        static const unsigned SLICE = 64 * 16;
+
+        void evaluate(Batch& batch,unsigned first,unsigned last) const
+        {
+            Tracer::Span span("batch slice");
+            unsigned inCount = netlist.getInputCount();
+            unsigned outCount = netlist.getOutputCount();
+            std::vector<Word> inputWords(inCount);
+            std::vector<Word> values(netlist.size());
+
+            for(unsigned v = first; v < last; v += 64){
+
+                unsigned patterns = std::min(64u,last - v);
+
+                netlist.packInputs(batch.vectors.data() + (size_t)v * inCount,patterns,inputWords.data());
+                netlist.simulate(inputWords.data(),values.data());
+
+                for(unsigned p = 0; p < patterns; ++p){
+
+                    SByte* row = batch.results + (size_t)(v + p) * outCount;
+
+                    for(unsigned o = 0; o < outCount; ++o){
+
+                        row[o] = netlist.getOutput(o,values.data(),p);
+                    }
+                }
+            }
+        }
+
+        Netlist netlist;
+        WorkerPool pool;
+    };
+}
+
+#endif//LOGIC_BATCH_EVALUATOR
@@ -0,0 +1,268 @@
+/// Tseitin encoding of a netlist into the SAT solver.
+#ifndef LOGIC_CNF
+#define LOGIC_CNF
+
+#include "Netlist.h"
+#include "Solver.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Encodes the nodes of a netlist as solver literals, a cone at a time.
+    /// A node is encoded the first time its literal is asked for, together with
+    /// whatever part of its cone has not been encoded yet.
+    /// </summary>
+    class Cnf
+    {
+    public:
+
+        typedef Solver::Lit Lit;
+
+        Cnf() = delete;
+
+        Cnf(const Netlist& netlist,Solver& solver) : netlist(netlist),solver(solver)
+        {
+            lits.resize(netlist.size(),(Lit)UNENCODED);
+            trueLit = (Lit)UNENCODED;
+        }
+
+        /// <summary>
+        /// Uses an existing literal for a node, typically to share inputs between two netlists.
+        /// Must be called before the node is encoded.
+        /// </summary>
+        void bind(unsigned n,Lit l)
+        {
+            lits[n] = l;
+        }
+
+        bool isEncoded(unsigned n) const
+        {
+            return lits[n] >= 0;
+        }
+
+        /// <summary>
+        /// Returns the literal of a node, encoding its cone first if need be.
+        /// </summary>
+        Lit literal(unsigned n)
+        {
+            if(lits[n] >= 0) return lits[n];
+
+            std::vector<unsigned> stack(1,n);
+            std::vector<unsigned> cone;
+
+            while(!stack.empty()){
+
+                unsigned m = stack.back();
+                stack.pop_back();
+
+                if(lits[m] != (Lit)UNENCODED) continue;
+
+                lits[m] = (Lit)PENDING;
+                cone.push_back(m);
+
+                for(unsigned i = 0; i < netlist.getFanInCount(m); ++i){
+
+                    stack.push_back(netlist.getFanIn(m)[i]);
+                }
+            }
+
+            //Netlist order is topological, so this encodes inputs before the gates they feed.
+            std::sort(cone.begin(),cone.end());
+
+            for(auto m : cone){
+
+                lits[m] = encode(m);
+            }
+
+            return lits[n];
+        }
+
+        /// <summary>
+        /// Returns a literal fixed to the value.
+        /// </summary>
+        Lit constant(bool value)
+        {
+            if(trueLit == (Lit)UNENCODED){
+
+                trueLit = Solver::mkLit(solver.newVar());
+                solver.addClause(std::vector<Lit>(1,trueLit));
+            }
+
+            return value ? trueLit : trueLit ^ 1;
+        }
+
+        /// <summary>
+        /// Returns a literal equal to the conjunction of the literals.
+        /// </summary>
+        Lit conjunction(const std::vector<Lit>& xs)
+        {
+            std::vector<Lit> kept;
+
+            for(auto x : xs){
+
+                if(x == trueLit) continue;
+                if(trueLit != (Lit)UNENCODED && x == (trueLit ^ 1)) return x;
+                kept.push_back(x);
+            }
+
+            if(kept.empty()) return constant(true);
+            if(kept.size() == 1) return kept[0];
+
+            Lit y = Solver::mkLit(solver.newVar());
+            std::vector<Lit> clause(1,y);
+
+            for(auto x : kept){
+
+                Lit pair[] = {y ^ 1,x};
+                solver.addClause(std::vector<Lit>(pair,pair + 2));
+                clause.push_back(x ^ 1);
+            }
+
+            solver.addClause(clause);
+
+            return y;
+        }
+
+        /// <summary>
+        /// Returns a literal equal to the disjunction of the literals.
+        /// </summary>
+        Lit disjunction(const std::vector<Lit>& xs)
+        {
+            std::vector<Lit> negated;
+
+            for(auto x : xs) negated.push_back(x ^ 1);
+
+            return conjunction(negated) ^ 1;
+        }
+
+        /// <summary>
+        /// Returns a literal equal to the exclusive or of two literals.
+        /// </summary>
+        Lit exclusive(Lit a,Lit b)
+        {
+            Lit y = Solver::mkLit(solver.newVar());
+            Lit clauses[4][3] = {
+                {y ^ 1,a,b},
+                {y ^ 1,a ^ 1,b ^ 1},
+                {y,a ^ 1,b},
+                {y,a,b ^ 1}
+            };
+
+            for(auto& c : clauses) solver.addClause(std::vector<Lit>(c,c + 3));
+
+            return y;
+        }
+
+    private:
+
+        enum : Lit
+        {
+            UNENCODED = -1,
+            PENDING = -2
+        };
+
+        Lit encode(unsigned n)
+        {
+            unsigned count = netlist.getFanInCount(n);
+            const unsigned* f = netlist.getFanIn(n);
+            std::vector<Lit> xs;
+
+            for(unsigned i = 0; i < count; ++i) xs.push_back(lits[f[i]]);
+
+            switch(netlist.getOp(n)){
+            case Netlist::INPUT:  return Solver::mkLit(solver.newVar());
+            case Netlist::BUF:    return xs[0];
+            case Netlist::NOT:    return xs[0] ^ 1;
+            case Netlist::AND:    return conjunction(xs);
+            case Netlist::NAND:   return conjunction(xs) ^ 1;
+            case Netlist::OR:     return disjunction(xs);
+            case Netlist::NOR:    return disjunction(xs) ^ 1;
+            case Netlist::CONST0: return constant(false);
+            case Netlist::CONST1: return constant(true);
+            case Netlist::XOR:    return parity(xs);
+            case Netlist::XNOR:   return parity(xs) ^ 1;
+            case Netlist::LUT:
+            case Netlist::MUX:    return lut(n,xs);
+            default:              return symmetric(n,xs);
+            }
+        }
+
+        /// <summary>
+        /// Encodes a gate that depends only on how many of its inputs are true,
+        /// through a unary counter: atLeast[k] holds when k or more inputs seen so far are true.
+        /// </summary>
+        Lit symmetric(unsigned n,const std::vector<Lit>& xs)
+        {
+            unsigned count = (unsigned)xs.size();
+            std::vector<Lit> atLeast(count + 2,constant(false));
+
+            atLeast[0] = constant(true);
+
+            for(unsigned i = 0; i < count; ++i){
+
+                for(unsigned k = i + 1; k >= 1; --k){
+
+                    Lit both[] = {atLeast[k - 1],xs[i]};
+                    Lit either[] = {atLeast[k],conjunction(std::vector<Lit>(both,both + 2))};
+                    atLeast[k] = disjunction(std::vector<Lit>(either,either + 2));
+                }
+            }
+
+            std::vector<Lit> matches;
+
+            for(unsigned t = 0; t <= count; ++t){
+
+                if(!netlist.getTableEntry(n,t)) continue;
+
+                Lit exactly[] = {atLeast[t],atLeast[t + 1] ^ 1};
+                matches.push_back(conjunction(std::vector<Lit>(exactly,exactly + 2)));
+            }
+
+            return disjunction(matches);
+        }
+
+        /// <summary>
+        /// Encodes a parity gate as a chain of two-input exclusive ors.
+        /// </summary>
+        Lit parity(const std::vector<Lit>& xs)
+        {
+            Lit y = xs[0];
+
+            for(unsigned i = 1; i < xs.size(); ++i) y = exclusive(y,xs[i]);
+
+            return y;
+        }
+
+        /// <summary>
+        /// Encodes a lookup table as one clause per row.
+        /// </summary>
+        Lit lut(unsigned n,const std::vector<Lit>& xs)
+        {
+            Netlist::Word table = netlist.getLutTable(n);
+            Lit y = Solver::mkLit(solver.newVar());
+            std::vector<Lit> row;
+
+            for(unsigned m = 0; m < (1u << xs.size()); ++m){
+
+                row.clear();
+
+                for(unsigned i = 0; i < xs.size(); ++i){
+
+                    row.push_back((m >> i) & 1 ? xs[i] ^ 1 : xs[i]);
+                }
+
+                row.push_back((table >> m) & 1 ? y : y ^ 1);
+                solver.addClause(row);
+            }
+
+            return y;
+        }
+
+        const Netlist& netlist;
+        Solver& solver;
+        std::vector<Lit> lits;
+        Lit trueLit;
+    };
+}
+
+#endif//LOGIC_CNF
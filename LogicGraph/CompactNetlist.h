@@ -0,0 +1,478 @@
+/// A compressed, read-only netlist for designs too large for the node graph.
+#ifndef LOGIC_COMPACT_NETLIST
+#define LOGIC_COMPACT_NETLIST
+
+#include "Netlist.h"
+#include <map>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// The nodes of a netlist in topological order, packed to a few bytes each, and
+    /// simulated 64 patterns at a time straight from the packed form.
+    /// Input i is node i. Every other node has a kernel byte and an entry in one byte
+    /// stream: its fan-in count, the distance back to each of its inputs, and for a
+    /// LUT, SYMMETRIC or THRESHOLD node its table index or bound, all as LEB128 varints,
+    /// so a gate reading nearby nodes takes about as many bytes as it has inputs.
+    /// The stream offset of every 64th node is kept for random access.
+    /// Node indices are 64-bit. Netlists come from a Netlist or a LogicGraph, or node by
+    /// node from a Builder, which is how importers should make them.
+    /// </summary>
+    class CompactNetlist
+    {
+    public:
+
+        typedef Netlist::Op Op;
+        typedef Netlist::Word Word;
+        typedef LogicGraph::SByte SByte;
+        typedef uint64_t Index;
+
+        static const Index NONE = ~(Index)0;
+
+        /// <summary>
+        /// Appends nodes in topological order and hands the finished netlist over.
+        /// </summary>
+        class Builder
+        {
+        public:
+
+            Builder() = delete;
+
+            Builder(Index inputCount,Index outputCount)
+                : netlist(new CompactNetlist(inputCount,outputCount))
+            {
+            }
+
+            /// <summary>
+            /// Appends a node reading earlier nodes.
+            /// </summary>
+            /// <params>
+            /// param: The bound k of a THRESHOLD, or the table of a LUT as LogicGraph.addLut.
+            /// </params>
+            /// <returns>
+            /// The node's index, or NONE if an input is not an earlier node, op is INPUT or
+            /// SYMMETRIC, a LUT has more than 6 inputs or a MUX other than 3 or 6.
+            /// A node without inputs is in error, as is one reading a node in error.
+            /// </returns>
+            Index add(Op op,const Index* fanIn,unsigned count,Word param = 0)
+            {
+                if(op == Netlist::INPUT || op == Netlist::SYMMETRIC) return NONE;
+                if(op == Netlist::LUT && count > 6) return NONE;
+                if(op == Netlist::MUX && count != 3 && count != 6) return NONE;
+
+                return append(op,fanIn,count,param,nullptr);
+            }
+
+            /// <summary>
+            /// Appends a SYMMETRIC node, true when table[t] is nonzero for t true inputs.
+            /// </summary>
+            /// <params>
+            /// table: count + 1 entries.
+            /// </params>
+            Index addSymmetric(const Index* fanIn,unsigned count,const unsigned char* table)
+            {
+                return append(Netlist::SYMMETRIC,fanIn,count,0,table);
+            }
+
+            /// <returns>
+            /// False if there is no such output or node.
+            /// </returns>
+            bool setOutput(Index index,Index node)
+            {
+                if(index >= netlist->outputs.size() || (node >= netlist->size() && node != NONE)) return false;
+
+                netlist->outputs[index] = node;
+                return true;
+            }
+
+            Index size() const
+            {
+                return netlist->size();
+            }
+
+            /// <summary>
+            /// Returns the netlist built so far and leaves the builder empty.
+            /// </summary>
+            CompactNetlist finish()
+            {
+                netlist->ops.shrink_to_fit();
+                netlist->stream.shrink_to_fit();
+                netlist->marks.shrink_to_fit();
+
+                CompactNetlist done(std::move(*netlist));
+
+                netlist.reset(new CompactNetlist(0,0));
+                lutIndex.clear();
+                tableIndex.clear();
+
+                return done;
+            }
+
+        private:
+
+            friend class CompactNetlist;
+
+            Index append(Op op,const Index* fanIn,unsigned count,Word param,const unsigned char* table)
+            {
+                Index n = netlist->size();
+                bool error = count == 0;
+
+                for(unsigned i = 0; i < count; ++i){
+
+                    if(fanIn[i] >= n) return NONE;
+
+                    error = error || (netlist->ops[fanIn[i]] & ERROR) != 0;
+                }
+
+                if(n % MARK_SPACING == 0) netlist->marks.push_back(netlist->stream.size());
+
+                netlist->ops.push_back((unsigned char)(op | (error ? ERROR : 0)));
+                netlist->maxFanIn = std::max(netlist->maxFanIn,count);
+                put(count);
+
+                for(unsigned i = 0; i < count; ++i) put(n - fanIn[i]);
+
+                if(op == Netlist::THRESHOLD) put(param);
+                else if(op == Netlist::LUT){
+
+                    auto a = lutIndex.find(param);
+
+                    if(a == lutIndex.end()){
+
+                        a = lutIndex.insert(std::make_pair(param,(Index)netlist->luts.size())).first;
+                        netlist->luts.push_back(param);
+                    }
+
+                    put(a->second);
+                }
+                else if(op == Netlist::SYMMETRIC){
+
+                    std::vector<unsigned char> entries(count + 1);
+
+                    for(unsigned t = 0; t <= count; ++t) entries[t] = table[t] ? 1 : 0;
+
+                    auto a = tableIndex.find(entries);
+
+                    if(a == tableIndex.end()){
+
+                        a = tableIndex.insert(std::make_pair(entries,(Index)netlist->tables.size())).first;
+                        netlist->tables.insert(netlist->tables.end(),entries.begin(),entries.end());
+                    }
+
+                    put(a->second);
+                }
+
+                return n;
+            }
+
+            void put(Index v)
+            {
+                while(v >= 0x80){
+
+                    netlist->stream.push_back((unsigned char)(v | 0x80));
+                    v >>= 7;
+                }
+
+                netlist->stream.push_back((unsigned char)v);
+            }
+
+            //Held by pointer, as the enclosing class is not complete here.
+            std::unique_ptr<CompactNetlist> netlist;
+            std::unordered_map<Word,Index> lutIndex;
+            std::map<std::vector<unsigned char>,Index> tableIndex;
+        };
+
+        CompactNetlist() = delete;
+
+        explicit CompactNetlist(const Netlist& source)
+            : CompactNetlist(0,0)
+        {
+            Tracer::Span span("compress netlist");
+            Builder builder(source.getInputCount(),source.getOutputCount());
+            std::vector<Index> fanIn;
+            std::vector<unsigned char> table;
+
+            for(unsigned n = source.getInputCount(); n < source.size(); ++n){
+
+                unsigned count = source.getFanInCount(n);
+                Op op = source.getOp(n);
+                Word param = 0;
+
+                fanIn.assign(source.getFanIn(n),source.getFanIn(n) + count);
+
+                if(op == Netlist::SYMMETRIC){
+
+                    table.resize(count + 1);
+
+                    for(unsigned t = 0; t <= count; ++t) table[t] = source.getTableEntry(n,t) ? 1 : 0;
+
+                    builder.addSymmetric(fanIn.data(),count,table.data());
+                    continue;
+                }
+
+                if(op == Netlist::THRESHOLD){
+
+                    while(param <= count && !source.getTableEntry(n,(unsigned)param)) ++param;
+                }
+                else if(op == Netlist::LUT) param = source.getLutTable(n);
+
+                builder.append(op,fanIn.data(),count,param,nullptr);
+            }
+
+            for(unsigned o = 0; o < source.getOutputCount(); ++o){
+
+                unsigned n = source.getOutputNode(o);
+
+                builder.setOutput(o,n == Netlist::NONE ? NONE : n);
+            }
+
+            *this = builder.finish();
+        }
+
+        explicit CompactNetlist(const LogicGraph& graph)
+            : CompactNetlist(Netlist(graph))
+        {
+        }
+
+        Index size() const
+        {
+            return ops.size();
+        }
+
+        Index getInputCount() const
+        {
+            return inputCount;
+        }
+
+        Index getOutputCount() const
+        {
+            return outputs.size();
+        }
+
+        /// <summary>
+        /// Returns the node bound to the indexed output, or NONE if it is closed.
+        /// </summary>
+        Index getOutputNode(Index index) const
+        {
+            return outputs[index];
+        }
+
+        Op getOp(Index n) const
+        {
+            return (Op)(ops[n] & ~ERROR);
+        }
+
+        /// <summary>
+        /// Returns the error the graph would report for the node.
+        /// </summary>
+        /// <returns>
+        ///  0: The node has a value.
+        /// -1: No inputs, here or in a higher node (as Node.output)
+        /// </returns>
+        SByte getStatus(Index n) const
+        {
+            return ops[n] & ERROR ? -1 : 0;
+        }
+
+        /// <summary>
+        /// Decodes a node's inputs.
+        /// </summary>
+        /// <params>
+        /// fanIn: Room for getMaxFanIn() indices.
+        /// </params>
+        /// <returns>
+        /// The number of inputs.
+        /// </returns>
+        unsigned getFanIn(Index n,Index* fanIn) const
+        {
+            if(n < inputCount) return 0;
+
+            const unsigned char* p = stream.data() + marks[n / MARK_SPACING];
+
+            for(Index m = n - n % MARK_SPACING; m < n; ++m) skip(m,p);
+
+            unsigned count = (unsigned)get(p);
+
+            for(unsigned i = 0; i < count; ++i) fanIn[i] = n - get(p);
+
+            return count;
+        }
+
+        unsigned getMaxFanIn() const
+        {
+            return maxFanIn;
+        }
+
+        /// <summary>
+        /// Returns the bytes the netlist takes, its fixed parts included.
+        /// </summary>
+        size_t getByteSize() const
+        {
+            return sizeof(*this) + ops.capacity() + stream.capacity() + marks.capacity() * sizeof(size_t) +
+                luts.capacity() * sizeof(Word) + tables.capacity() + outputs.capacity() * sizeof(Index);
+        }
+
+        /// <summary>
+        /// Evaluates every node. values must hold size() words; the first
+        /// getInputCount() words are taken from inputWords.
+        /// </summary>
+        void simulate(const Word* inputWords,Word* values) const
+        {
+            std::vector<Word> words(maxFanIn);
+            const unsigned char* p = stream.data();
+            auto fetch = [&](unsigned i){ return words[i]; };
+
+            std::copy(inputWords,inputWords + inputCount,values);
+
+            for(Index n = inputCount; n < ops.size(); ++n){
+
+                Op op = getOp(n);
+                unsigned count = (unsigned)get(p);
+
+                for(unsigned i = 0; i < count; ++i) words[i] = values[n - get(p)];
+
+                switch(op){
+                case Netlist::THRESHOLD:
+                    values[n] = Netlist::evaluateOp(op,count,fetch,(unsigned)get(p),nullptr,0);
+                    break;
+
+                case Netlist::LUT:
+                    values[n] = Netlist::evaluateOp(op,count,fetch,0,nullptr,luts[get(p)]);
+                    break;
+
+                case Netlist::SYMMETRIC:
+                    values[n] = Netlist::evaluateOp(op,count,fetch,0,tables.data() + get(p),0);
+                    break;
+
+                default:
+                    values[n] = Netlist::evaluateOp(op,count,fetch,0,nullptr,0);
+                    break;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Returns the indexed output for one pattern of a simulated value array.
+        /// </summary>
+        /// <returns>
+        ///  0: False
+        ///  1: True
+        /// -1: No inputs (from Node.output)
+        /// -3: An output does not exist.
+        /// </returns>
+        SByte getOutput(Index index,const Word* values,unsigned pattern) const
+        {
+            Index n = outputs[index];
+
+            if(n == NONE) return -3;
+
+            if(getStatus(n) < 0) return getStatus(n);
+
+            return (values[n] >> pattern) & 1 ? 1 : 0;
+        }
+
+        /// <summary>
+        /// Simulates pattern strings of '0'/'1' (as LogicGraph.feedInputString), back to back.
+        /// Vector v, output o lands at results[v * getOutputCount() + o], coded as getOutput.
+        /// </summary>
+        /// <returns>
+        /// The number of vectors simulated.
+        /// </returns>
+        size_t run(const char* vectors,size_t count,SByte* results) const
+        {
+            std::vector<Word> inputWords(inputCount);
+            std::vector<Word> values(ops.size());
+            Index outCount = outputs.size();
+
+            for(size_t base = 0; base < count; base += 64){
+
+                unsigned block = (unsigned)std::min<size_t>(64,count - base);
+
+                std::fill(inputWords.begin(),inputWords.end(),0);
+
+                for(unsigned b = 0; b < block; ++b){
+
+                    const char* v = vectors + (base + b) * inputCount;
+
+                    for(Index i = 0; i < inputCount; ++i){
+
+                        if(v[i] == '1') inputWords[i] |= (Word)1 << b;
+                    }
+                }
+
+                simulate(inputWords.data(),values.data());
+
+                for(unsigned b = 0; b < block; ++b){
+
+                    for(Index o = 0; o < outCount; ++o) results[(base + b) * outCount + o] = getOutput(o,values.data(),b);
+                }
+            }
+
+            return count;
+        }
+
+    private:
+
+        static const unsigned char ERROR = 0x80;
+
+        static const unsigned MARK_SPACING = 64;
+
+        /// <summary>
+        /// Inputs take no stream bytes, so input count nodes and empty room for the rest.
+        /// </summary>
+        CompactNetlist(Index inputCount,Index outputCount)
+            : inputCount(inputCount),ops((size_t)inputCount,(unsigned char)Netlist::INPUT),outputs((size_t)outputCount,NONE)
+        {
+            maxFanIn = 0;
+
+            //Blocks of inputs only start at the beginning of the stream.
+            for(Index n = 0; n < inputCount; n += MARK_SPACING) marks.push_back(0);
+        }
+
+        static Index get(const unsigned char*& p)
+        {
+            Index v = 0;
+
+            for(unsigned shift = 0;; shift += 7){
+
+                unsigned char b = *p++;
+
+                v |= (Index)(b & 0x7F) << shift;
+
+                if(b < 0x80) return v;
+            }
+        }
+
+        /// <summary>
+        /// Moves past the stream entry of node n.
+        /// </summary>
+        void skip(Index n,const unsigned char*& p) const
+        {
+            if(n < inputCount) return;
+
+            unsigned count = (unsigned)get(p);
+            Op op = getOp(n);
+
+            if(op == Netlist::THRESHOLD || op == Netlist::LUT || op == Netlist::SYMMETRIC) ++count;
+
+            for(unsigned i = 0; i < count; ++i) get(p);
+        }
+
+        Index inputCount;
+        unsigned maxFanIn;
+        std::vector<unsigned char> ops;
+        std::vector<unsigned char> stream;
+        std::vector<size_t> marks;
+        std::vector<Word> luts;
+        std::vector<unsigned char> tables;
+        std::vector<Index> outputs;
+    };
+
+    const CompactNetlist::Index CompactNetlist::NONE;
+
+    const unsigned char CompactNetlist::ERROR;
+
+    const unsigned CompactNetlist::MARK_SPACING;
+}
+
+#endif//LOGIC_COMPACT_NETLIST
@@ -0,0 +1,158 @@
+/// Combinational equivalence checking between two logic graphs.
+#ifndef LOGIC_EQUIVALENCE
+#define LOGIC_EQUIVALENCE
+
+#include "Cnf.h"
+#include <random>
+#include <string>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Checks that two graphs compute the same outputs for every input.
+    /// Random bit-parallel simulation looks for a difference first; the output
+    /// pairs it cannot tell apart are then proven or refuted one at a time on a
+    /// miter in the SAT solver, which keeps what it learns between pairs.
+    /// </summary>
+    /// <params>
+    /// inputMap: For each input of a, the input of b it drives, or -1. Inputs of b left out are free.
+    /// outputMap: For each output of a, the output of b that must match it, or -1 to skip it.
+    /// counterA, counterB: On a difference, receive the '0'/'1' input vectors of a and of b.
+    /// conflictBudget: Conflicts the solver may spend on each output pair; negative for no limit.
+    /// </params>
+    /// <returns>
+    ///  1: Equivalent
+    ///  0: Not equivalent, see the counterexample.
+    /// -1: Undecided within the conflict budget.
+    /// -2: A map entry is out of range or two inputs of a drive the same input of b.
+    /// </returns>
+    inline LogicGraph::SByte equivalent(const LogicGraph& a,const LogicGraph& b,
+        const std::vector<int>& inputMap,const std::vector<int>& outputMap,
+        std::string* counterA = nullptr,std::string* counterB = nullptr,long long conflictBudget = -1)
+    {
+        typedef Netlist::Word Word;
+
+        Netlist na(a);
+        Netlist nb(b);
+
+        unsigned aIns = na.getInputCount();
+        unsigned bIns = nb.getInputCount();
+
+        if(inputMap.size() != aIns || outputMap.size() != na.getOutputCount()) return -2;
+
+        std::vector<int> driver(bIns,-1);
+
+        for(unsigned i = 0; i < aIns; ++i){
+
+            int j = inputMap[i];
+
+            if(j < -1 || j >= (int)bIns || (j >= 0 && driver[j] >= 0)) return -2;
+            if(j >= 0) driver[j] = (int)i;
+        }
+
+        std::vector<std::pair<unsigned,unsigned>> pairs;
+
+        for(unsigned o = 0; o < outputMap.size(); ++o){
+
+            int p = outputMap[o];
+
+            if(p < -1 || p >= (int)nb.getOutputCount()) return -2;
+            if(p < 0) continue;
+
+            unsigned an = na.getOutputNode(o);
+            unsigned bn = nb.getOutputNode(p);
+            int as = an == Netlist::NONE ? -3 : na.getStatus(an);
+            int bs = bn == Netlist::NONE ? -3 : nb.getStatus(bn);
+
+            if(as != bs){
+
+                //One side reports an error the other does not, whatever the inputs.
+                if(counterA != nullptr) counterA->assign(aIns,'0');
+                if(counterB != nullptr) counterB->assign(bIns,'0');
+                return 0;
+            }
+
+            if(as == 0) pairs.push_back(std::make_pair(an,bn));
+        }
+
+        auto report = [&](std::function<bool(unsigned)> aBit,std::function<bool(unsigned)> bBit){
+            if(counterA != nullptr){
+                counterA->resize(aIns);
+                for(unsigned i = 0; i < aIns; ++i) (*counterA)[i] = aBit(i) ? '1' : '0';
+            }
+            if(counterB != nullptr){
+                counterB->resize(bIns);
+                for(unsigned j = 0; j < bIns; ++j) (*counterB)[j] = bBit(j) ? '1' : '0';
+            }
+        };
+
+        //Random simulation, 64 patterns a round; the first round also tries all zeros and all ones.
+        std::mt19937_64 random(0x5EED);
+        std::vector<Word> aWords(aIns);
+        std::vector<Word> bWords(bIns);
+        std::vector<Word> aValues(na.size());
+        std::vector<Word> bValues(nb.size());
+
+        for(unsigned round = 0; round < 32 && !pairs.empty(); ++round){
+
+            for(auto& w : aWords) w = round == 0 ? (random() & ~(Word)3) | 2 : random();
+            for(unsigned j = 0; j < bIns; ++j) bWords[j] = driver[j] >= 0 ? aWords[driver[j]] : random();
+
+            na.simulate(aWords.data(),aValues.data());
+            nb.simulate(bWords.data(),bValues.data());
+
+            for(auto& p : pairs){
+
+                Word diff = aValues[p.first] ^ bValues[p.second];
+
+                if(diff == 0) continue;
+
+                unsigned lane = 0;
+                while(!((diff >> lane) & 1)) ++lane;
+
+                report([&](unsigned i){ return ((aWords[i] >> lane) & 1) != 0; },
+                    [&](unsigned j){ return ((bWords[j] >> lane) & 1) != 0; });
+
+                return 0;
+            }
+        }
+
+        //Prove the surviving pairs on the miter.
+        Solver solver;
+        Cnf ca(na,solver);
+        Cnf cb(nb,solver);
+
+        for(unsigned j = 0; j < bIns; ++j){
+
+            if(driver[j] >= 0) cb.bind(j,ca.literal(driver[j]));
+        }
+
+        bool undecided = false;
+
+        for(auto& p : pairs){
+
+            Cnf::Lit la = ca.literal(p.first);
+            Cnf::Lit lb = cb.literal(p.second);
+
+            if(la == lb) continue;
+
+            Cnf::Lit differ = ca.exclusive(la,lb);
+            LogicGraph::SByte r = solver.solve(std::vector<Cnf::Lit>(1,differ),conflictBudget);
+
+            if(r == 1){
+
+                report([&](unsigned i){ return solver.modelLit(ca.literal(i)); },
+                    [&](unsigned j){ return solver.modelLit(cb.literal(j)); });
+
+                return 0;
+            }
+
+            if(r == 0) solver.addClause(std::vector<Cnf::Lit>(1,differ ^ 1));
+            else undecided = true;
+        }
+
+        return undecided ? -1 : 1;
+    }
+}
+
+#endif//LOGIC_EQUIVALENCE
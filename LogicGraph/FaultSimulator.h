@@ -0,0 +1,342 @@
+/// Single stuck-at fault simulation over a netlist snapshot.
+#ifndef LOGIC_FAULT_SIMULATOR
+#define LOGIC_FAULT_SIMULATOR
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Simulates the collapsed single stuck-at-0/1 faults of a logic graph.
+    /// Each pass injects up to 64 faults, one per bit of the words, against one
+    /// test vector; faults are dropped as soon as a vector detects them.
+    /// </summary>
+    class FaultSimulator
+    {
+    public:
+
+        typedef Netlist::Word Word;
+        typedef Netlist::Key Key;
+
+        struct Fault
+        {
+            /// <summary>
+            /// The netlist node the fault sits on.
+            /// </summary>
+            unsigned node;
+
+            /// <summary>
+            /// -1 for the node's output, else the position of the faulty input of the node.
+            /// </summary>
+            int pin;
+
+            /// <summary>
+            /// The stuck-at value.
+            /// </summary>
+            bool value;
+
+            /// <summary>
+            /// The first vector that detected the fault, or -1.
+            /// </summary>
+            long long detectedBy;
+        };
+
+        FaultSimulator() = delete;
+
+        explicit FaultSimulator(const LogicGraph& graph) : netlist(graph)
+        {
+            vectorCount = 0;
+            detectedCount = 0;
+            enumerateFaults();
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        unsigned getFaultCount() const
+        {
+            return (unsigned)faults.size();
+        }
+
+        unsigned getDetectedCount() const
+        {
+            return detectedCount;
+        }
+
+        const Fault& getFault(unsigned index) const
+        {
+            return faults[index];
+        }
+
+        /// <summary>
+        /// Returns the detected share of the collapsed fault list, 0 to 1.
+        /// </summary>
+        double getCoverage() const
+        {
+            return faults.empty() ? 1.0 : (double)detectedCount / faults.size();
+        }
+
+        /// <summary>
+        /// Simulates the remaining faults against test vectors of '0'/'1' characters,
+        /// one getInputCount() long string after another (as LogicGraph.feedInputString).
+        /// Vectors are numbered on from those of earlier calls.
+        /// </summary>
+        /// <returns>
+        /// The number of faults detected by these vectors.
+        /// </returns>
+        unsigned simulate(const char* vectors,unsigned count)
+        {
+            unsigned inCount = netlist.getInputCount();
+            unsigned before = detectedCount;
+            std::vector<Word> inputWords(inCount);
+
+            for(unsigned v = 0; v < count; ++v, ++vectorCount){
+
+                if(remaining.empty()) continue;
+
+                const char* vec = vectors + (size_t)v * inCount;
+
+                for(unsigned i = 0; i < inCount; ++i){
+
+                    inputWords[i] = vec[i] == '1' ? Netlist::ONES : 0;
+                }
+
+                simulateVector(inputWords.data());
+            }
+
+            return detectedCount - before;
+        }
+
+    private:
+
+        /// <summary>
+        /// Lists the faults on the cones of the open outputs, dropping those
+        /// equivalent to a fault on the output of the gate they feed.
+        /// </summary>
+        void enumerateFaults()
+        {
+            unsigned size = netlist.size();
+
+            std::vector<unsigned> fanOut(size,0);
+            std::vector<bool> live(size,false);
+            std::vector<unsigned char> dropStem(size,0);
+
+            for(unsigned o = 0; o < netlist.getOutputCount(); ++o){
+
+                unsigned n = netlist.getOutputNode(o);
+
+                if(n == Netlist::NONE || netlist.getStatus(n) < 0) continue;
+
+                ++fanOut[n];
+
+                if(!live[n]){
+
+                    live[n] = true;
+                    observed.push_back(n);
+                }
+            }
+
+            for(unsigned n = size; n-- > 0;){
+
+                if(!live[n]) continue;
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i){
+
+                    unsigned f = netlist.getFanIn(n)[i];
+                    live[f] = true;
+                    ++fanOut[f];
+                }
+            }
+
+            for(unsigned n = 0; n < size; ++n){
+
+                if(!live[n]) continue;
+
+                unsigned char equivalent = equivalentInputFaults(netlist.getOp(n));
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i){
+
+                    unsigned f = netlist.getFanIn(n)[i];
+
+                    if(fanOut[f] == 1){
+
+                        dropStem[f] |= equivalent;
+                        continue;
+                    }
+
+                    for(int v = 0; v < 2; ++v){
+
+                        if(!(equivalent & (1 << v))) addFault(n,(int)i,v == 1);
+                    }
+                }
+            }
+
+            for(unsigned n = 0; n < size; ++n){
+
+                if(!live[n]) continue;
+
+                for(int v = 0; v < 2; ++v){
+
+                    if(!(dropStem[n] & (1 << v))) addFault(n,-1,v == 1);
+                }
+            }
+
+            std::stable_sort(faults.begin(),faults.end(),[](const Fault& a,const Fault& b){
+                return a.node < b.node;
+            });
+
+            for(unsigned f = 0; f < faults.size(); ++f){
+
+                remaining.push_back(f);
+            }
+
+            good.resize(size);
+            values.resize(size);
+            force0.resize(size,0);
+            force1.resize(size,0);
+            branched.resize(size,false);
+        }
+
+        /// <summary>
+        /// Returns a mask of the stuck-at values (bit 0: stuck-at-0, bit 1: stuck-at-1)
+        /// on an input of the gate that are equivalent to a fault on its output.
+        /// </summary>
+        static unsigned char equivalentInputFaults(Netlist::Op op)
+        {
+            switch(op){
+            case Netlist::AND:
+            case Netlist::NAND: return 1;
+            case Netlist::OR:
+            case Netlist::NOR:  return 2;
+            case Netlist::BUF:
+            case Netlist::NOT:  return 3;
+            default:            return 0;
+            }
+        }
+
+        void addFault(unsigned node,int pin,bool value)
+        {
+            Fault f;
+            f.node = node;
+            f.pin = pin;
+            f.value = value;
+            f.detectedBy = -1;
+            faults.push_back(f);
+        }
+
+        void simulateVector(const Word* inputWords)
+        {
+            unsigned size = netlist.size();
+            unsigned inCount = netlist.getInputCount();
+
+            netlist.simulate(inputWords,good.data());
+            values = good;
+
+            std::vector<unsigned> still;
+            still.reserve(remaining.size());
+
+            for(size_t g = 0; g < remaining.size(); g += 64){
+
+                size_t end = std::min(remaining.size(),g + 64);
+                unsigned start = faults[remaining[g]].node;
+
+                branches.clear();
+
+                //Inject one fault per bit.
+                for(size_t r = g; r < end; ++r){
+
+                    const Fault& f = faults[remaining[r]];
+                    Word bit = (Word)1 << (r - g);
+
+                    start = std::min(start,f.node);
+
+                    if(f.pin >= 0){
+
+                        branched[f.node] = true;
+                        branches.push_back(std::make_pair(f.node,r - g));
+                    }
+                    else if(f.value) force1[f.node] |= bit;
+                    else force0[f.node] |= bit;
+                }
+
+                for(unsigned n = start; n < size; ++n){
+
+                    Word w = n < inCount ? good[n] : branched[n] ? evaluateBranched(n,g) : netlist.evaluate(n,values.data());
+
+                    values[n] = (w & ~force0[n]) | force1[n];
+                }
+
+                Word detected = 0;
+
+                for(auto o : observed){
+
+                    detected |= values[o] ^ good[o];
+                }
+
+                for(size_t r = g; r < end; ++r){
+
+                    Fault& f = faults[remaining[r]];
+
+                    force0[f.node] = 0;
+                    force1[f.node] = 0;
+                    branched[f.node] = false;
+
+                    if((detected >> (r - g)) & 1){
+
+                        f.detectedBy = (long long)vectorCount;
+                        ++detectedCount;
+                    }
+                    else still.push_back(remaining[r]);
+                }
+
+                std::copy(good.begin() + start,good.end(),values.begin() + start);
+            }
+
+            remaining.swap(still);
+        }
+
+        /// <summary>
+        /// Evaluates a node with faults on its inputs.
+        /// </summary>
+        Word evaluateBranched(unsigned n,size_t group)
+        {
+            const unsigned* f = netlist.getFanIn(n);
+
+            return netlist.evaluateWith(n,[&](unsigned i){
+
+                Word w = values[f[i]];
+
+                for(auto& b : branches){
+
+                    if(b.first != n) continue;
+
+                    const Fault& fault = faults[remaining[group + b.second]];
+
+                    if(fault.pin != (int)i) continue;
+
+                    Word bit = (Word)1 << b.second;
+                    w = fault.value ? w | bit : w & ~bit;
+                }
+
+                return w;
+            });
+        }
+
+        Netlist netlist;
+        std::vector<Fault> faults;
+        std::vector<unsigned> remaining;
+        std::vector<unsigned> observed;
+        std::vector<Word> good;
+        std::vector<Word> values;
+        std::vector<Word> force0;
+        std::vector<Word> force1;
+        std::vector<bool> branched;
+        std::vector<std::pair<unsigned,size_t>> branches;
+        unsigned long long vectorCount;
+        unsigned detectedCount;
+    };
+}
+
+#endif//LOGIC_FAULT_SIMULATOR
@@ -0,0 +1,368 @@
+/// Streams a stimulus file through a logic graph into a result file.
+#ifndef LOGIC_FILE_SIMULATOR
+#define LOGIC_FILE_SIMULATOR
+
+#include "MappedFile.h"
+#include "Netlist.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Simulates every vector of a stimulus file against a snapshot of a logic graph.
+    /// The stimulus is memory mapped. A reader, an evaluator and a writer run on
+    /// their own threads and hand a ring of preallocated buffers round, so each stage
+    /// works on one buffer while the next stage drains another.
+    /// </summary>
+    /// <remarks>
+    /// Stimulus, either
+    /// text: one vector per line of '0'/'1' (as LogicGraph.feedInputString), blank lines skipped, or
+    /// binary: (input count + 7) / 8 bytes per vector, input i in bit i % 8 of byte i / 8.
+    /// The file is read as text when its first 4 KiB hold only '0', '1', '\r' and '\n' and a line break,
+    /// or only a single vector of '0'/'1' characters.
+    /// Result: (output count + 7) / 8 bytes per vector, output o in bit o % 8 of byte o / 8.
+    /// Outputs that are closed or report an error read 0.
+    /// </remarks>
+    class FileSimulator
+    {
+    public:
+
+        typedef Netlist::Word Word;
+
+        FileSimulator() = delete;
+
+        explicit FileSimulator(const LogicGraph& graph) : netlist(graph)
+        {
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        /// <returns>
+        /// -1: The stimulus file could not be opened.
+        /// -2: The result file could not be written.
+        /// Else: The number of vectors simulated.
+        /// </returns>
+        long long run(const char* stimulusPath,const char* resultPath)
+        {
+            MappedFile stimulus(stimulusPath);
+
+            if(!stimulus.isOpen()) return -1;
+
+            std::FILE* result = std::fopen(resultPath,"wb");
+
+            if(result == nullptr) return -2;
+
+            inCount = netlist.getInputCount();
+            inBytes = (inCount + 7) / 8;
+            outBytes = (netlist.getOutputCount() + 7) / 8;
+            text = isText(stimulus.data(),stimulus.size());
+            cursor = stimulus.data();
+            end = cursor + stimulus.size();
+            failed = false;
+
+            for(auto& b : buffers){
+
+                b.inputs.resize((size_t)BLOCKS * inCount);
+                b.results.resize((size_t)BLOCKS * 64 * outBytes);
+                b.count = 0;
+                b.state = FREE;
+            }
+
+            values.resize(netlist.size());
+
+            std::thread evaluator([this]{ evaluate(); });
+            std::thread writer([this,result]{ write(result); });
+
+            long long total = read();
+
+            evaluator.join();
+            writer.join();
+
+            if(std::fclose(result) != 0) failed = true;
+
+            return failed ? -2 : total;
+        }
+
+    private:
+
+        enum State
+        {
+            FREE,
+            READ,
+            EVALUATED
+        };
+
+        /// <summary>
+        /// Vectors per buffer, in blocks of 64.
+        /// </summary>
+        static const unsigned BLOCKS = 256;
+
+        static const unsigned BUFFERS = 3;
+
+        struct Buffer
+        {
+            std::vector<Word> inputs;
+            std::vector<char> results;
+            unsigned count;
+            State state;
+        };
+
+        static bool isText(const char* data,size_t size)
+        {
+            size_t probe = std::min(size,(size_t)4096);
+            bool lineBreak = false;
+
+            for(size_t i = 0; i < probe; ++i){
+
+                char c = data[i];
+
+                if(c == '\n') lineBreak = true;
+                else if(c != '0' && c != '1' && c != '\r') return false;
+            }
+
+            return lineBreak || size == probe;
+        }
+
+        Buffer& await(unsigned index,State state)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock,[&]{ return buffers[index].state == state; });
+            return buffers[index];
+        }
+
+        void hand(Buffer& b,State state)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                b.state = state;
+            }
+
+            changed.notify_all();
+        }
+
+        /// <summary>
+        /// Fills buffers with input words until the stimulus runs out, then hands on an empty buffer.
+        /// </summary>
+        long long read()
+        {
+            long long total = 0;
+
+            for(unsigned i = 0;; i = (i + 1) % BUFFERS){
+
+                Buffer& b = await(i,FREE);
+
+                std::fill(b.inputs.begin(),b.inputs.end(),0);
+                b.count = 0;
+
+                if(text){
+
+                    while(b.count < BLOCKS * 64 && next(b.inputs.data() + (size_t)(b.count / 64) * inCount,b.count % 64)){
+
+                        ++b.count;
+                    }
+                }
+                else{
+
+                    while(b.count < BLOCKS * 64){
+
+                        unsigned patterns = nextBlock(b.inputs.data() + (size_t)(b.count / 64) * inCount);
+
+                        b.count += patterns;
+
+                        if(patterns < 64) break;
+                    }
+                }
+
+                total += b.count;
+
+                bool last = b.count == 0;
+
+                hand(b,READ);
+
+                if(last) return total;
+            }
+        }
+
+        /// <summary>
+        /// Transposes an 8 by 8 bit matrix held a row per byte, low bit first.
+        /// </summary>
+        static Word transpose8(Word x)
+        {
+            Word t;
+
+            t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+            x = x ^ t ^ (t << 7);
+            t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+            x = x ^ t ^ (t << 14);
+            t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+            x = x ^ t ^ (t << 28);
+
+            return x;
+        }
+
+        /// <summary>
+        /// Reads up to 64 binary vectors into a block's input words, eight vectors by
+        /// eight inputs at a time.
+        /// </summary>
+        /// <returns>
+        /// The number of vectors read; fewer than 64 at the end of the stimulus.
+        /// </returns>
+        unsigned nextBlock(Word* words)
+        {
+            if(inBytes == 0) return 0;
+
+            unsigned patterns = (unsigned)std::min((size_t)64,(size_t)(end - cursor) / inBytes);
+
+            for(unsigned g = 0; g * 8 < patterns; ++g){
+
+                unsigned rows = std::min(8u,patterns - g * 8);
+
+                for(unsigned j = 0; j < inBytes; ++j){
+
+                    Word x = 0;
+
+                    for(unsigned r = 0; r < rows; ++r){
+
+                        x |= (Word)(unsigned char)cursor[(size_t)(g * 8 + r) * inBytes + j] << (8 * r);
+                    }
+
+                    x = transpose8(x);
+
+                    for(unsigned k = 0; k < 8 && j * 8 + k < inCount; ++k){
+
+                        words[j * 8 + k] |= ((x >> (8 * k)) & 0xFF) << (8 * g);
+                    }
+                }
+            }
+
+            cursor += (size_t)patterns * inBytes;
+
+            return patterns;
+        }
+
+        /// <summary>
+        /// Reads the next text vector into bit pattern of the block's input words.
+        /// </summary>
+        /// <returns>
+        /// False at the end of the stimulus.
+        /// </returns>
+        bool next(Word* words,unsigned pattern)
+        {
+            Word bit = (Word)1 << pattern;
+
+            for(;;){
+
+                if(cursor >= end) return false;
+
+                const char* line = (const char*)std::memchr(cursor,'\n',end - cursor);
+                const char* stop = line != nullptr ? line : end;
+                const char* v = cursor;
+
+                cursor = line != nullptr ? line + 1 : end;
+
+                if(stop > v && stop[-1] == '\r') --stop;
+                if(stop == v) continue;
+
+                unsigned length = (unsigned)std::min((size_t)(stop - v),(size_t)inCount);
+
+                for(unsigned i = 0; i < length; ++i){
+
+                    if(v[i] == '1') words[i] |= bit;
+                }
+
+                return true;
+            }
+        }
+
+        /// <summary>
+        /// Simulates each buffer a block at a time and packs the outputs for the writer.
+        /// </summary>
+        void evaluate()
+        {
+            unsigned outCount = netlist.getOutputCount();
+
+            for(unsigned i = 0;; i = (i + 1) % BUFFERS){
+
+                Buffer& b = await(i,READ);
+                bool last = b.count == 0;
+
+                for(unsigned v = 0; v < b.count; v += 64){
+
+                    netlist.simulate(b.inputs.data() + (size_t)(v / 64) * inCount,values.data());
+
+                    unsigned patterns = std::min(64u,b.count - v);
+
+                    //Eight outputs by eight vectors at a time.
+                    for(unsigned j = 0; j < outBytes; ++j){
+
+                        Word columns[8];
+
+                        for(unsigned k = 0; k < 8; ++k){
+
+                            unsigned o = j * 8 + k;
+                            unsigned n = o < outCount ? netlist.getOutputNode(o) : Netlist::NONE;
+
+                            columns[k] = n == Netlist::NONE || netlist.getStatus(n) < 0 ? 0 : values[n];
+                        }
+
+                        for(unsigned g = 0; g * 8 < patterns; ++g){
+
+                            Word x = 0;
+
+                            for(unsigned k = 0; k < 8; ++k) x |= ((columns[k] >> (8 * g)) & 0xFF) << (8 * k);
+
+                            x = transpose8(x);
+
+                            for(unsigned r = 0; r < 8 && g * 8 + r < patterns; ++r){
+
+                                b.results[(size_t)(v + g * 8 + r) * outBytes + j] = (char)(x >> (8 * r));
+                            }
+                        }
+                    }
+                }
+
+                hand(b,EVALUATED);
+
+                if(last) return;
+            }
+        }
+
+        void write(std::FILE* result)
+        {
+            for(unsigned i = 0;; i = (i + 1) % BUFFERS){
+
+                Buffer& b = await(i,EVALUATED);
+                bool last = b.count == 0;
+                size_t size = (size_t)b.count * outBytes;
+
+                if(!failed && size > 0 && std::fwrite(b.results.data(),1,size,result) != size) failed = true;
+
+                hand(b,FREE);
+
+                if(last) return;
+            }
+        }
+
+        Netlist netlist;
+        Buffer buffers[BUFFERS];
+        std::vector<Word> values;
+        std::mutex mutex;
+        std::condition_variable changed;
+        const char* cursor;
+        const char* end;
+        unsigned inCount;
+        unsigned inBytes;
+        unsigned outBytes;
+        bool text;
+        bool failed;
+    };
+}
+
+#endif//LOGIC_FILE_SIMULATOR
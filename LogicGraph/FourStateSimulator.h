@@ -0,0 +1,373 @@
+/// Simulates a logic graph over 0, 1, X and Z, 64 patterns at a time.
+#ifndef LOGIC_FOUR_STATE_SIMULATOR
+#define LOGIC_FOUR_STATE_SIMULATOR
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Simulates a logic graph over four values: 0, 1, X (unknown) and Z (undriven).
+    /// Each node holds two words, one pattern per bit: whether it may be 1 and whether
+    /// it may be 0. 0 and 1 set one of the two, X both and Z neither, so a gate costs
+    /// two word operations per input where binary simulation takes one.
+    /// Gates read Z as X and never drive Z themselves. A node with no inputs, which the
+    /// graph reports as -1, drives Z, so the gates after it go X instead of reporting an error.
+    /// </summary>
+    class FourStateSimulator
+    {
+    public:
+
+        typedef LogicGraph::SByte SByte;
+        typedef Netlist::Word Word;
+
+        /// <summary>
+        /// The values a node can take, as getValue and getOutput return them.
+        /// </summary>
+        enum Value : SByte
+        {
+            ZERO = 0,
+            ONE = 1,
+            X = 2,
+            Z = 3
+        };
+
+        FourStateSimulator() = delete;
+
+        explicit FourStateSimulator(const LogicGraph& graph) : netlist(graph)
+        {
+            unsigned size = netlist.size();
+
+            //Nodes that can drive Z get a second slot, read by the gates, holding Z as X,
+            //so gates read their inputs as they are without checking for Z.
+            std::vector<unsigned> resolved(size);
+
+            for(unsigned n = 0; n < size; ++n){
+
+                resolved[n] = n;
+
+                if(n < netlist.getInputCount() || netlist.getFanInCount(n) == 0){
+
+                    resolved[n] = size + (unsigned)floating.size();
+                    floating.push_back(n);
+                }
+            }
+
+            reads.reserve(size);
+            readStart.push_back(0);
+
+            for(unsigned n = 0; n < size; ++n){
+
+                const unsigned* f = netlist.getFanIn(n);
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) reads.push_back(resolved[f[i]]);
+
+                readStart.push_back((unsigned)reads.size());
+            }
+
+            ones.assign(size + floating.size(),0);
+            zeros.assign(size + floating.size(),0);
+
+            //A node with no inputs is always Z, read as X.
+            for(unsigned j = netlist.getInputCount(); j < floating.size(); ++j){
+
+                ones[size + j] = Netlist::ONES;
+                zeros[size + j] = Netlist::ONES;
+            }
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        /// <summary>
+        /// Packs up to 64 vectors, each getInputCount() characters of '0', '1', 'x'/'X' or 'z'/'Z',
+        /// into input words; any other character reads as X. Vector p lands in bit p.
+        /// </summary>
+        void packInputs(const char* vectors,unsigned count,Word* inOnes,Word* inZeros) const
+        {
+            unsigned inCount = netlist.getInputCount();
+
+            for(unsigned i = 0; i < inCount; ++i){
+
+                inOnes[i] = 0;
+                inZeros[i] = 0;
+            }
+
+            for(unsigned p = 0; p < count && p < 64; ++p){
+
+                const char* v = vectors + (size_t)p * inCount;
+                Word bit = (Word)1 << p;
+
+                for(unsigned i = 0; i < inCount; ++i){
+
+                    switch(v[i]){
+                    case '0':           inZeros[i] |= bit; break;
+                    case '1':           inOnes[i] |= bit; break;
+                    case 'z': case 'Z': break;
+                    default:            inOnes[i] |= bit; inZeros[i] |= bit; break;
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Evaluates every node for the 64 patterns of the input words.
+        /// </summary>
+        void simulate(const Word* inOnes,const Word* inZeros)
+        {
+            unsigned size = netlist.size();
+
+            for(unsigned i = 0; i < netlist.getInputCount(); ++i){
+
+                Word z = ~(inOnes[i] | inZeros[i]);
+
+                ones[i] = inOnes[i];
+                zeros[i] = inZeros[i];
+                ones[size + i] = inOnes[i] | z;
+                zeros[size + i] = inZeros[i] | z;
+            }
+
+            for(unsigned n = netlist.getInputCount(); n < size; ++n) evaluate(n);
+        }
+
+        /// <summary>
+        /// Returns a node's value in one pattern of the last simulation.
+        /// </summary>
+        SByte getValue(unsigned n,unsigned pattern) const
+        {
+            unsigned one = (unsigned)(ones[n] >> pattern) & 1;
+            unsigned zero = (unsigned)(zeros[n] >> pattern) & 1;
+
+            if(one && zero) return X;
+            if(one) return ONE;
+            if(zero) return ZERO;
+
+            return Z;
+        }
+
+        /// <summary>
+        /// Returns the indexed output in one pattern of the last simulation.
+        /// </summary>
+        /// <returns>
+        ///  0: False
+        ///  1: True
+        ///  2: X
+        ///  3: Z
+        /// -3: An output does not exist.
+        /// </returns>
+        SByte getOutput(unsigned index,unsigned pattern) const
+        {
+            unsigned n = netlist.getOutputNode(index);
+
+            if(n == Netlist::NONE) return -3;
+
+            return getValue(n,pattern);
+        }
+
+        /// <summary>
+        /// Simulates vectors of '0', '1', 'x' and 'z', one getInputCount() long string after another.
+        /// </summary>
+        /// <params>
+        /// results: Room for count * output count values; vector v, output o lands at
+        /// v * output count + o, coded as getOutput.
+        /// </params>
+        /// <returns>
+        /// The number of vectors simulated.
+        /// </returns>
+        unsigned run(const char* vectors,unsigned count,SByte* results)
+        {
+            unsigned inCount = netlist.getInputCount();
+            unsigned outCount = netlist.getOutputCount();
+            std::vector<Word> inOnes(inCount),inZeros(inCount);
+
+            for(unsigned base = 0; base < count; base += 64){
+
+                unsigned block = std::min(64u,count - base);
+
+                packInputs(vectors + (size_t)base * inCount,block,inOnes.data(),inZeros.data());
+                simulate(inOnes.data(),inZeros.data());
+
+                for(unsigned p = 0; p < block; ++p){
+
+                    for(unsigned o = 0; o < outCount; ++o) results[(size_t)(base + p) * outCount + o] = getOutput(o,p);
+                }
+            }
+
+            return count;
+        }
+
+    private:
+
+        void evaluate(unsigned n)
+        {
+            const unsigned* f = reads.data() + readStart[n];
+            unsigned count = readStart[n + 1] - readStart[n];
+            Word one,zero;
+
+            switch(netlist.getOp(n)){
+            case Netlist::BUF:
+                one = ones[f[0]];
+                zero = zeros[f[0]];
+                break;
+
+            case Netlist::NOT:
+                one = zeros[f[0]];
+                zero = ones[f[0]];
+                break;
+
+            case Netlist::AND:
+            case Netlist::NAND:
+                one = Netlist::ONES;
+                zero = 0;
+                for(unsigned i = 0; i < count; ++i){
+                    one &= ones[f[i]];
+                    zero |= zeros[f[i]];
+                }
+                if(netlist.getOp(n) == Netlist::NAND) std::swap(one,zero);
+                break;
+
+            case Netlist::OR:
+            case Netlist::NOR:
+                one = 0;
+                zero = Netlist::ONES;
+                for(unsigned i = 0; i < count; ++i){
+                    one |= ones[f[i]];
+                    zero &= zeros[f[i]];
+                }
+                if(netlist.getOp(n) == Netlist::NOR) std::swap(one,zero);
+                break;
+
+            case Netlist::ONEHOT:
+            {
+                //One or more, and two or more, of the inputs that may be 1 and of those that must be.
+                Word may = 0,mayMany = 0,must = 0,mustMany = 0;
+                for(unsigned i = 0; i < count; ++i){
+                    Word m = ones[f[i]];
+                    Word s = m & ~zeros[f[i]];
+                    mayMany |= may & m;
+                    may |= m;
+                    mustMany |= must & s;
+                    must |= s;
+                }
+                one = may & ~mustMany;
+                zero = ~must | mayMany;
+                break;
+            }
+
+            case Netlist::CONST0:
+                one = 0;
+                zero = count == 0 ? 0 : Netlist::ONES;
+                break;
+
+            case Netlist::CONST1:
+                one = Netlist::ONES;
+                zero = 0;
+                break;
+
+            case Netlist::SYMMETRIC:
+            case Netlist::XOR:
+            case Netlist::XNOR:
+            case Netlist::THRESHOLD:
+                symmetric(n,f,count,one,zero);
+                break;
+
+            case Netlist::LUT:
+            case Netlist::MUX:
+            {
+                //Fold the table one input at a time, last input first; an X input keeps both halves.
+                Word table = netlist.getLutTable(n);
+                Word highOnes[64],highZeros[64];
+                unsigned size = 1u << count;
+
+                for(unsigned m = 0; m < size; ++m){
+                    highOnes[m] = (table >> m) & 1 ? Netlist::ONES : 0;
+                    highZeros[m] = ~highOnes[m];
+                }
+
+                for(unsigned i = count; i-- > 0;){
+                    Word x1 = ones[f[i]],x0 = zeros[f[i]];
+                    size >>= 1;
+                    for(unsigned m = 0; m < size; ++m){
+                        highOnes[m] = (x1 & highOnes[m + size]) | (x0 & highOnes[m]);
+                        highZeros[m] = (x1 & highZeros[m + size]) | (x0 & highZeros[m]);
+                    }
+                }
+                one = highOnes[0];
+                zero = highZeros[0];
+                break;
+            }
+
+            default:
+                one = 0;
+                zero = 0;
+                break;
+            }
+
+            ones[n] = one;
+            zeros[n] = zero;
+        }
+
+        /// <summary>
+        /// A gate given by its value at each count of true inputs may be 1 if the table has a 1
+        /// anywhere between the count of inputs that must be 1 and the count that may be.
+        /// </summary>
+        void symmetric(unsigned n,const unsigned* f,unsigned count,Word& one,Word& zero)
+        {
+            Word must[32] = {},may[32] = {};
+            unsigned width = 1;
+            while((1u << width) <= count) ++width;
+
+            auto add = [width](Word* planes,Word carry){
+                for(unsigned b = 0; carry != 0 && b < width; ++b){
+                    Word t = planes[b] & carry;
+                    planes[b] ^= carry;
+                    carry = t;
+                }
+            };
+
+            for(unsigned i = 0; i < count; ++i){
+                add(must,ones[f[i]] & ~zeros[f[i]]);
+                add(may,ones[f[i]]);
+            }
+
+            auto equals = [width](const Word* planes,unsigned t){
+                Word match = Netlist::ONES;
+                for(unsigned b = 0; b < width; ++b) match &= (t >> b) & 1 ? planes[b] : ~planes[b];
+                return match;
+            };
+
+            //scratch[t]: the must count is t or less; whether the may count is t or more builds up from the top.
+            scratch.resize(count + 1);
+
+            Word atMost = 0;
+
+            for(unsigned t = 0; t <= count; ++t){
+                atMost |= equals(must,t);
+                scratch[t] = atMost;
+            }
+
+            Word atLeast = 0;
+
+            one = 0;
+            zero = 0;
+
+            for(unsigned t = count + 1; t-- > 0;){
+                atLeast |= equals(may,t);
+                if(netlist.getTableEntry(n,t)) one |= scratch[t] & atLeast;
+                else zero |= scratch[t] & atLeast;
+            }
+        }
+
+        Netlist netlist;
+        std::vector<unsigned> floating;
+        std::vector<unsigned> reads;
+        std::vector<unsigned> readStart;
+        std::vector<Word> ones;
+        std::vector<Word> zeros;
+        std::vector<Word> scratch;
+    };
+}
+
+#endif//LOGIC_FOUR_STATE_SIMULATOR
@@ -0,0 +1,206 @@
+/// Merges equivalent nodes of a logic graph, found by simulation and proven by SAT.
+#ifndef LOGIC_FRAIGER
+#define LOGIC_FRAIGER
+
+#include "Cnf.h"
+#include <random>
+#include <unordered_map>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Finds nodes that compute the same function of the inputs and keeps one of each.
+    /// Every node is simulated on rounds * 64 random patterns; nodes whose values agree
+    /// on all of them are candidates, and each candidate is proven equal to the first
+    /// node of its class on the SAT solver, within a conflict budget. The readers and
+    /// outputs of a proven node are moved to that first node, then whatever is left
+    /// unread is removed. Nodes equal to the complement of another, or to a constant,
+    /// are left as they are.
+    /// </summary>
+    class Fraiger
+    {
+    public:
+
+        typedef Netlist::Word Word;
+
+        /// <params>
+        /// rounds: Simulation rounds of 64 patterns before a candidate goes to the solver.
+        /// conflictBudget: Conflicts the solver may spend on each candidate; negative for no limit.
+        /// </params>
+        explicit Fraiger(unsigned rounds = 4,long long conflictBudget = 1000)
+            : rounds(std::max(1u,rounds)),conflictBudget(conflictBudget)
+        {
+            merged = 0;
+            removed = 0;
+            disproven = 0;
+            undecided = 0;
+        }
+
+        /// <summary>
+        /// Merges the equivalent nodes of a graph. Instances are flattened first.
+        /// </summary>
+        /// <returns>
+        /// The number of nodes merged into another.
+        /// </returns>
+        int sweep(LogicGraph& graph)
+        {
+            Tracer::Span span("fraig");
+
+            merged = 0;
+            removed = 0;
+            disproven = 0;
+            undecided = 0;
+
+            graph.flatten();
+
+            Netlist netlist(graph);
+            unsigned size = netlist.size();
+            unsigned inCount = netlist.getInputCount();
+
+            //Signature of node n: words n * rounds to (n + 1) * rounds - 1.
+            std::vector<Word> signatures((size_t)size * rounds);
+            std::vector<Word> inputWords(inCount);
+            std::vector<Word> values(size);
+            std::mt19937_64 random(0x5EED);
+
+            for(unsigned r = 0; r < rounds; ++r){
+
+                //The first round also tries all zeros and all ones.
+                for(auto& w : inputWords) w = r == 0 ? (random() & ~(Word)3) | 2 : random();
+
+                netlist.simulate(inputWords.data(),values.data());
+
+                for(unsigned n = 0; n < size; ++n) signatures[(size_t)n * rounds + r] = values[n];
+            }
+
+            auto same = [&](unsigned a,unsigned b){
+                return std::equal(signatures.begin() + (size_t)a * rounds,signatures.begin() + (size_t)(a + 1) * rounds,
+                    signatures.begin() + (size_t)b * rounds);
+            };
+
+            Solver solver;
+            Cnf cnf(netlist,solver);
+            std::unordered_map<Word,std::vector<unsigned>> classes;
+            std::vector<std::pair<unsigned,unsigned>> merges;
+
+            //Netlist order is topological, so a class's first node never reads the later ones.
+            for(unsigned n = 0; n < size; ++n){
+
+                if(netlist.getStatus(n) < 0 || netlist.indexOf(netlist.getKey(n)) != n) continue;
+
+                Word hash = 0;
+
+                for(unsigned r = 0; r < rounds; ++r){
+
+                    hash ^= signatures[(size_t)n * rounds + r] + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+                }
+
+                auto& members = classes[hash];
+                bool found = false;
+
+                for(auto m : members){
+
+                    if(!same(m,n)) continue;
+
+                    Tracer::Span prove("prove equivalence");
+                    Cnf::Lit differ = cnf.exclusive(cnf.literal(m),cnf.literal(n));
+                    LogicGraph::SByte r = solver.solve(std::vector<Cnf::Lit>(1,differ),conflictBudget);
+
+                    if(r == 0){
+
+                        //Keep what was proven for the candidates still to come.
+                        solver.addClause(std::vector<Cnf::Lit>(1,differ ^ 1));
+                        merges.push_back(std::make_pair(n,m));
+                        found = true;
+                        break;
+                    }
+
+                    if(r > 0) ++disproven;
+                    else ++undecided;
+                }
+
+                if(!found) members.push_back(n);
+            }
+
+            //A node reading both of a pair keeps the pair apart until that node is merged and
+            //removed itself, so retry what failed until nothing more gives way.
+            std::vector<std::pair<LogicGraph::Key,LogicGraph::Key>> pending;
+
+            for(auto& a : merges){
+
+                //Inputs stay, so only gates are ever merged away.
+                if(netlist.getOp(a.first) != Netlist::INPUT) pending.push_back(std::make_pair(netlist.getKey(a.first),netlist.getKey(a.second)));
+            }
+
+            std::vector<LogicGraph::Key> gone(1);
+
+            while(!gone.empty()){
+
+                gone.clear();
+                auto left = pending.begin();
+
+                for(auto& a : pending){
+
+                    //Either may have gone with a cone removed since.
+                    if(graph.nodes.count(a.first) == 0 || graph.nodes.count(a.second) == 0) continue;
+
+                    if(graph.rewire(a.first,a.second)){
+
+                        gone.push_back(a.first);
+                        ++merged;
+                    }
+                    else *left++ = a;
+                }
+
+                pending.erase(left,pending.end());
+
+                removed += graph.removeUnread(gone);
+            }
+
+            return (int)merged;
+        }
+
+        /// <summary>
+        /// The number of nodes the last sweep merged into another.
+        /// </summary>
+        unsigned getMerged() const
+        {
+            return merged;
+        }
+
+        /// <summary>
+        /// The number of nodes the last sweep removed: the merged ones and the cones only they read.
+        /// </summary>
+        unsigned getRemoved() const
+        {
+            return removed;
+        }
+
+        /// <summary>
+        /// Candidates the solver found a difference for.
+        /// </summary>
+        unsigned getDisproven() const
+        {
+            return disproven;
+        }
+
+        /// <summary>
+        /// Candidates left unmerged because the solver ran out of conflicts.
+        /// </summary>
+        unsigned getUndecided() const
+        {
+            return undecided;
+        }
+
+    private:
+
+        unsigned rounds;
+        long long conflictBudget;
+        unsigned merged;
+        unsigned removed;
+        unsigned disproven;
+        unsigned undecided;
+    };
+}
+
+#endif//LOGIC_FRAIGER
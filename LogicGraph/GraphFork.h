@@ -0,0 +1,651 @@
+/// Copy-on-write variants of a logic graph for what-if analysis.
+#ifndef LOGIC_GRAPH_FORK
+#define LOGIC_GRAPH_FORK
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// An editable variant of a logic graph that shares the unedited structure with the
+    /// graph it was taken from and with every fork of it. The graph is snapshotted once
+    /// into an immutable base; a fork holds the base by reference and keeps only the nodes
+    /// it edited, each an immutable definition shared with its own forks until one of them
+    /// edits it again. fork() therefore copies pointers to the edited nodes, the input values
+    /// and the output bindings, and nothing of the base.
+    /// Values are worked out on demand, over the cone of the output asked for, and kept until
+    /// the next edit or input change. Edits answer with LogicGraph's codes.
+    /// </summary>
+    class GraphFork
+    {
+    public:
+
+        typedef LogicGraph::Key Key;
+        typedef LogicGraph::SByte SByte;
+        typedef LogicGraph::Gate Gate;
+        typedef Netlist::Word Word;
+
+        GraphFork() = delete;
+
+        explicit GraphFork(const LogicGraph& graph)
+        {
+            std::shared_ptr<Base> b = std::make_shared<Base>(graph);
+            const Netlist& netlist = b->netlist;
+            unsigned size = netlist.size();
+
+            b->types.resize(size,LogicGraph::INPUT_NODE);
+            b->gates.resize(size);
+
+            for(unsigned n = netlist.getInputCount(); n < size; ++n){
+
+                if(netlist.getKey(n) == 0){
+
+                    //A gate of a flattened module instance, built back from its kernel.
+                    Netlist::Op op = netlist.getOp(n);
+
+                    b->types[n] = op == Netlist::NOT ? LogicGraph::INVERTER_NODE :
+                        op == Netlist::LUT || op == Netlist::MUX ? LogicGraph::LUT_NODE : LogicGraph::GATE_NODE;
+                    b->gates[n] = kernelGate(netlist,n);
+                    continue;
+                }
+
+                auto& node = graph.nodes.at(netlist.getKey(n));
+
+                b->types[n] = node->type();
+
+                if(b->types[n] == LogicGraph::GATE_NODE) b->gates[n] = ((LogicGraph::GateNode*)node.get())->getGate();
+                else if(b->types[n] == LogicGraph::PORT_NODE) b->gates[n] = LogicGraph::Gates::AND;
+            }
+
+            b->outStart.assign(size + 1,0);
+
+            for(unsigned n = 0; n < size; ++n){
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) ++b->outStart[netlist.getFanIn(n)[i] + 1];
+            }
+
+            for(unsigned n = 0; n < size; ++n) b->outStart[n + 1] += b->outStart[n];
+
+            b->fanOut.resize(b->outStart[size]);
+
+            std::vector<unsigned> fill(b->outStart.begin(),b->outStart.end() - 1);
+
+            for(unsigned n = 0; n < size; ++n){
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) b->fanOut[fill[netlist.getFanIn(n)[i]]++] = n;
+            }
+
+            b->keyLimit = graph.getKeyLimit();
+            base = b;
+
+            for(unsigned i = 0; i < netlist.getInputCount(); ++i) inputs.push_back(graph.inputs[i]->output() == 1);
+
+            for(unsigned o = 0; o < netlist.getOutputCount(); ++o) outputs.push_back(netlist.getOutputNode(o));
+
+            nextKey = base->keyLimit;
+        }
+
+        /// <summary>
+        /// Returns a variant that starts out the same as this one and is edited apart from it.
+        /// Takes time in the number of nodes edited, inputs and outputs; none in the size of the graph.
+        /// </summary>
+        GraphFork fork() const
+        {
+            return *this;
+        }
+
+        Key addGate(Gate gate)
+        {
+            Def d;
+
+            d.type = LogicGraph::GATE_NODE;
+            d.gate = gate;
+
+            return add(std::move(d));
+        }
+
+        Key addInverter()
+        {
+            Def d;
+
+            d.type = LogicGraph::INVERTER_NODE;
+
+            return add(std::move(d));
+        }
+
+        /// <summary>
+        /// Adds a lookup table node, as LogicGraph.addLut.
+        /// </summary>
+        Key addLut(uint64_t table)
+        {
+            Def d;
+
+            d.type = LogicGraph::LUT_NODE;
+            d.table = table;
+
+            return add(std::move(d));
+        }
+
+        /// <summary>
+        /// Connects two gates.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        ///  1: Input already exists
+        ///  2: Given key is an output
+        ///  3: (for inverter or lookup table) No room for another input
+        /// -1: (for input) This is an input node, it cannot have an input added
+        /// -3: A key does not exist.
+        /// </returns>
+        SByte connectGates(Key gate,Key input)
+        {
+            unsigned g = find(gate),in = find(input);
+
+            if(g == Netlist::NONE || in == Netlist::NONE) return -3;
+
+            LogicGraph::NodeType type = typeOf(g);
+
+            if(type == LogicGraph::INPUT_NODE) return -1;
+
+            Def d = edit(g);
+
+            if(std::find(d.fanIn.begin(),d.fanIn.end(),in) != d.fanIn.end()) return 1;
+
+            if(feeds(g,in)) return 2;
+
+            if((type == LogicGraph::INVERTER_NODE || type == LogicGraph::PORT_NODE) && !d.fanIn.empty()) return 3;
+
+            if(type == LogicGraph::LUT_NODE && d.fanIn.size() >= LogicGraph::LutNode::MAX_INPUTS) return 3;
+
+            d.fanIn.push_back(in);
+            store(g,std::move(d));
+
+            return 0;
+        }
+
+        /// <summary>
+        /// Removes an input from the gate.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// -1: Node has no inputs.
+        /// -2: Passed key is not an input.
+        /// -3: A key does not exist.
+        /// </returns>
+        SByte disconnectGates(Key gate,Key input)
+        {
+            unsigned g = find(gate),in = find(input);
+
+            if(g == Netlist::NONE || in == Netlist::NONE) return -3;
+
+            Def d = edit(g);
+
+            if(d.fanIn.empty()) return -1;
+
+            auto a = std::find(d.fanIn.begin(),d.fanIn.end(),in);
+
+            if(a == d.fanIn.end()) return -2;
+
+            d.fanIn.erase(a);
+            store(g,std::move(d));
+
+            return 0;
+        }
+
+        /// <summary>
+        /// Removes the gate, disconnecting it from every gate it feeds. Outputs bound to it
+        /// stay bound and read -1, as in LogicGraph.
+        /// </summary>
+        /// <returns>
+        /// -3: That key does not exist.
+        ///  0: Success
+        /// </returns>
+        SByte removeGate(Key gate)
+        {
+            unsigned g = find(gate);
+
+            if(g == Netlist::NONE || typeOf(g) == LogicGraph::INPUT_NODE) return -3;
+
+            std::vector<unsigned> readers;
+
+            if(g < base->netlist.size()){
+
+                for(unsigned i = base->outStart[g]; i < base->outStart[g + 1]; ++i) readers.push_back(base->fanOut[i]);
+            }
+
+            for(auto& a : defs){
+
+                if(std::find(a.second->fanIn.begin(),a.second->fanIn.end(),g) != a.second->fanIn.end()) readers.push_back(a.first);
+            }
+
+            for(auto r : readers){
+
+                Def d = edit(r);
+                auto a = std::find(d.fanIn.begin(),d.fanIn.end(),g);
+
+                if(a == d.fanIn.end()) continue;
+
+                d.fanIn.erase(a);
+                store(r,std::move(d));
+            }
+
+            Def d = edit(g);
+
+            d.removed = true;
+            d.fanIn.clear();
+            store(g,std::move(d));
+
+            return 0;
+        }
+
+        /// <summary>
+        /// Changes the function of a gate, keeping its inputs.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// -1: The node is not a gate.
+        /// -3: That key does not exist.
+        /// </returns>
+        SByte replaceGate(Key gate,Gate function)
+        {
+            unsigned g = find(gate);
+
+            if(g == Netlist::NONE) return -3;
+
+            if(typeOf(g) != LogicGraph::GATE_NODE) return -1;
+
+            Def d = edit(g);
+
+            d.gate = function;
+            store(g,std::move(d));
+
+            return 0;
+        }
+
+        void setInputVal(unsigned index,bool val)
+        {
+            if(inputs[index] == val) return;
+
+            inputs[index] = val;
+            ++cache.stamp;
+        }
+
+        void openOutput(Key gate,unsigned index)
+        {
+            outputs[index] = find(gate);
+            ++cache.stamp;
+        }
+
+        void closeOutput(unsigned index)
+        {
+            outputs[index] = Netlist::NONE;
+            ++cache.stamp;
+        }
+
+        /// <summary>
+        /// Returns the output with the given index.
+        /// </summary>
+        /// <returns>
+        ///  0: False
+        ///  1: True
+        /// -1: No inputs
+        /// -2: A higher node returned an error
+        /// -3: An output does not exist.
+        /// </returns>
+        SByte getOutput(unsigned index) const
+        {
+            return outputs[index] == Netlist::NONE ? -3 : value(outputs[index]);
+        }
+
+        /// <summary>
+        /// Returns the output of the gate, coded as getOutput; -3 if the key does not exist.
+        /// </summary>
+        SByte testOutput(Key gate) const
+        {
+            unsigned g = find(gate);
+
+            return g == Netlist::NONE ? -3 : value(g);
+        }
+
+        unsigned getInputCount() const
+        {
+            return (unsigned)inputs.size();
+        }
+
+        unsigned getOutputCount() const
+        {
+            return (unsigned)outputs.size();
+        }
+
+        /// <summary>
+        /// The number of nodes this fork holds its own definition of, added ones included.
+        /// </summary>
+        unsigned getEditCount() const
+        {
+            return (unsigned)defs.size();
+        }
+
+    private:
+
+        /// <summary>
+        /// The graph as it was snapshotted, shared by every fork.
+        /// </summary>
+        struct Base
+        {
+            explicit Base(const LogicGraph& graph) : netlist(graph)
+            {
+            }
+
+            Netlist netlist;
+            std::vector<LogicGraph::NodeType> types;
+            /// <summary>
+            /// The function of each gate node; empty for the other kinds.
+            /// </summary>
+            std::vector<Gate> gates;
+            std::vector<unsigned> outStart;
+            std::vector<unsigned> fanOut;
+            Key keyLimit;
+        };
+
+        /// <summary>
+        /// A node as this fork has it, replacing the base node of the same number.
+        /// Nodes are numbered as in the base netlist; added nodes follow on.
+        /// </summary>
+        struct Def
+        {
+            Def()
+            {
+                type = LogicGraph::GATE_NODE;
+                table = 0;
+                removed = false;
+            }
+
+            LogicGraph::NodeType type;
+            Gate gate;
+            uint64_t table;
+            std::vector<unsigned> fanIn;
+            bool removed;
+        };
+
+        /// <summary>
+        /// Values worked out since the last edit; each fork starts with its own, empty.
+        /// </summary>
+        struct Cache
+        {
+            Cache()
+            {
+                stamp = 1;
+            }
+
+            Cache(const Cache&) : Cache()
+            {
+            }
+
+            Cache& operator=(const Cache&)
+            {
+                values.clear();
+                stamps.clear();
+                ++stamp;
+
+                return *this;
+            }
+
+            std::vector<SByte> values;
+            std::vector<unsigned> stamps;
+            std::vector<unsigned> stack;
+            unsigned stamp;
+        };
+
+        /// <summary>
+        /// Returns the number of the node with the key, or NONE if this fork has no such node.
+        /// </summary>
+        unsigned find(Key k) const
+        {
+            unsigned n;
+
+            if(k >= base->keyLimit){
+
+                n = base->netlist.size() + (k - base->keyLimit);
+
+                if(k >= nextKey) return Netlist::NONE;
+            }
+            else{
+
+                n = base->netlist.indexOf(k);
+
+                if(n == Netlist::NONE) return n;
+            }
+
+            auto d = defs.find(n);
+
+            return d != defs.end() && d->second->removed ? Netlist::NONE : n;
+        }
+
+        /// <summary>
+        /// A gate function that agrees with a netlist kernel at the node's input count.
+        /// </summary>
+        static Gate kernelGate(const Netlist& netlist,unsigned n)
+        {
+            switch(netlist.getOp(n)){
+            case Netlist::BUF:
+            case Netlist::AND:    return LogicGraph::Gates::AND;
+            case Netlist::NAND:   return LogicGraph::Gates::NAND;
+            case Netlist::OR:     return LogicGraph::Gates::OR;
+            case Netlist::NOR:    return LogicGraph::Gates::NOR;
+            case Netlist::ONEHOT: return LogicGraph::Gates::XOR;
+            case Netlist::XOR:    return LogicGraph::Gates::PARITY;
+            case Netlist::XNOR:   return LogicGraph::Gates::XNOR;
+            default:              break;
+            }
+
+            std::vector<bool> table(netlist.getFanInCount(n) + 1);
+
+            for(unsigned t = 0; t < table.size(); ++t) table[t] = netlist.getTableEntry(n,t);
+
+            return [table](int Ts,int Fs)->int{ return Ts < (int)table.size() && table[Ts] ? 1 : 0; };
+        }
+
+        const Def* defOf(unsigned n) const
+        {
+            auto d = defs.find(n);
+
+            return d == defs.end() ? nullptr : d->second.get();
+        }
+
+        LogicGraph::NodeType typeOf(unsigned n) const
+        {
+            const Def* d = defOf(n);
+
+            return d != nullptr ? d->type : base->types[n];
+        }
+
+        /// <summary>
+        /// Returns a copy of the node's definition to edit and store back.
+        /// </summary>
+        Def edit(unsigned n) const
+        {
+            const Def* d = defOf(n);
+
+            if(d != nullptr) return *d;
+
+            const Netlist& netlist = base->netlist;
+            Def c;
+
+            c.type = base->types[n];
+            c.gate = base->gates[n];
+            c.fanIn.assign(netlist.getFanIn(n),netlist.getFanIn(n) + netlist.getFanInCount(n));
+
+            if(netlist.getOp(n) == Netlist::LUT || netlist.getOp(n) == Netlist::MUX) c.table = netlist.getLutTable(n);
+
+            return c;
+        }
+
+        void store(unsigned n,Def&& d)
+        {
+            defs[n] = std::make_shared<const Def>(std::move(d));
+            ++cache.stamp;
+        }
+
+        Key add(Def&& d)
+        {
+            Key k = nextKey++;
+
+            store(base->netlist.size() + (k - base->keyLimit),std::move(d));
+
+            return k;
+        }
+
+        /// <summary>
+        /// Whether gate is input or feeds it, so connecting input to gate would close a loop.
+        /// </summary>
+        bool feeds(unsigned gate,unsigned input) const
+        {
+            std::vector<unsigned> stack(1,input);
+            std::vector<bool> seen(base->netlist.size() + (nextKey - base->keyLimit),false);
+
+            while(!stack.empty()){
+
+                unsigned n = stack.back();
+                stack.pop_back();
+
+                if(n == gate) return true;
+
+                if(seen[n]) continue;
+
+                seen[n] = true;
+
+                unsigned count;
+                const unsigned* f = fanIn(n,count);
+
+                stack.insert(stack.end(),f,f + count);
+            }
+
+            return false;
+        }
+
+        const unsigned* fanIn(unsigned n,unsigned& count) const
+        {
+            const Def* d = defOf(n);
+
+            if(d != nullptr){
+
+                count = (unsigned)d->fanIn.size();
+                return d->fanIn.data();
+            }
+
+            count = base->netlist.getFanInCount(n);
+
+            return base->netlist.getFanIn(n);
+        }
+
+        /// <summary>
+        /// Works out a node's value, and every value it needs that is not kept already.
+        /// </summary>
+        SByte value(unsigned root) const
+        {
+            unsigned size = base->netlist.size() + (nextKey - base->keyLimit);
+
+            if(cache.values.size() < size){
+
+                cache.values.resize(size);
+                cache.stamps.resize(size,0);
+            }
+
+            auto known = [this](unsigned n){ return cache.stamps[n] == cache.stamp; };
+
+            cache.stack.assign(1,root);
+
+            while(!cache.stack.empty()){
+
+                unsigned n = cache.stack.back();
+
+                if(known(n)){
+                    cache.stack.pop_back();
+                    continue;
+                }
+
+                unsigned count;
+                const unsigned* f = fanIn(n,count);
+                bool ready = true;
+
+                for(unsigned i = 0; i < count; ++i){
+
+                    if(!known(f[i])){
+                        cache.stack.push_back(f[i]);
+                        ready = false;
+                    }
+                }
+
+                if(!ready) continue;
+
+                cache.stack.pop_back();
+                cache.values[n] = compute(n,f,count);
+                cache.stamps[n] = cache.stamp;
+            }
+
+            return cache.values[root];
+        }
+
+        /// <summary>
+        /// Evaluates one node from the kept values of its inputs, as the node types of LogicGraph do.
+        /// </summary>
+        SByte compute(unsigned n,const unsigned* f,unsigned count) const
+        {
+            const Def* d = defOf(n);
+            LogicGraph::NodeType type = d != nullptr ? d->type : base->types[n];
+
+            if(d != nullptr && d->removed) return -1;
+
+            if(type == LogicGraph::INPUT_NODE) return inputs[n] ? 1 : 0;
+
+            if(count == 0) return -1;
+
+            for(unsigned i = 0; i < count; ++i){
+
+                if(cache.values[f[i]] < 0) return cache.values[f[i]];
+            }
+
+            if(d == nullptr){
+
+                Word w = base->netlist.evaluateWith(n,[&](unsigned i){ return cache.values[f[i]] ? Netlist::ONES : 0; });
+
+                return (SByte)(w & 1);
+            }
+
+            switch(type){
+            case LogicGraph::INVERTER_NODE:
+                return cache.values[f[0]] ? 0 : 1;
+
+            case LogicGraph::LUT_NODE:
+            {
+                unsigned index = 0;
+
+                for(unsigned i = 0; i < count; ++i){
+
+                    if(cache.values[f[i]]) index |= 1u << i;
+                }
+
+                return (SByte)((d->table >> index) & 1);
+            }
+
+            default:
+            {
+                int trues = 0;
+
+                for(unsigned i = 0; i < count; ++i) trues += cache.values[f[i]];
+
+                return (SByte)d->gate(trues,count - trues);
+            }
+            }
+        }
+
+        std::shared_ptr<const Base> base;
+        std::unordered_map<unsigned,std::shared_ptr<const Def>> defs;
+        std::vector<bool> inputs;
+        std::vector<unsigned> outputs;
+        Key nextKey;
+        mutable Cache cache;
+    };
+}
+
+#endif//LOGIC_GRAPH_FORK
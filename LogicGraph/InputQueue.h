@@ -0,0 +1,138 @@
+/// Lock-free hand-off of input updates from many threads to the one that evaluates.
+#ifndef LOGIC_INPUT_QUEUE
+#define LOGIC_INPUT_QUEUE
+
+#include "Netlist.h"
+#include <atomic>
+#include <memory>
+#include <new>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Collects input updates pushed from any number of threads and applies them to a
+    /// graph on the thread that evaluates it, which is the only one to touch the graph.
+    /// Only the last value pushed for an input matters, so each input has one slot that
+    /// a push overwrites, and a bitmap of the inputs pushed since the last drain. A push is
+    /// a store and an exchange, plus an or into the bitmap if its input was not already
+    /// pending; it never waits, never allocates and never fails for lack of room.
+    /// Slots sit on cache lines of their own, so producers of different inputs never share one.
+    /// </summary>
+    class InputQueue
+    {
+    public:
+
+        typedef LogicGraph::SByte SByte;
+
+        InputQueue() = delete;
+        InputQueue(const InputQueue&) = delete;
+        InputQueue& operator=(const InputQueue&) = delete;
+
+        explicit InputQueue(unsigned inputCount)
+            : inputCount(inputCount),storage(new char[inputCount * sizeof(Slot) + alignof(Slot)]),pending(new std::atomic<uint64_t>[(inputCount + 63) / 64])
+        {
+            //new only promises the default alignment before C++17, so the slots are placed by hand.
+            void* first = storage.get();
+            size_t space = inputCount * sizeof(Slot) + alignof(Slot);
+
+            slots = (Slot*)std::align(alignof(Slot),inputCount * sizeof(Slot),first,space);
+
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                new(&slots[i]) Slot();
+                slots[i].value.store(0,std::memory_order_relaxed);
+                slots[i].queued.store(false,std::memory_order_relaxed);
+            }
+
+            for(unsigned w = 0; w < (inputCount + 63) / 64; ++w) pending[w].store(0,std::memory_order_relaxed);
+        }
+
+        unsigned getInputCount() const
+        {
+            return inputCount;
+        }
+
+        /// <summary>
+        /// Queues a value for an input; safe from any thread.
+        /// </summary>
+        /// <returns>
+        /// False if there is no such input.
+        /// </returns>
+        bool push(unsigned index,bool val)
+        {
+            if(index >= inputCount) return false;
+
+            Slot& slot = slots[index];
+
+            slot.value.store(val ? 1 : 0,std::memory_order_relaxed);
+
+            //Releases the value to the drain that clears the flag; whoever raises it also marks the bitmap.
+            if(!slot.queued.exchange(true,std::memory_order_acq_rel)){
+
+                pending[index / 64].fetch_or((uint64_t)1 << (index % 64),std::memory_order_release);
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Applies every input pushed since the last drain to the graph, the last value of
+        /// each. Call it from the thread that evaluates the graph, before evaluating.
+        /// A value pushed while the drain runs is applied now or by the next drain.
+        /// </summary>
+        /// <returns>
+        /// The number of inputs set.
+        /// </returns>
+        unsigned drain(LogicGraph& graph)
+        {
+            unsigned count = 0;
+            unsigned limit = std::min(inputCount,graph.getInputCount());
+
+            for(unsigned w = 0; w < (inputCount + 63) / 64; ++w){
+
+                if(pending[w].load(std::memory_order_relaxed) == 0) continue;
+
+                uint64_t bits = pending[w].exchange(0,std::memory_order_acquire);
+
+                while(bits != 0){
+
+                    unsigned index = w * 64 + (unsigned)Netlist::popcount((bits & (~bits + 1)) - 1);
+
+                    bits &= bits - 1;
+
+                    Slot& slot = slots[index];
+
+                    //Lowering the flag first means a push racing with us marks the bitmap again;
+                    //at worst the next drain sets the same value once more.
+                    slot.queued.exchange(false,std::memory_order_acquire);
+
+                    if(index < limit){
+
+                        graph.setInputVal(index,slot.value.load(std::memory_order_relaxed) != 0);
+                        ++count;
+                    }
+                }
+            }
+
+            return count;
+        }
+
+    private:
+
+        /// <summary>
+        /// Aligned to a cache line, which also pads it to one.
+        /// </summary>
+        struct alignas(64) Slot
+        {
+            std::atomic<SByte> value;
+            std::atomic<bool> queued;
+        };
+
+        unsigned inputCount;
+        std::unique_ptr<char[]> storage;
+        Slot* slots;
+        std::unique_ptr<std::atomic<uint64_t>[]> pending;
+    };
+}
+
+#endif//LOGIC_INPUT_QUEUE
@@ -8,10 +8,19 @@
 #include <sstream>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include "Tracer.h"
 
 namespace LogicGraph
 {
+    class Netlist;
+    class LutMapper;
+    class GraphFork;
+    class Fraiger;
+
     /// <summary>
     /// A logic graph is a collection of nodes connected in an order
     /// wherein nodes have inputs and outputs.
@@ -27,14 +36,164 @@ namespace LogicGraph
         typedef std::weak_ptr<Node> W_Ptr;
         typedef std::map<Key,S_Ptr> S_Map;
         typedef std::map<Key,W_Ptr> W_Map;
+        typedef std::vector<std::pair<Key,Node*>> R_List;
         typedef std::function<int(int,int)> Gate;
         typedef S_Ptr* S_Vec;
         typedef W_Ptr* W_Vec;
         typedef std::unordered_set<Key> Set;
         typedef char SByte;
 
+        /// <summary>
+        /// The kind of a node, as reported to the compiled engines.
+        /// </summary>
+        enum NodeType
+        {
+            INPUT_NODE,
+            GATE_NODE,
+            INVERTER_NODE,
+            LUT_NODE,
+            INSTANCE_NODE,
+            PORT_NODE
+        };
+
+        /// <summary>
+        /// An input to set, as passed to applyInputChanges.
+        /// </summary>
+        struct InputChange
+        {
+            unsigned index;
+            bool value;
+        };
+
+        /// <summary>
+        /// An output whose value differs from the last one reported for it.
+        /// Values are coded as getOutput.
+        /// </summary>
+        struct OutputChange
+        {
+            unsigned index;
+            SByte oldValue;
+            SByte newValue;
+        };
+
+        typedef std::function<void(const OutputChange&)> OutputCallback;
+
+        /// <summary>
+        /// A circuit defined once and placed in graphs by addInstance, any number of times,
+        /// without copying its gates. See Module.h for the module built from a graph.
+        /// </summary>
+        struct ModuleBody
+        {
+            virtual ~ModuleBody() {}
+
+            virtual unsigned getInputCount() const = 0;
+
+            virtual unsigned getOutputCount() const = 0;
+
+            /// <summary>
+            /// The graph the module was defined by; flatten copies its nodes.
+            /// </summary>
+            virtual const LogicGraph& getGraph() const = 0;
+
+            /// <summary>
+            /// The module as a netlist, for the compiled engines to inline.
+            /// </summary>
+            virtual const Netlist& getBody() const = 0;
+
+            /// <summary>
+            /// Evaluates the module.
+            /// </summary>
+            /// <params>
+            /// inputs: 0 or 1 for each input of the module, or the error an input reads, coded as getOutput.
+            /// outputs: Receives each output coded as getOutput; -1 for an output the module left closed.
+            /// An output whose gates read an input in error gets that error, as the gates would once
+            /// flattened; the others get their values, which do not depend on those inputs.
+            /// </params>
+            virtual void evaluate(const SByte* inputs,SByte* outputs) const = 0;
+        };
+
     private:
 
+        friend class Netlist;
+        friend class LutMapper;
+        friend class GraphFork;
+        friend class Fraiger;
+
+        /// <summary>
+        /// The output slots whose nodes were invalidated since the last report, each listed once,
+        /// and those invalidated since their value was last read.
+        /// </summary>
+        struct Touched
+        {
+            std::vector<unsigned> slots;
+            std::vector<bool> marked;
+            std::vector<bool> stale;
+            unsigned long long count;
+
+            void touch(unsigned s)
+            {
+                stale[s] = true;
+                ++count;
+
+                if(marked[s]) return;
+
+                marked[s] = true;
+                slots.push_back(s);
+            }
+        };
+
+        /// <summary>
+        /// The nodes an output depends on, each after its inputs, and the inputs among them.
+        /// </summary>
+        struct Cone
+        {
+            unsigned stamp;
+            std::vector<Node*> order;
+            std::vector<unsigned> support;
+        };
+
+        /// <summary>
+        /// Where evaluateSlice stopped: the output it was working out and the nodes still to visit,
+        /// each with whether its inputs were visited already, as of the given structure stamp and
+        /// touch count.
+        /// </summary>
+        struct Slice
+        {
+            unsigned output;
+            std::vector<std::pair<Node*,bool>> stack;
+            std::vector<Node*> sources;
+            unsigned structure;
+            unsigned long long touches;
+        };
+
+        /// <summary>
+        /// The outputs of the input vectors evaluated last, most recent first, up to capacity of them.
+        /// Entries are found by the hash of their inputs and hold the inputs to rule out collisions.
+        /// Emptied when the graph was edited since stamp.
+        /// </summary>
+        struct ResultCache
+        {
+            struct Entry
+            {
+                uint64_t hash;
+                std::vector<uint64_t> inputs;
+                std::vector<SByte> results;
+            };
+
+            unsigned capacity;
+            unsigned stamp;
+            unsigned long long hits;
+            unsigned long long misses;
+            std::list<Entry> entries;
+            std::unordered_map<uint64_t,std::list<Entry>::iterator> index;
+
+            void clear()
+            {
+                entries.clear();
+                index.clear();
+            }
+        };
+
         /// <summary>
         /// A node for a logic graph.
         /// </summary>
@@ -47,6 +206,9 @@ namespace LogicGraph
             Node(Key k)
             {
                 key = k;
+                touched = nullptr;
+                riseDelay = 1;
+                fallDelay = 1;
             }
 
         public:
@@ -69,7 +231,7 @@ namespace LogicGraph
             ///  0: Success
             ///  1: Input already exists
             ///  2: Given key is an output (recursion)
-            ///  3: (for inverter) Already has an input
+            ///  3: (for inverter or lookup table) No room for another input
             /// -1: (for input) This is an input node, it cannot have an input added
             /// </returns>
             virtual SByte addInput(Key k,W_Ptr value) = 0;
@@ -90,15 +252,45 @@ namespace LogicGraph
             /// </returns>
             virtual SByte removeInput(Key k,bool remOut = true) = 0;
 
+            /// <summary>
+            /// Reads another node in place of one of its inputs, in the same place among them.
+            /// The caller makes sure this closes no loop and the node is not an input already.
+            /// </summary>
+            virtual void replaceInput(Key old,Key k,W_Ptr value) = 0;
+
+            /// <summary>
+            /// Appends the nodes reading this one.
+            /// </summary>
+            void getReaders(std::vector<S_Ptr>& readers) const
+            {
+                for(auto& a : outputs){
+
+                    auto p = a.second.lock();
+
+                    if(p != nullptr) readers.push_back(p);
+                }
+            }
+
+            /// <summary>
+            /// Whether a node reads this one or an output is bound to it.
+            /// </summary>
+            bool isRead() const
+            {
+                return !outputs.empty() || !slots.empty();
+            }
+
             /// <summary>
             /// Adds an output to the map of outputs.
             /// </summary>
             /// <returns>
             ///  0: Success
             /// </returns>
-            SByte addOutput(Key k,W_Ptr value)
+            SByte addOutput(Key k,const S_Ptr& value)
             {
+                if(outputs.count(k) > 0) unlink(readers,k);
+
                 outputs[k] = value;
+                readers.push_back(std::make_pair(k,value.get()));
 
                 return 0;
             }
@@ -118,6 +310,7 @@ namespace LogicGraph
                 if(outputs.size() == 0) return -1;
 
                 outputs.erase(k);
+                unlink(readers,k);
 
                 return 0;
             }
@@ -136,14 +329,14 @@ namespace LogicGraph
 
                 invalidateOutput();
 
-                for(auto a : outputs){
-                    auto p = a.second.lock();
-                    SByte c = p->removeInput(key,false);
+                for(auto& a : readers){
+                    SByte c = a.second->removeInput(key,false);
 
                     if(c == -1) ret = -1;
                 }
 
                 outputs.clear();
+                readers.clear();
 
                 return ret;
             }
@@ -156,16 +349,77 @@ namespace LogicGraph
                 return key;
             }
 
+            /// <summary>
+            /// Returns the kind of this node.
+            /// </summary>
+            virtual NodeType type() const = 0;
+
+            /// <summary>
+            /// Appends the keys of this node's inputs in the order they are evaluated.
+            /// </summary>
+            virtual void getInputs(std::vector<Key>& ks) const = 0;
+
+            /// <summary>
+            /// Appends the nodes this one reads, by plain pointer, in the order they are evaluated.
+            /// </summary>
+            virtual void getSources(std::vector<Node*>& ns) const = 0;
+
+            /// <summary>
+            /// Whether output() answers without asking any input: the node kept its value, or has no inputs.
+            /// </summary>
+            virtual bool isCached() const = 0;
+
+            /// <summary>
+            /// Returns a new, unconnected node of the same kind and settings under another key.
+            /// </summary>
+            virtual S_Ptr create(Key k) const = 0;
+
+            /// <summary>
+            /// Sets the time the node takes to switch to true and to false, for timing simulation.
+            /// </summary>
+            void setDelay(unsigned rise,unsigned fall)
+            {
+                riseDelay = rise;
+                fallDelay = fall;
+            }
+
+            unsigned getRiseDelay() const
+            {
+                return riseDelay;
+            }
+
+            unsigned getFallDelay() const
+            {
+                return fallDelay;
+            }
+
+            /// <summary>
+            /// Binds or unbinds an output slot to this node, so invalidating the node touches the slot.
+            /// </summary>
+            void bindSlot(unsigned index,Touched* t)
+            {
+                touched = t;
+                slots.push_back(index);
+            }
+
+            void unbindSlot(unsigned index)
+            {
+                slots.erase(std::remove(slots.begin(),slots.end(),index),slots.end());
+            }
+
             /// <summary>
             /// Invalidates any outputs.
             /// </summary>
             virtual void invalidateOutput()
             {
-                for(auto a : outputs){
+                for(auto s : slots){
 
-                    auto p = a.second.lock();
-                    p->invalidateOutput();
+                    touched->touch(s);
+                }
+
+                for(auto& a : readers){
 
+                    a.second->invalidateOutput();
                 }
             }
 
@@ -173,26 +427,70 @@ namespace LogicGraph
 
             W_Map outputs;
 
+            /// <summary>
+            /// The nodes in outputs by plain pointer, so evaluating and invalidating walk them
+            /// without locking a weak pointer, which costs two atomic count updates, per edge.
+            /// </summary>
+            R_List readers;
+
             Key key;
 
+            std::vector<unsigned> slots;
+
+            Touched* touched;
+
+            unsigned riseDelay;
+
+            unsigned fallDelay;
+
             /// <summary>
-            /// Checks if any of the passed node is an output to any of the nodes along the tree.
+            /// Gives a node created by create() the delays of this one.
+            /// </summary>
+            S_Ptr withDelays(S_Ptr node) const
+            {
+                node->setDelay(riseDelay,fallDelay);
+
+                return node;
+            }
+
+            /// <summary>
+            /// Whether reading the node would close a loop, that is whether this node feeds it.
             /// </summary>
-            static bool isOutput(W_Ptr current,Key node)
+            bool closesLoop(Key node)
             {
-                auto p = current.lock();
+                Tracer::Span span("cycle check");
 
-                if(p->outputs.size() == 0) return false;
+                return isOutput(this,node);
+            }
+
+            /// <summary>
+            /// Checks if any of the passed node is an output to any of the nodes along the tree.
+            /// </summary>
+            static bool isOutput(const Node* current,Key node)
+            {
+                if(current->outputs.size() == 0) return false;
 
-                if(p->outputs.count(node) > 0) return true;
+                if(current->outputs.count(node) > 0) return true;
 
-                for(auto a : p->outputs){
+                for(auto& a : current->readers){
 
                     if(isOutput(a.second,node)) return true;
                 }
 
                 return false;
             }
+
+            /// <summary>
+            /// Removes the entry of a key from a plain pointer list.
+            /// </summary>
+            static void unlink(R_List& links,Key k)
+            {
+                auto a = std::find_if(links.begin(),links.end(),[k](const std::pair<Key,Node*>& b){
+                    return b.first == k;
+                });
+
+                if(a != links.end()) links.erase(a);
+            }
         };
 
         struct GateNode : Node
@@ -214,10 +512,9 @@ namespace LogicGraph
                     int Ts = 0;
                     int Fs = 0;
 
-                    for(auto a : inputs){
+                    for(auto& a : sources){
 
-                        auto p = a.second.lock();
-                        SByte o = p->output();
+                        SByte o = a.second->output();
                         if(o < 0) return o;
                         o ? ++Ts : ++Fs;
                     }
@@ -238,11 +535,14 @@ namespace LogicGraph
             SByte addInput(Key k,W_Ptr value)
             {
                 if(inputs.count(k) > 0) return 1;
-                else if(isOutput(shared_from_this(),k)) return 2;
+                else if(closesLoop(k)) return 2;
+
+                auto p = value.lock();
 
                 inputs[k] = value;
+                sources.push_back(std::make_pair(k,p.get()));
 
-                value.lock()->addOutput(key,shared_from_this());
+                p->addOutput(key,shared_from_this());
 
                 invalidateOutput();
 
@@ -259,35 +559,83 @@ namespace LogicGraph
                     if(c < 0) return -3;
                 }
                 inputs.erase(k);
+                unlink(sources,k);
 
                 invalidateOutput();
 
                 return 0;
             }
 
-            SByte disconnect()
+            void replaceInput(Key old,Key k,W_Ptr value)
             {
-                std::list<Key>inputKs;
-                for(auto a : inputs){
-                    inputKs.push_back(a.first);
-                }
+                auto a = inputs.find(old);
 
-                for(auto a : inputKs){
-                    SByte c = inputs[a].lock()->removeOutput(key);
+                if(a == inputs.end()) return;
+
+                a->second.lock()->removeOutput(key);
+                inputs.erase(a);
+                unlink(sources,old);
+                inputs[k] = value;
+                sources.push_back(std::make_pair(k,value.lock().get()));
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+            }
+
+            SByte disconnect()
+            {
+                for(auto& a : inputs){
+                    SByte c = a.second.lock()->removeOutput(key);
 
                     if(c < 0) return -2;
                 }
 
                 inputs.clear();
+                sources.clear();
 
                 return Node::disconnect();
             }
 
+            NodeType type() const
+            {
+                return GATE_NODE;
+            }
+
+            void getInputs(std::vector<Key>& ks) const
+            {
+                for(auto& a : inputs){
+                    ks.push_back(a.first);
+                }
+            }
+
+            void getSources(std::vector<Node*>& ns) const
+            {
+                for(auto& a : sources){
+                    ns.push_back(a.second);
+                }
+            }
+
+            bool isCached() const
+            {
+                return sources.empty() || storedOutput != -1;
+            }
+
+            const Gate& getGate() const
+            {
+                return gate;
+            }
+
+            S_Ptr create(Key k) const
+            {
+                return withDelays(std::make_shared<GateNode>(k,gate));
+            }
+
         private:
 
             SByte storedOutput;
             Gate gate;
             W_Map inputs;
+            R_List sources;
         };
 
         struct InverterNode : Node
@@ -295,15 +643,14 @@ namespace LogicGraph
             InverterNode(Key k) : Node(k)
             {
                 input.reset();
+                source = nullptr;
             }
 
             SByte output()
             {
-                auto ip = input.lock();
-
-                if(ip == nullptr) return -1;
+                if(source == nullptr) return -1;
 
-                SByte lastOut = ip->output();
+                SByte lastOut = source->output();
 
                 if(lastOut < 0) return lastOut;
 
@@ -315,9 +662,10 @@ namespace LogicGraph
                 auto ip = input.lock();
                 auto iv = value.lock();
                 if(input.lock() == value.lock()) return 1;
-                if(isOutput(shared_from_this(),k)) return 2;
+                if(closesLoop(k)) return 2;
                 if(ip != nullptr) return 3;
                 input = value;
+                source = iv.get();
                 iv->addOutput(key,shared_from_this());
                 invalidateOutput();
                 return 0;
@@ -332,11 +680,27 @@ namespace LogicGraph
                 if(ip->getKey() == k){
                     if(remOut) ip->removeOutput(key);
                     input.reset();
+                    source = nullptr;
+                    invalidateOutput();
                     return 0;
                 }
                 else return -2;
             }
 
+            void replaceInput(Key old,Key k,W_Ptr value)
+            {
+                auto ip = input.lock();
+
+                if(ip == nullptr || ip->getKey() != old) return;
+
+                ip->removeOutput(key);
+                input = value;
+                source = value.lock().get();
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+            }
+
             SByte disconnect()
             {
                 auto ip = input.lock();
@@ -346,193 +710,1463 @@ namespace LogicGraph
                     SByte c = ip->removeOutput(key);
                     if(c < 0) return -2;
                     input.reset();
+                    source = nullptr;
                 }
 
                 return Node::disconnect();
             }
 
-        private:
-
-            W_Ptr input;
-        };
-
-        struct InputNode : Node
-        {
-            InputNode(Key k,unsigned i) : Node(k)
+            NodeType type() const
             {
-                index = i;
-                myVal = false;
+                return INVERTER_NODE;
             }
 
-            void setVal(bool b)
+            void getInputs(std::vector<Key>& ks) const
             {
-                if(myVal != b){
-                    myVal = b;
-                    invalidateOutput();
-                }
+                auto ip = input.lock();
+
+                if(ip != nullptr) ks.push_back(ip->getKey());
             }
 
-            SByte addInput(Key k,W_Ptr value)
+            void getSources(std::vector<Node*>& ns) const
             {
-                return -1;
+                if(source != nullptr) ns.push_back(source);
             }
 
-            SByte removeInput(Key k,bool b)
+            bool isCached() const
             {
-                return -3;
+                return source == nullptr || source->isCached();
             }
 
-            SByte output() { return myVal ? 1 : 0; }
-
-            unsigned getIndex() const
+            S_Ptr create(Key k) const
             {
-                return index;
+                return withDelays(std::make_shared<InverterNode>(k));
             }
 
         private:
 
-            bool myVal;
-            unsigned index;
+            W_Ptr input;
+            Node* source;
         };
 
-    public:
-
-
-        struct Gates
+        /// <summary>
+        /// A lookup table of up to six inputs. Input i, in the order the
+        /// inputs were added, is bit i of the index into the table.
+        /// </summary>
+        struct LutNode : Node
         {
-            static Gate AND;
+            static const unsigned MAX_INPUTS = 6;
 
-            static Gate OR;
+            LutNode(Key k,uint64_t t) : Node(k)
+            {
+                table = t;
+                storedOutput = -1;
+            }
 
-            static Gate NAND;
+            SByte output()
+            {
+                if(inputs.empty()) return -1;
 
-            static Gate NOR;
+                if(storedOutput == -1){
 
-            static Gate XOR;
-        };
+                    unsigned index = 0;
 
-        LogicGraph() = delete;
+                    for(unsigned i = 0; i < inputs.size(); ++i){
 
-        LogicGraph(unsigned inputCount,unsigned outputCount)
-        {
-            currentKey = 1;
-            inputs = new S_Ptr[inputCount];
+                        SByte o = sources[i]->output();
+                        if(o < 0) return o;
+                        if(o) index |= 1u << i;
+                    }
 
-            for(unsigned i = 0; i < inputCount; ++i){
+                    storedOutput = (table >> index) & 1 ? 1 : 0;
+                }
 
-                Key k = currentKey++;
-                auto point = std::make_shared<InputNode>(k,i); 
-                inputs[i] = point;
-                nodes[k] = point;
-                inKeys.insert(k);
+                return storedOutput;
+            }
+
+            void invalidateOutput()
+            {
+                storedOutput = -1;
+
+                Node::invalidateOutput();
+            }
+
+            SByte addInput(Key k,W_Ptr value)
+            {
+                if(find(k) != inputs.end()) return 1;
+                if(closesLoop(k)) return 2;
+                if(inputs.size() >= MAX_INPUTS) return 3;
+
+                inputs.push_back(std::make_pair(k,value));
+                sources.push_back(value.lock().get());
+
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+
+                return 0;
+            }
+
+            SByte removeInput(Key k,bool removeOut = true)
+            {
+                if(inputs.size() == 0) return -1;
+
+                auto a = find(k);
+
+                if(a == inputs.end()) return -2;
+
+                if(removeOut){
+                    SByte c = a->second.lock()->removeOutput(key);
+                    if(c < 0) return -3;
+                }
+                sources.erase(sources.begin() + (a - inputs.begin()));
+                inputs.erase(a);
+
+                invalidateOutput();
+
+                return 0;
+            }
+
+            void replaceInput(Key old,Key k,W_Ptr value)
+            {
+                auto a = find(old);
+
+                if(a == inputs.end()) return;
+
+                a->second.lock()->removeOutput(key);
+                *a = std::make_pair(k,value);
+                sources[a - inputs.begin()] = value.lock().get();
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+            }
+
+            SByte disconnect()
+            {
+                for(auto& a : inputs){
+                    SByte c = a.second.lock()->removeOutput(key);
+
+                    if(c < 0) return -2;
+                }
+
+                inputs.clear();
+                sources.clear();
+
+                return Node::disconnect();
+            }
+
+            NodeType type() const
+            {
+                return LUT_NODE;
+            }
+
+            void getInputs(std::vector<Key>& ks) const
+            {
+                for(auto& a : inputs){
+                    ks.push_back(a.first);
+                }
+            }
+
+            void getSources(std::vector<Node*>& ns) const
+            {
+                for(auto& a : sources){
+                    ns.push_back(a);
+                }
+            }
+
+            bool isCached() const
+            {
+                return sources.empty() || storedOutput != -1;
+            }
+
+            uint64_t getTable() const
+            {
+                return table;
+            }
+
+            S_Ptr create(Key k) const
+            {
+                return withDelays(std::make_shared<LutNode>(k,table));
+            }
+
+        private:
+
+            std::vector<std::pair<Key,W_Ptr>>::iterator find(Key k)
+            {
+                return std::find_if(inputs.begin(),inputs.end(),[k](const std::pair<Key,W_Ptr>& a){
+                    return a.first == k;
+                });
+            }
+
+            SByte storedOutput;
+            uint64_t table;
+            std::vector<std::pair<Key,W_Ptr>> inputs;
+            std::vector<Node*> sources;
+        };
+
+        /// <summary>
+        /// An instance of a module. Its inputs, in the order they are connected, are the
+        /// module's inputs; its outputs are read through a port node for each. All outputs
+        /// are evaluated together and kept until an input changes.
+        /// </summary>
+        struct InstanceNode : Node
+        {
+            InstanceNode(Key k,std::shared_ptr<const ModuleBody> m) : Node(k)
+            {
+                module = m;
+                status = -1;
+                valid = false;
+            }
+
+            /// <summary>
+            /// Evaluates the module.
+            /// </summary>
+            /// <returns>
+            ///  0: Success; an input in error reaches only the outputs that read it (see outputOf).
+            /// -1: Not every input of the module is connected
+            /// </returns>
+            SByte output()
+            {
+                if(valid) return status;
+
+                unsigned count = module->getInputCount();
+
+                valid = true;
+                status = -1;
+
+                if(inputs.size() < count) return status;
+
+                values.resize(count);
+
+                for(unsigned i = 0; i < count; ++i){
+
+                    values[i] = sources[i]->output();
+                }
+
+                results.resize(module->getOutputCount());
+                module->evaluate(values.data(),results.data());
+                status = 0;
+
+                return status;
+            }
+
+            /// <summary>
+            /// Returns an output of the module, coded as output() for a gate.
+            /// </summary>
+            SByte outputOf(unsigned index)
+            {
+                SByte c = output();
+
+                return c < 0 ? c : results[index];
+            }
+
+            void invalidateOutput()
+            {
+                //Nothing after an instance is worked out without working the instance out first,
+                //so if it is invalid already, so is everything after it.
+                if(!valid) return;
+
+                valid = false;
+
+                Node::invalidateOutput();
+            }
+
+            SByte addInput(Key k,W_Ptr value)
+            {
+                if(find(k) != inputs.end()) return 1;
+                if(closesLoop(k)) return 2;
+                if(inputs.size() >= module->getInputCount()) return 3;
+
+                inputs.push_back(std::make_pair(k,value));
+                sources.push_back(value.lock().get());
+
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+
+                return 0;
+            }
+
+            SByte removeInput(Key k,bool removeOut = true)
+            {
+                if(inputs.size() == 0) return -1;
+
+                auto a = find(k);
+
+                if(a == inputs.end()) return -2;
+
+                if(removeOut){
+                    SByte c = a->second.lock()->removeOutput(key);
+                    if(c < 0) return -3;
+                }
+                sources.erase(sources.begin() + (a - inputs.begin()));
+                inputs.erase(a);
+
+                invalidateOutput();
+
+                return 0;
+            }
+
+            void replaceInput(Key old,Key k,W_Ptr value)
+            {
+                auto a = find(old);
+
+                if(a == inputs.end()) return;
+
+                a->second.lock()->removeOutput(key);
+                *a = std::make_pair(k,value);
+                sources[a - inputs.begin()] = value.lock().get();
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+            }
+
+            SByte disconnect()
+            {
+                for(auto& a : inputs){
+                    SByte c = a.second.lock()->removeOutput(key);
+
+                    if(c < 0) return -2;
+                }
+
+                inputs.clear();
+                sources.clear();
+
+                return Node::disconnect();
+            }
+
+            NodeType type() const
+            {
+                return INSTANCE_NODE;
+            }
+
+            void getInputs(std::vector<Key>& ks) const
+            {
+                for(auto& a : inputs){
+                    ks.push_back(a.first);
+                }
+            }
+
+            void getSources(std::vector<Node*>& ns) const
+            {
+                for(auto& a : sources){
+                    ns.push_back(a);
+                }
+            }
+
+            bool isCached() const
+            {
+                return valid;
+            }
+
+            /// <summary>
+            /// Appends the port nodes reading this instance.
+            /// </summary>
+            void getPorts(std::vector<S_Ptr>& ports) const
+            {
+                for(auto& a : outputs){
+
+                    auto p = a.second.lock();
+
+                    if(p != nullptr && p->type() == PORT_NODE) ports.push_back(p);
+                }
+            }
+
+            const std::shared_ptr<const ModuleBody>& getModule() const
+            {
+                return module;
+            }
+
+            S_Ptr create(Key k) const
+            {
+                return withDelays(std::make_shared<InstanceNode>(k,module));
+            }
+
+        private:
+
+            std::vector<std::pair<Key,W_Ptr>>::iterator find(Key k)
+            {
+                return std::find_if(inputs.begin(),inputs.end(),[k](const std::pair<Key,W_Ptr>& a){
+                    return a.first == k;
+                });
+            }
+
+            std::shared_ptr<const ModuleBody> module;
+            std::vector<std::pair<Key,W_Ptr>> inputs;
+            std::vector<Node*> sources;
+            std::vector<SByte> values;
+            std::vector<SByte> results;
+            SByte status;
+            bool valid;
+        };
+
+        /// <summary>
+        /// Reads one output of a module instance. Once the instance is flattened the
+        /// port reads the copied gate instead, passing its value through unchanged.
+        /// </summary>
+        struct PortNode : Node
+        {
+            PortNode(Key k,unsigned i) : Node(k)
+            {
+                index = i;
+                source = nullptr;
+                setDelay(0,0);
+            }
+
+            SByte output()
+            {
+                if(source == nullptr) return -1;
+
+                if(source->type() == INSTANCE_NODE) return ((InstanceNode*)source)->outputOf(index);
+
+                return source->output();
+            }
+
+            SByte addInput(Key k,W_Ptr value)
+            {
+                auto ip = input.lock();
+                auto iv = value.lock();
+                if(ip == iv) return 1;
+                if(closesLoop(k)) return 2;
+                if(ip != nullptr) return 3;
+                input = value;
+                source = iv.get();
+                iv->addOutput(key,shared_from_this());
+                invalidateOutput();
+                return 0;
+            }
+
+            SByte removeInput(Key k,bool remOut = true)
+            {
+                auto ip = input.lock();
+
+                if(ip == nullptr) return -1;
+
+                if(ip->getKey() != k) return -2;
+
+                if(remOut) ip->removeOutput(key);
+                input.reset();
+                source = nullptr;
+                invalidateOutput();
+
+                return 0;
+            }
+
+            void replaceInput(Key old,Key k,W_Ptr value)
+            {
+                auto ip = input.lock();
+
+                if(ip == nullptr || ip->getKey() != old) return;
+
+                ip->removeOutput(key);
+                input = value;
+                source = value.lock().get();
+                value.lock()->addOutput(key,shared_from_this());
+
+                invalidateOutput();
+            }
+
+            SByte disconnect()
+            {
+                auto ip = input.lock();
+
+                if(ip != nullptr){
+
+                    SByte c = ip->removeOutput(key);
+                    if(c < 0) return -2;
+                    input.reset();
+                    source = nullptr;
+                }
+
+                return Node::disconnect();
+            }
+
+            NodeType type() const
+            {
+                return PORT_NODE;
+            }
+
+            void getInputs(std::vector<Key>& ks) const
+            {
+                auto ip = input.lock();
+
+                if(ip != nullptr) ks.push_back(ip->getKey());
+            }
+
+            void getSources(std::vector<Node*>& ns) const
+            {
+                if(source != nullptr) ns.push_back(source);
+            }
+
+            bool isCached() const
+            {
+                return source == nullptr || source->isCached();
+            }
+
+            unsigned getIndex() const
+            {
+                return index;
+            }
+
+            S_Ptr create(Key k) const
+            {
+                return withDelays(std::make_shared<PortNode>(k,index));
+            }
+
+        private:
+
+            W_Ptr input;
+            Node* source;
+            unsigned index;
+        };
+
+        struct InputNode : Node
+        {
+            InputNode(Key k,unsigned i) : Node(k)
+            {
+                index = i;
+                myVal = false;
+            }
+
+            void setVal(bool b)
+            {
+                if(myVal != b){
+                    Tracer::Span span("invalidate");
+                    myVal = b;
+                    invalidateOutput();
+                }
+            }
+
+            SByte addInput(Key k,W_Ptr value)
+            {
+                return -1;
+            }
+
+            SByte removeInput(Key k,bool b)
+            {
+                return -3;
+            }
+
+            void replaceInput(Key old,Key k,W_Ptr value)
+            {
+            }
+
+            SByte output() { return myVal ? 1 : 0; }
+
+            unsigned getIndex() const
+            {
+                return index;
+            }
+
+            NodeType type() const
+            {
+                return INPUT_NODE;
+            }
+
+            void getInputs(std::vector<Key>& ks) const
+            {
+            }
+
+            void getSources(std::vector<Node*>& ns) const
+            {
+            }
+
+            bool isCached() const
+            {
+                return true;
+            }
+
+            S_Ptr create(Key k) const
+            {
+                auto node = std::make_shared<InputNode>(k,index);
+
+                node->myVal = myVal;
+
+                return node;
+            }
+
+        private:
+
+            bool myVal;
+            unsigned index;
+        };
+
+    public:
+
+
+        struct Gates
+        {
+            static Gate AND;
+
+            static Gate OR;
+
+            static Gate NAND;
+
+            static Gate NOR;
+
+            static Gate XOR;
+
+            /// <summary>
+            /// True when an odd number of the inputs are; XOR above is true for exactly one.
+            /// </summary>
+            static Gate PARITY;
+
+            /// <summary>
+            /// True when an even number of the inputs are.
+            /// </summary>
+            static Gate XNOR;
+
+            /// <summary>
+            /// True when more than half of the inputs are.
+            /// </summary>
+            static Gate MAJORITY;
+
+            /// <summary>
+            /// A gate true when k or more of its inputs are.
+            /// </summary>
+            static Gate threshold(unsigned k)
+            {
+                return [k](int Ts,int Fs)->int{ return Ts >= (int)k ? 1 : 0; };
+            }
+        };
+
+        LogicGraph() = delete;
+
+        LogicGraph(unsigned inputCount,unsigned outputCount)
+        {
+            currentKey = 1;
+            this->inputCount = inputCount;
+            this->outputCount = outputCount;
+            inputs = new S_Ptr[inputCount];
+
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                Key k = currentKey++;
+                auto point = std::make_shared<InputNode>(k,i); 
+                inputs[i] = point;
+                nodes[k] = point;
+                inKeys.insert(k);
             }
 
             outputs = new S_Ptr[outputCount];
+
+            touched.reset(new Touched);
+            touched->count = 0;
+            touched->marked.resize(outputCount,false);
+            touched->stale.resize(outputCount,true);
+            touched->slots.reserve(outputCount);
+            reported.resize(outputCount,-3);
+            values.resize(outputCount,-3);
+            cones.resize(outputCount);
+            structure = 1;
+            nextCallback = 1;
+            results.capacity = 0;
+            results.stamp = 0;
+            results.hits = 0;
+            results.misses = 0;
+            slice.output = 0;
+            slice.structure = 0;
+            slice.touches = 0;
+        }
+
+        LogicGraph(const LogicGraph&) = delete;
+        LogicGraph& operator=(const LogicGraph&) = delete;
+
+        LogicGraph(LogicGraph&& other)
+            : nodes(std::move(other.nodes)),inputs(other.inputs),outputs(other.outputs),currentKey(other.currentKey),
+              inKeys(std::move(other.inKeys)),inputCount(other.inputCount),outputCount(other.outputCount),
+              touched(std::move(other.touched)),reported(std::move(other.reported)),values(std::move(other.values)),
+              cones(std::move(other.cones)),structure(other.structure),results(std::move(other.results)),slice(std::move(other.slice)),
+              callbacks(std::move(other.callbacks)),nextCallback(other.nextCallback)
+        {
+            other.inputs = nullptr;
+            other.outputs = nullptr;
+            other.inputCount = 0;
+            other.outputCount = 0;
+        }
+
+        LogicGraph& operator=(LogicGraph&& other)
+        {
+            if(this == &other) return *this;
+
+            if(inputs != nullptr) delete [] inputs;
+            if(outputs != nullptr) delete [] outputs;
+
+            nodes = std::move(other.nodes);
+            inputs = other.inputs;
+            outputs = other.outputs;
+            currentKey = other.currentKey;
+            inKeys = std::move(other.inKeys);
+            inputCount = other.inputCount;
+            outputCount = other.outputCount;
+            touched = std::move(other.touched);
+            reported = std::move(other.reported);
+            values = std::move(other.values);
+            cones = std::move(other.cones);
+            structure = other.structure;
+            results = std::move(other.results);
+            slice = std::move(other.slice);
+            callbacks = std::move(other.callbacks);
+            nextCallback = other.nextCallback;
+
+            other.inputs = nullptr;
+            other.outputs = nullptr;
+            other.inputCount = 0;
+            other.outputCount = 0;
+
+            return *this;
+        }
+
+        ~LogicGraph()
+        {
+            if(inputs != nullptr) delete [] inputs;
+            if(outputs != nullptr) delete [] outputs;
+        }
+
+        Key addGate(Gate gate)
+        {
+            Key k = currentKey++;
+
+            nodes[k] = std::make_shared<GateNode>(k,gate);
+
+            return k;
+        }
+
+        Key addInverter()
+        {
+            Key k = currentKey++;
+
+            nodes[k] = std::make_shared<InverterNode>(k);
+
+            return k;
+        }
+
+        /// <summary>
+        /// Adds a lookup table node. Input i, in the order the inputs are
+        /// connected, is bit i of the index into the table; at most six inputs.
+        /// </summary>
+        Key addLut(uint64_t table)
+        {
+            Key k = currentKey++;
+
+            nodes[k] = std::make_shared<LutNode>(k,table);
+
+            return k;
+        }
+
+        /// <summary>
+        /// Adds a multiplexer of 1 or 2 select inputs, as a lookup table node.
+        /// Connect the 2 or 4 data inputs first, then the selects, lowest bit first.
+        /// </summary>
+        /// <returns>
+        /// 0: selects is not 1 or 2.
+        /// Else: The key of the node added.
+        /// </returns>
+        Key addMux(unsigned selects)
+        {
+            if(selects < 1 || selects > 2) return 0;
+
+            unsigned data = 1u << selects;
+            uint64_t table = 0;
+
+            for(unsigned m = 0; m < (1u << (data + selects)); ++m){
+
+                if((m >> (m >> data)) & 1) table |= (uint64_t)1 << m;
+            }
+
+            return addLut(table);
         }
 
-        ~LogicGraph()
+        /// <summary>
+        /// Adds an instance of a module, and a port node for each of the module's outputs.
+        /// Connect the module's inputs to the instance, in order, and read its outputs from
+        /// the ports. The module's gates are shared by all of its instances, in any graph.
+        /// </summary>
+        /// <returns>
+        /// The key of the instance.
+        /// </returns>
+        Key addInstance(std::shared_ptr<const ModuleBody> module)
         {
-            if(inputs != nullptr) delete [] inputs;
-            if(outputs != nullptr) delete [] outputs;
+            Key k = currentKey++;
+            auto instance = std::make_shared<InstanceNode>(k,module);
+
+            ++structure;
+
+            nodes[k] = instance;
+
+            for(unsigned o = 0; o < module->getOutputCount(); ++o){
+
+                Key p = currentKey++;
+                auto port = std::make_shared<PortNode>(p,o);
+
+                nodes[p] = port;
+                port->addInput(k,instance);
+            }
+
+            return k;
         }
 
-        Key addGate(Gate gate)
+        /// <summary>
+        /// Returns the key of the port node reading an output of an instance,
+        /// or 0 when there is no such instance or port.
+        /// </summary>
+        Key getPortKey(Key instance,unsigned index) const
         {
-            Key k = currentKey++;
+            auto node = nodes.find(instance);
+
+            if(node == nodes.end() || node->second->type() != INSTANCE_NODE) return 0;
+
+            std::vector<S_Ptr> ports;
+
+            ((InstanceNode*)node->second.get())->getPorts(ports);
+
+            for(auto& p : ports){
+
+                if(((PortNode*)p.get())->getIndex() == index) return p->getKey();
+            }
+
+            return 0;
+        }
+
+        /// <summary>
+        /// Replaces each instance whose inputs are all connected by a copy of its module's
+        /// nodes under new keys, then does the same for any instances those copies hold.
+        /// Ports keep their keys and read the copied gates, so whatever the ports feed stays
+        /// connected and the outputs keep their values.
+        /// </summary>
+        /// <returns>
+        /// The number of instances replaced.
+        /// </returns>
+        unsigned flatten()
+        {
+            Tracer::Span span("flatten");
+            unsigned count = 0;
+            std::vector<Key> pending;
+
+            for(;;){
+
+                pending.clear();
+
+                for(auto& a : nodes){
+
+                    if(a.second == nullptr || a.second->type() != INSTANCE_NODE) continue;
+
+                    auto instance = (InstanceNode*)a.second.get();
+                    std::vector<Key> ks;
+
+                    instance->getInputs(ks);
+
+                    if(ks.size() == instance->getModule()->getInputCount()) pending.push_back(a.first);
+                }
+
+                if(pending.empty()) return count;
+
+                ++structure;
+
+                for(auto k : pending) expand(k);
+
+                count += (unsigned)pending.size();
+            }
+        }
+
+        /// <summary>
+        /// Connects an input to a node.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        ///  1: Input already exists
+        ///  2: Given key is an output (recursion)
+        ///  3: No room for another input
+        /// -1: The node is an input
+        /// -2: The input is a module instance; connect one of its ports instead
+        /// </returns>
+        SByte connectGates(Key gate,Key input)
+        {
+            Tracer::Span span("connect");
+            auto& in = nodes[input];
+
+            if(in != nullptr && in->type() == INSTANCE_NODE) return -2;
+
+            ++structure;
+
+            return nodes[gate]->addInput(input,in);
+        }
+
+        SByte disconnectGates(Key gate,Key input)
+        {
+            ++structure;
+
+            return nodes[gate]->removeInput(input);
+        }
+
+        /// <summary>
+        /// Removes the gate from the graph.
+        /// </summary>
+        /// <returns>
+        /// -3: That key does not exist.
+        /// -2: An input does not list this as an output. (from Node.disconnect)
+        /// -1: An output does not list this as an input. (from Node.disconnect)
+        ///  0: Success
+        /// </returns>
+        SByte removeGate(Key gate)
+        {
+            if(inKeys.count(gate) > 0){
+
+                return -3;
+            }
+
+            ++structure;
+
+            SByte c = nodes[gate]->disconnect();
+
+            if(c < 0) return c;
+
+            nodes.erase(gate);
+
+            return 0;
+        }
+
+        /// <summary>
+        /// Moves every node reading a node, and every output bound to it, over to another node,
+        /// then removes the node and the part of its cone that nothing reads any more.
+        /// </summary>
+        /// <returns>
+        /// -1: A node reading old reads with already.
+        /// -2: with is fed by old, so moving its readers would close a loop.
+        /// -3: A key does not exist, old is an input or an instance, with is an instance, or the two are the same.
+        /// Else: The number of nodes removed.
+        /// </returns>
+        int replaceNode(Key old,Key with)
+        {
+            auto a = nodes.find(old);
+            auto b = nodes.find(with);
+
+            if(a == nodes.end() || b == nodes.end() || old == with || inKeys.count(old) > 0) return -3;
+            if(a->second->type() == INSTANCE_NODE || b->second->type() == INSTANCE_NODE) return -3;
+
+            //Walk forward from old; reaching with means with depends on it.
+            std::vector<S_Ptr> stack(1,a->second);
+            std::unordered_set<Node*> seen;
+
+            while(!stack.empty()){
+
+                S_Ptr n = stack.back();
+                stack.pop_back();
+
+                if(n == b->second) return -2;
+
+                if(seen.insert(n.get()).second) n->getReaders(stack);
+            }
+
+            if(!rewire(old,with)) return -1;
+
+            return (int)removeUnread(std::vector<Key>(1,old));
+        }
+
+        /// <summary>
+        /// Sets the time the gate takes to switch to true and to false, in the time units of
+        /// the timing simulator. Gates start with both at 1; inputs switch without delay.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// -3: That key does not exist.
+        /// </returns>
+        SByte setGateDelay(Key gate,unsigned rise,unsigned fall)
+        {
+            auto node = nodes.find(gate);
+
+            if(node == nodes.end()) return -3;
+
+            node->second->setDelay(rise,fall);
+
+            return 0;
+        }
+
+        Key getInputKey(unsigned index)
+        {
+            return inputs[index]->getKey();
+        }
+
+        Key createKey()
+        {
+            return currentKey++;
+        }
+
+        /// <summary>
+        /// Returns one past the largest key handed out so far.
+        /// </summary>
+        Key getKeyLimit() const
+        {
+            return currentKey;
+        }
+
+        /// <summary>
+        /// Renumbers the nodes from 1 with no gaps: the inputs in order, then the cone of each
+        /// output in turn, depth first with every node after its inputs, then the nodes no
+        /// output reads. Nodes are rebuilt in that order, so nodes that feed each other end up
+        /// near each other in memory, and the holes removeGate left are closed.
+        /// Outputs stay bound to the same gates; values cached by the nodes are dropped.
+        /// </summary>
+        /// <params>
+        /// remap: Receives the new key of every old key, indexed by old key; 0 for keys with no node.
+        /// </params>
+        void compact(std::vector<Key>& remap)
+        {
+            Tracer::Span span("compact");
+            std::vector<Key> order;
+
+            coneOrder(order);
+            remap.assign(currentKey,0);
+
+            for(size_t j = 0; j < order.size(); ++j) remap[order[j]] = (Key)j + 1;
+
+            S_Map fresh;
+
+            rebuild(order,remap,fresh);
+
+            inKeys.clear();
+
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                inputs[i] = fresh.at(remap[inputs[i]->getKey()]);
+                inKeys.insert(inputs[i]->getKey());
+            }
+
+            for(unsigned i = 0; i < outputCount; ++i){
+
+                if(!inGraph(i)) continue;
+
+                outputs[i] = fresh.at(remap[outputs[i]->getKey()]);
+                outputs[i]->bindSlot(i,touched.get());
+                touched->touch(i);
+            }
+
+            nodes.swap(fresh);
+            currentKey = (Key)order.size() + 1;
+            ++structure;
+        }
+
+        /// <summary>
+        /// Returns a deep copy: the same keys, gates, delays, input values and outputs,
+        /// sharing nothing with this graph. Output callbacks are not copied.
+        /// </summary>
+        LogicGraph clone() const
+        {
+            LogicGraph copy(inputCount,outputCount);
+            std::vector<Key> order;
+            std::vector<Key> same(currentKey);
+
+            coneOrder(order);
+
+            for(Key k = 0; k < currentKey; ++k) same[k] = k;
+
+            copy.nodes.clear();
+            rebuild(order,same,copy.nodes);
+
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                copy.inputs[i] = copy.nodes.at(inputs[i]->getKey());
+            }
+
+            for(unsigned i = 0; i < outputCount; ++i){
+
+                if(outputs[i] == nullptr) continue;
+
+                //A gate removed since the output was opened gets a copy of its own.
+                copy.outputs[i] = inGraph(i) ? copy.nodes.at(outputs[i]->getKey()) : outputs[i]->create(outputs[i]->getKey());
+                copy.outputs[i]->bindSlot(i,copy.touched.get());
+            }
+
+            copy.inKeys = inKeys;
+            copy.currentKey = currentKey;
+            copy.reported = reported;
+            copy.touched->slots = touched->slots;
+            copy.touched->marked = touched->marked;
+
+            return copy;
+        }
+
+        unsigned getInputCount() const
+        {
+            return inputCount;
+        }
+
+        unsigned getOutputCount() const
+        {
+            return outputCount;
+        }
+
+        /// <summary>
+        /// Sets an input. Only the nodes it feeds are invalidated, and nothing at all when
+        /// the value does not change, so outputs outside its reach keep their values.
+        /// </summary>
+        void setInputVal(unsigned index,bool val)
+        {
+            ((InputNode*)(inputs[index].get()))->setVal(val);
+        }
+
+        /// <summary>
+        /// Sets the width inputs from first on to the bits of a word, lowest bit first.
+        /// </summary>
+        void setInputWord(unsigned first,unsigned width,uint64_t value)
+        {
+            for(unsigned i = 0; i < width; ++i) setInputVal(first + i,((value >> i) & 1) != 0);
+        }
+
+        /// <summary>
+        /// Reads the width outputs from first on into the bits of a word, lowest bit first.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// Else: The error of the first output that has one, as getOutput; its bit and those after are 0.
+        /// </returns>
+        SByte getOutputWord(unsigned first,unsigned width,uint64_t& value)
+        {
+            value = 0;
+
+            for(unsigned i = 0; i < width; ++i){
+
+                SByte o = getOutput(first + i);
+
+                if(o < 0) return o;
+
+                value |= (uint64_t)o << i;
+            }
+
+            return 0;
+        }
+
+        void openOutput(Key gate,unsigned index)
+        {
+            closeOutput(index);
+
+            auto node = nodes.find(gate);
+
+            if(node == nodes.end()) return;
+
+            outputs[index] = node->second;
+            outputs[index]->bindSlot(index,touched.get());
+        }
+
+        void closeOutput(unsigned index)
+        {
+            if(outputs[index] != nullptr) outputs[index]->unbindSlot(index);
+
+            outputs[index] = nullptr;
+            cones[index].stamp = 0;
+            results.stamp = 0;
+
+            touched->touch(index);
+        }
+
+        /// <summary>
+        /// Sets the inputs, then returns the outputs whose values differ from the
+        /// last ones reported. Only the outputs the changes propagated to are read.
+        /// Outputs opened, closed or rewired since the last report count as well;
+        /// an output never reported before had the value -3.
+        /// Each change is also passed to every registered output callback.
+        /// </summary>
+        void applyInputChanges(const std::vector<InputChange>& changes,std::vector<OutputChange>& changed)
+        {
+            changed.clear();
+
+            for(auto& c : changes){
+
+                ((InputNode*)(inputs[c.index].get()))->setVal(c.value);
+            }
+
+            for(auto s : touched->slots){
+
+                touched->marked[s] = false;
+
+                SByte value = getOutput(s);
+
+                if(value == reported[s]) continue;
+
+                OutputChange change = {s,reported[s],value};
+
+                reported[s] = value;
+                changed.push_back(change);
+            }
+
+            touched->slots.clear();
+
+            for(auto& change : changed){
+
+                for(auto& c : callbacks) c.second(change);
+            }
+        }
+
+        /// <summary>
+        /// Registers a callback for the changes applyInputChanges reports.
+        /// The callback must not edit the graph.
+        /// </summary>
+        /// <returns>
+        /// The id to remove the callback with.
+        /// </returns>
+        unsigned addOutputCallback(OutputCallback callback)
+        {
+            unsigned id = nextCallback++;
+
+            callbacks.push_back(std::make_pair(id,std::move(callback)));
+
+            return id;
+        }
+
+        /// <returns>
+        /// Whether a callback had that id.
+        /// </returns>
+        bool removeOutputCallback(unsigned id)
+        {
+            auto c = std::find_if(callbacks.begin(),callbacks.end(),[id](const std::pair<unsigned,OutputCallback>& a){
+                return a.first == id;
+            });
+
+            if(c == callbacks.end()) return false;
 
-            nodes[k] = std::make_shared<GateNode>(k,gate);
+            callbacks.erase(c);
 
-            return k;
+            return true;
         }
 
-        Key addInverter()
+        /// <summary>
+        /// Returns the output with the given index.
+        /// </summary>
+        /// <returns>
+        ///  0: False
+        ///  1: True
+        /// -1: No inputs (from Node.output)
+        /// -2: A higher node returned an error (from Node.output)
+        /// -3: An output does not exist.
+        /// </returns>
+        SByte getOutput(unsigned index)
         {
-            Key k = currentKey++;
+            if(outputs[index] == nullptr) return -3;
 
-            nodes[k] = std::make_shared<InverterNode>(k);
+            if(!touched->stale[index]) return values[index];
 
-            return k;
-        }
+            Tracer::Span span("evaluate");
 
-        SByte connectGates(Key gate,Key input)
-        {
-            return nodes[gate]->addInput(input,nodes[input]);
+            //Nodes that kept their values answer at once, so only the invalidated ones are worked out.
+            SByte value = outputs[index]->output();
+
+            values[index] = value;
+            touched->stale[index] = false;
+
+            return value;
         }
 
-        SByte disconnectGates(Key gate,Key input)
+        /// <summary>
+        /// Keeps the outputs of up to capacity input vectors passed to evaluate, dropping the
+        /// least recently used first; 0, the default, keeps none. Empties the cache and
+        /// starts its counts over.
+        /// </summary>
+        void setResultCacheCapacity(unsigned capacity)
         {
-            return nodes[gate]->removeInput(input);
+            results.clear();
+            results.capacity = capacity;
+            results.hits = 0;
+            results.misses = 0;
         }
 
         /// <summary>
-        /// Removes the gate from the graph.
+        /// Returns every output, coded as getOutput, for an input vector: input i is bit i % 64
+        /// of word i / 64. A vector in the result cache is answered from it without touching
+        /// the graph, so the inputs keep the values of the last vector that was not; any other
+        /// vector is set as setInputVal would and added to the cache.
+        /// Editing the graph or opening or closing an output empties the cache.
         /// </summary>
         /// <returns>
-        /// -3: That key does not exist.
-        /// -2: An input does not list this as an output. (from Node.disconnect)
-        /// -1: An output does not list this as an input. (from Node.disconnect)
-        ///  0: Success
+        /// Whether the outputs came from the cache.
         /// </returns>
-        SByte removeGate(Key gate)
+        bool evaluate(const uint64_t* inputWords,SByte* outputValues)
         {
-            if(inKeys.count(gate) > 0){
+            unsigned words = (inputCount + 63) / 64;
+            uint64_t hash = 0xCBF29CE484222325ull;
 
-                return -3;
+            if(results.capacity > 0){
+
+                if(results.stamp != structure){
+
+                    results.clear();
+                    results.stamp = structure;
+                }
+
+                for(unsigned w = 0; w < words; ++w) hash = (hash ^ inputWords[w]) * 0x100000001B3ull;
+
+                auto a = results.index.find(hash);
+
+                if(a != results.index.end() && std::equal(inputWords,inputWords + words,a->second->inputs.begin())){
+
+                    ++results.hits;
+                    results.entries.splice(results.entries.begin(),results.entries,a->second);
+                    std::copy(a->second->results.begin(),a->second->results.end(),outputValues);
+
+                    return true;
+                }
+
+                ++results.misses;
             }
 
-            SByte c = nodes[gate]->disconnect();
+            for(unsigned i = 0; i < inputCount; ++i) setInputVal(i,((inputWords[i / 64] >> (i % 64)) & 1) != 0);
 
-            if(c < 0) return c;
+            for(unsigned o = 0; o < outputCount; ++o) outputValues[o] = getOutput(o);
 
-            nodes.erase(gate);
+            if(results.capacity == 0) return false;
 
-            return 0;
+            //A colliding vector gives up its entry.
+            auto a = results.index.find(hash);
+
+            if(a != results.index.end()) results.entries.erase(a->second);
+            else if(results.entries.size() >= results.capacity){
+
+                results.index.erase(results.entries.back().hash);
+                results.entries.pop_back();
+            }
+
+            ResultCache::Entry entry;
+            entry.hash = hash;
+            entry.inputs.assign(inputWords,inputWords + words);
+            entry.results.assign(outputValues,outputValues + outputCount);
+
+            results.entries.push_front(std::move(entry));
+            results.index[hash] = results.entries.begin();
+
+            return false;
         }
 
-        Key getInputKey(unsigned index)
+        /// <summary>
+        /// The number of vectors evaluate answered from the result cache.
+        /// </summary>
+        unsigned long long getResultCacheHits() const
         {
-            return inputs[index]->getKey();
+            return results.hits;
         }
 
-        Key createKey()
+        /// <summary>
+        /// The number of vectors evaluate looked for in the result cache and had to simulate.
+        /// </summary>
+        unsigned long long getResultCacheMisses() const
         {
-            return currentKey++;
+            return results.misses;
         }
 
-        void setInputVal(unsigned index,bool val)
+        /// <summary>
+        /// Works towards the value of every open output for a limited time, so a caller that must
+        /// stay responsive can spread a large evaluation over many calls. Each call picks up where
+        /// the last one stopped; setting inputs or editing the graph in between is allowed, and
+        /// the work affected is done again. Outputs read with isSettled in between come for free.
+        /// </summary>
+        /// <params>
+        /// nodeBudget: Nodes to evaluate at most; 0 for no limit.
+        /// microseconds: Time to spend at most, checked every 64 nodes; 0 for no limit.
+        /// </params>
+        /// <returns>
+        /// Whether every open output is settled.
+        /// </returns>
+        bool evaluateSlice(unsigned nodeBudget,unsigned microseconds)
         {
-            auto ptr = (InputNode*)(inputs[index].get());
+            Tracer::Span span("evaluate slice");
+            auto start = std::chrono::steady_clock::now();
+            unsigned spent = 0;
+            unsigned checked = 0;
+
+            //Anything touched since the last slice may have invalidated nodes the walk had passed,
+            //and an edit may have freed nodes still on the stack.
+            if(slice.touches != touched->count || slice.structure != structure) slice.stack.clear();
+
+            for(;checked < outputCount; ++checked){
+
+                if(slice.output >= outputCount){
+
+                    slice.output = 0;
+                    slice.stack.clear();
+                }
+
+                unsigned o = slice.output;
+
+                if(outputs[o] == nullptr || !touched->stale[o]){
+
+                    ++slice.output;
+                    slice.stack.clear();
+                    continue;
+                }
+
+                //Settling this output takes work, so the outputs after it are checked from here on again.
+                checked = 0;
+
+                if(slice.stack.empty()) slice.stack.push_back(std::make_pair(outputs[o].get(),false));
+
+                //Depth first from the output, into the nodes that lost their values only, so the work
+                //follows what changed rather than the size of the cone.
+                while(!slice.stack.empty()){
 
-            ptr->setVal(val);
+                    if((nodeBudget != 0 && spent >= nodeBudget) || (microseconds != 0 && spent % 64 == 63 &&
+                        std::chrono::steady_clock::now() - start >= std::chrono::microseconds(microseconds))){
 
-            ptr->invalidateOutput();
+                        slice.structure = structure;
+                        slice.touches = touched->count;
+                        return false;
+                    }
+
+                    auto top = slice.stack.back();
+                    slice.stack.pop_back();
+                    ++spent;
+
+                    if(top.second){
+
+                        //Its inputs were worked out already, so this mostly reads what they kept.
+                        top.first->output();
+                        continue;
+                    }
+
+                    if(top.first->isCached()) continue;
+
+                    slice.stack.push_back(std::make_pair(top.first,true));
+                    slice.sources.clear();
+                    top.first->getSources(slice.sources);
+
+                    for(auto b = slice.sources.rbegin(); b != slice.sources.rend(); ++b){
+
+                        if(!(*b)->isCached()) slice.stack.push_back(std::make_pair(*b,false));
+                    }
+                }
+
+                values[o] = outputs[o]->output();
+                touched->stale[o] = false;
+                ++slice.output;
+            }
+
+            slice.structure = structure;
+            slice.touches = touched->count;
+
+            return true;
         }
 
-        void openOutput(Key gate,unsigned index)
+        /// <summary>
+        /// Whether the indexed output is closed or its value is known, so getOutput returns it at once.
+        /// </summary>
+        bool isSettled(unsigned index) const
         {
-            outputs[index] = nodes[gate];
+            return outputs[index] == nullptr || !touched->stale[index];
         }
 
-        void closeOutput(unsigned index)
+        /// <summary>
+        /// Returns the indexes of the inputs the output is connected to through any path,
+        /// in ascending order; none for a closed output. Setting any other input leaves the
+        /// output as it is. Kept until the graph is edited.
+        /// </summary>
+        const std::vector<unsigned>& getSupport(unsigned index)
         {
-            outputs[index] = nullptr;
+            return getCone(index).support;
         }
 
         /// <summary>
-        /// Returns the output with the given index.
+        /// Returns the number of nodes the output depends on, itself and its support included.
         /// </summary>
-        /// <returns>
-        ///  0: False
-        ///  1: True
-        /// -1: No inputs (from Node.output)
-        /// -2: A higher node returned an error (from Node.output)
-        /// -3: An output does not exist.
-        /// </returns>
-        SByte getOutput(unsigned index)
+        unsigned getConeSize(unsigned index)
         {
-            if(outputs[index] == nullptr) return -3;
-
-            return outputs[index]->output();
+            return (unsigned)getCone(index).order.size();
         }
 
         /// <summary>
@@ -561,6 +2195,8 @@ namespace LogicGraph
 
         SByte removeConnection(Key gate0,Key gate1)
         {
+            ++structure;
+
             SByte c = nodes[gate0]->removeInput(gate1);
 
             if(c < -1) c = nodes[gate1]->removeInput(gate0);
@@ -570,11 +2206,289 @@ namespace LogicGraph
 
     private:
 
+        /// <summary>
+        /// Points the readers and outputs of old at with. The caller makes sure with is not fed by old.
+        /// </summary>
+        /// <returns>
+        /// False, changing nothing, when a reader of old reads with already.
+        /// </returns>
+        bool rewire(Key old,Key with)
+        {
+            S_Ptr from = nodes.at(old);
+            S_Ptr to = nodes.at(with);
+            std::vector<S_Ptr> readers;
+            std::vector<Key> ks;
+
+            from->getReaders(readers);
+
+            for(auto& r : readers){
+
+                ks.clear();
+                r->getInputs(ks);
+
+                if(std::find(ks.begin(),ks.end(),with) != ks.end()) return false;
+            }
+
+            ++structure;
+
+            for(auto& r : readers) r->replaceInput(old,with,to);
+
+            for(unsigned i = 0; i < outputCount; ++i){
+
+                if(outputs[i] == from) openOutput(with,i);
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Removes the listed nodes that nothing reads, then the inputs of those that nothing reads
+        /// any more, and so on. Graph inputs are kept.
+        /// </summary>
+        /// <returns>
+        /// The number of nodes removed.
+        /// </returns>
+        unsigned removeUnread(std::vector<Key> pending)
+        {
+            unsigned count = 0;
+            std::vector<Key> ks;
+
+            while(!pending.empty()){
+
+                Key k = pending.back();
+                pending.pop_back();
+
+                auto node = nodes.find(k);
+
+                if(node == nodes.end() || inKeys.count(k) > 0 || node->second->isRead()) continue;
+
+                ks.clear();
+                node->second->getInputs(ks);
+
+                if(removeGate(k) < 0) continue;
+
+                ++count;
+                pending.insert(pending.end(),ks.begin(),ks.end());
+            }
+
+            return count;
+        }
+
+        /// <summary>
+        /// Returns the cone of the indexed output, working it out again if the graph was edited since.
+        /// </summary>
+        const Cone& getCone(unsigned index)
+        {
+            Cone& cone = cones[index];
+
+            if(cone.stamp == structure) return cone;
+
+            Tracer::Span span("build cone");
+
+            cone.stamp = structure;
+            cone.order.clear();
+            cone.support.clear();
+
+            if(outputs[index] == nullptr) return cone;
+
+            std::unordered_set<Node*> seen;
+            std::vector<std::pair<Node*,bool>> stack(1,std::make_pair(outputs[index].get(),false));
+            std::vector<Key> ks;
+
+            while(!stack.empty()){
+
+                auto top = stack.back();
+                stack.pop_back();
+
+                if(top.second){
+
+                    cone.order.push_back(top.first);
+
+                    if(top.first->type() == INPUT_NODE) cone.support.push_back(((InputNode*)top.first)->getIndex());
+
+                    continue;
+                }
+
+                if(!seen.insert(top.first).second) continue;
+
+                stack.push_back(std::make_pair(top.first,true));
+
+                ks.clear();
+                top.first->getInputs(ks);
+
+                for(auto b = ks.rbegin(); b != ks.rend(); ++b){
+
+                    Node* input = nodes.at(*b).get();
+
+                    if(seen.count(input) == 0) stack.push_back(std::make_pair(input,false));
+                }
+            }
+
+            std::sort(cone.support.begin(),cone.support.end());
+
+            return cone;
+        }
+
+        /// <summary>
+        /// Whether the indexed output holds a node of the graph, not a gate removed since it was opened.
+        /// </summary>
+        bool inGraph(unsigned index) const
+        {
+            if(outputs[index] == nullptr) return false;
+
+            auto node = nodes.find(outputs[index]->getKey());
+
+            return node != nodes.end() && node->second == outputs[index];
+        }
+
+        /// <summary>
+        /// Lists the keys of every node: the inputs in order, then the cone of each output in
+        /// turn, depth first with every node after its inputs, then the nodes no output reads.
+        /// </summary>
+        void coneOrder(std::vector<Key>& order) const
+        {
+            std::vector<bool> seen(currentKey,false);
+            std::vector<Key> ks;
+            std::vector<std::pair<Key,bool>> stack;
+
+            order.clear();
+            order.reserve(nodes.size());
+
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                Key k = inputs[i]->getKey();
+
+                seen[k] = true;
+                order.push_back(k);
+            }
+
+            auto visit = [&](Key root){
+                if(seen[root]) return;
+
+                stack.push_back(std::make_pair(root,false));
+
+                while(!stack.empty()){
+
+                    auto top = stack.back();
+                    stack.pop_back();
+
+                    if(seen[top.first]) continue;
+
+                    if(top.second){
+
+                        seen[top.first] = true;
+                        order.push_back(top.first);
+                        continue;
+                    }
+
+                    stack.push_back(std::make_pair(top.first,true));
+
+                    ks.clear();
+                    nodes.at(top.first)->getInputs(ks);
+
+                    for(auto b = ks.rbegin(); b != ks.rend(); ++b){
+
+                        if(!seen[*b]) stack.push_back(std::make_pair(*b,false));
+                    }
+                }
+            };
+
+            for(unsigned i = 0; i < outputCount; ++i){
+
+                if(inGraph(i)) visit(outputs[i]->getKey());
+            }
+
+            for(auto& a : nodes){
+
+                if(a.second != nullptr) visit(a.first);
+            }
+        }
+
+        /// <summary>
+        /// Creates a copy of each listed node under its new key in remap and connects the copies
+        /// as the originals are. Every node's inputs come before it in the order, so each is
+        /// connected before anything reads it.
+        /// </summary>
+        void rebuild(const std::vector<Key>& order,const std::vector<Key>& remap,S_Map& fresh) const
+        {
+            std::vector<Key> ks;
+
+            for(auto k : order){
+
+                auto& node = nodes.at(k);
+                S_Ptr copy = node->create(remap[k]);
+
+                ks.clear();
+                node->getInputs(ks);
+
+                for(auto b : ks){
+
+                    copy->addInput(remap[b],fresh.at(remap[b]));
+                }
+
+                fresh.emplace(remap[k],copy);
+            }
+        }
+
+        /// <summary>
+        /// Replaces an instance by a copy of its module's nodes and points its ports at the copies.
+        /// </summary>
+        void expand(Key k)
+        {
+            S_Ptr node = nodes.at(k);
+            auto instance = (InstanceNode*)node.get();
+            const LogicGraph& body = instance->getModule()->getGraph();
+            std::vector<Key> order,ks,remap(body.currentKey,0);
+
+            body.coneOrder(order);
+            instance->getInputs(ks);
+
+            for(unsigned i = 0; i < body.inputCount; ++i) remap[body.inputs[i]->getKey()] = ks[i];
+
+            order.erase(order.begin(),order.begin() + body.inputCount);
+
+            for(auto b : order) remap[b] = currentKey++;
+
+            body.rebuild(order,remap,nodes);
+
+            std::vector<S_Ptr> ports;
+
+            instance->getPorts(ports);
+
+            for(auto& p : ports){
+
+                unsigned o = ((PortNode*)p.get())->getIndex();
+
+                p->removeInput(k);
+
+                if(body.inGraph(o)){
+
+                    Key b = remap[body.outputs[o]->getKey()];
+
+                    p->addInput(b,nodes.at(b));
+                }
+            }
+
+            node->disconnect();
+            nodes.erase(k);
+        }
+
         S_Map nodes;
         S_Vec inputs;
         S_Vec outputs;
         Key currentKey;
         Set inKeys;
+        unsigned inputCount;
+        unsigned outputCount;
+        std::unique_ptr<Touched> touched;
+        std::vector<SByte> reported;
+        std::vector<SByte> values;
+        std::vector<Cone> cones;
+        unsigned structure;
+        ResultCache results;
+        Slice slice;
+        std::vector<std::pair<unsigned,OutputCallback>> callbacks;
+        unsigned nextCallback;
     };
 
     #define Gate_Sig [](int Ts, int Fs)->int
@@ -603,6 +2517,21 @@ namespace LogicGraph
     {
         return Ts == 1 ? 1 : 0;
     };
+
+    LogicGraph::Gate LogicGraph::Gates::PARITY = Gate_Sig
+    {
+        return Ts & 1;
+    };
+
+    LogicGraph::Gate LogicGraph::Gates::XNOR = Gate_Sig
+    {
+        return (Ts & 1) ^ 1;
+    };
+
+    LogicGraph::Gate LogicGraph::Gates::MAJORITY = Gate_Sig
+    {
+        return Ts > Fs ? 1 : 0;
+    };
 }
 
 #endif//LOGIC_GRAPH
@@ -7,7 +7,13 @@ void* CreateLogicGraph(int inputCount,int outputCount)
 
 void DestroyLogicGraph(void* logicGraph)
 {
-    delete logicGraph;
+    delete (LogicGraph::LogicGraph*)logicGraph;
+}
+
+void* CloneLogicGraph(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::LogicGraph(instance->clone());
 }
 
 LogicGraph::LogicGraph::Key addGate(void*logicGraph, int type)
@@ -20,10 +26,25 @@ LogicGraph::LogicGraph::Key addGate(void*logicGraph, int type)
     case  3: return instance->addGate(LogicGraph::LogicGraph::Gates::NAND);
     case  4: return instance->addGate(LogicGraph::LogicGraph::Gates::NOR);
     case  5: return instance->addGate(LogicGraph::LogicGraph::Gates::XOR);
+    case  6: return instance->addGate(LogicGraph::LogicGraph::Gates::PARITY);
+    case  7: return instance->addGate(LogicGraph::LogicGraph::Gates::XNOR);
+    case  8: return instance->addGate(LogicGraph::LogicGraph::Gates::MAJORITY);
     default: return 0;
     }
 }
 
+LogicGraph::LogicGraph::Key addThresholdGate(void* logicGraph,int k)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->addGate(LogicGraph::LogicGraph::Gates::threshold(k < 0 ? 0 : (unsigned)k));
+}
+
+LogicGraph::LogicGraph::Key addMux(void* logicGraph,int selects)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return selects < 0 ? 0 : instance->addMux((unsigned)selects);
+}
+
 LogicGraph::LogicGraph::SByte connectGates(void*logicGraph,LogicGraph::LogicGraph::Key gate,LogicGraph::LogicGraph::Key input)
 {
     LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
@@ -42,6 +63,12 @@ LogicGraph::LogicGraph::SByte removeGate(void* logicGraph,LogicGraph::LogicGraph
     return instance->removeGate(gate);
 }
 
+LogicGraph::LogicGraph::SByte setGateDelay(void* logicGraph,LogicGraph::LogicGraph::Key gate,unsigned rise,unsigned fall)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->setGateDelay(gate,rise,fall);
+}
+
 LogicGraph::LogicGraph::Key getInputKey(void* logicGraph,int index)
 {
     LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
@@ -54,6 +81,21 @@ LogicGraph::LogicGraph::Key createKey(void* logicGraph)
     return instance->createKey();
 }
 
+LogicGraph::LogicGraph::Key getKeyLimit(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->getKeyLimit();
+}
+
+LogicGraph::LogicGraph::Key compact(void* logicGraph,LogicGraph::LogicGraph::Key* remap)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    std::vector<LogicGraph::LogicGraph::Key> table;
+    instance->compact(table);
+    if(remap != nullptr) std::copy(table.begin(),table.end(),remap);
+    return instance->getKeyLimit();
+}
+
 void setInputVal(void* logicGraph,int index,bool value)
 {
     LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
@@ -78,6 +120,89 @@ LogicGraph::LogicGraph::SByte getOutput(void* logicGraph,int index)
     return instance->getOutput(index);
 }
 
+int getSupportSize(void* logicGraph,int index)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return (int)instance->getSupport(index).size();
+}
+
+int getSupport(void* logicGraph,int index,int* inputs)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    auto& support = instance->getSupport(index);
+    for(size_t i = 0; i < support.size(); ++i) inputs[i] = (int)support[i];
+    return (int)support.size();
+}
+
+int getConeSize(void* logicGraph,int index)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return (int)instance->getConeSize(index);
+}
+
+bool evaluateSlice(void* logicGraph,int nodeBudget,int microseconds)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->evaluateSlice(nodeBudget < 0 ? 0 : (unsigned)nodeBudget,microseconds < 0 ? 0 : (unsigned)microseconds);
+}
+
+bool isOutputSettled(void* logicGraph,int index)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->isSettled(index);
+}
+
+void setResultCacheCapacity(void* logicGraph,int capacity)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    instance->setResultCacheCapacity(capacity < 0 ? 0 : (unsigned)capacity);
+}
+
+bool evaluateInputs(void* logicGraph,const unsigned long long* inputs,LogicGraph::LogicGraph::SByte* results)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->evaluate((const uint64_t*)inputs,results);
+}
+
+void getResultCacheStats(void* logicGraph,unsigned long long* hits,unsigned long long* misses)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    *hits = instance->getResultCacheHits();
+    *misses = instance->getResultCacheMisses();
+}
+
+int applyInputChanges(void* logicGraph,const int* indexes,const int* values,int count,int* changedIndexes,LogicGraph::LogicGraph::SByte* oldValues,LogicGraph::LogicGraph::SByte* newValues)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    std::vector<LogicGraph::LogicGraph::InputChange> changes(count < 0 ? 0 : count);
+    for(int i = 0; i < count; ++i){
+        changes[i].index = indexes[i];
+        changes[i].value = values[i] != 0;
+    }
+    std::vector<LogicGraph::LogicGraph::OutputChange> changed;
+    instance->applyInputChanges(changes,changed);
+    for(size_t i = 0; i < changed.size(); ++i){
+        changedIndexes[i] = changed[i].index;
+        oldValues[i] = changed[i].oldValue;
+        newValues[i] = changed[i].newValue;
+    }
+    return (int)changed.size();
+}
+
+int addOutputCallback(void* logicGraph,OutputChangedCallback callback,void* user)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->addOutputCallback([callback,user](const LogicGraph::LogicGraph::OutputChange& c){
+        callback(c.index,c.oldValue,c.newValue,user);
+    });
+}
+
+bool removeOutputCallback(void* logicGraph,int id)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->removeOutputCallback(id);
+}
+
 LogicGraph::LogicGraph::SByte testOutput(void* logicGraph,LogicGraph::LogicGraph::Key gate)
 {
     LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
@@ -100,4 +225,552 @@ LogicGraph::LogicGraph::SByte removeConnection(void* logicGraph,LogicGraph::Logi
 {
     LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
     return instance->removeConnection(gate0,gate1);
+}
+
+void* CreateFaultSimulator(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::FaultSimulator(*instance);
+}
+
+void DestroyFaultSimulator(void* faultSimulator)
+{
+    delete (LogicGraph::FaultSimulator*)faultSimulator;
+}
+
+int getFaultCount(void* faultSimulator)
+{
+    LogicGraph::FaultSimulator*simulator = (LogicGraph::FaultSimulator*)faultSimulator;
+    return (int)simulator->getFaultCount();
+}
+
+int getDetectedFaultCount(void* faultSimulator)
+{
+    LogicGraph::FaultSimulator*simulator = (LogicGraph::FaultSimulator*)faultSimulator;
+    return (int)simulator->getDetectedCount();
+}
+
+double getFaultCoverage(void* faultSimulator)
+{
+    LogicGraph::FaultSimulator*simulator = (LogicGraph::FaultSimulator*)faultSimulator;
+    return simulator->getCoverage();
+}
+
+int simulateFaults(void* faultSimulator,const char* vectors,int vectorCount)
+{
+    LogicGraph::FaultSimulator*simulator = (LogicGraph::FaultSimulator*)faultSimulator;
+    return (int)simulator->simulate(vectors,vectorCount);
+}
+
+LogicGraph::LogicGraph::SByte getFault(void* faultSimulator,int index,LogicGraph::LogicGraph::Key* gate,int* pin,int* value)
+{
+    LogicGraph::FaultSimulator*simulator = (LogicGraph::FaultSimulator*)faultSimulator;
+    if(index < 0 || (unsigned)index >= simulator->getFaultCount()) return -1;
+    auto& fault = simulator->getFault(index);
+    *gate = simulator->getNetlist().getKey(fault.node);
+    *pin = fault.pin;
+    *value = fault.value ? 1 : 0;
+    return fault.detectedBy >= 0 ? 1 : 0;
+}
+
+LogicGraph::LogicGraph::SByte equivalent(void* logicGraphA,void* logicGraphB,const int* inputMap,const int* outputMap,char* counterexampleA,char* counterexampleB,int conflictBudget)
+{
+    LogicGraph::LogicGraph*a = (LogicGraph::LogicGraph*)logicGraphA;
+    LogicGraph::LogicGraph*b = (LogicGraph::LogicGraph*)logicGraphB;
+    std::vector<int> ins(inputMap,inputMap + a->getInputCount());
+    std::vector<int> outs(outputMap,outputMap + a->getOutputCount());
+    std::string counterA;
+    std::string counterB;
+    auto c = LogicGraph::equivalent(*a,*b,ins,outs,&counterA,&counterB,conflictBudget);
+    if(c == 0 && counterexampleA != nullptr) std::copy(counterA.c_str(),counterA.c_str() + counterA.size() + 1,counterexampleA);
+    if(c == 0 && counterexampleB != nullptr) std::copy(counterB.c_str(),counterB.c_str() + counterB.size() + 1,counterexampleB);
+    return c;
+}
+
+void* CreateOutputSolver(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::OutputSolver(*instance);
+}
+
+void DestroyOutputSolver(void* outputSolver)
+{
+    delete (LogicGraph::OutputSolver*)outputSolver;
+}
+
+LogicGraph::LogicGraph::SByte solveOutput(void* outputSolver,int index,bool value,const char* assumptions,char* inputs,int conflictBudget)
+{
+    LogicGraph::OutputSolver*solver = (LogicGraph::OutputSolver*)outputSolver;
+    std::string found;
+    auto c = solver->solve(index < 0 ? ~0u : (unsigned)index,value,assumptions,&found,conflictBudget);
+    if(c == 1 && inputs != nullptr) std::copy(found.c_str(),found.c_str() + found.size() + 1,inputs);
+    return c;
+}
+
+LogicGraph::LogicGraph::Key addLut(void* logicGraph,unsigned long long table)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->addLut(table);
+}
+
+int mapToLuts(void* logicGraph,int lutSize)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    if(lutSize < 1) return -1;
+    LogicGraph::LutMapper mapper((unsigned)lutSize);
+    return mapper.map(*instance);
+}
+
+int replaceNode(void* logicGraph,LogicGraph::LogicGraph::Key old,LogicGraph::LogicGraph::Key with)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return instance->replaceNode(old,with);
+}
+
+int fraig(void* logicGraph,int rounds,int conflictBudget,int* removed)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    LogicGraph::Fraiger fraiger(rounds < 1 ? 1 : (unsigned)rounds,conflictBudget);
+    int merged = fraiger.sweep(*instance);
+
+    if(removed != nullptr) *removed = (int)fraiger.getRemoved();
+
+    return merged;
+}
+
+void* CreateBatchEvaluator(void* logicGraph,int threadCount)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::BatchEvaluator(*instance,threadCount < 0 ? 0 : (unsigned)threadCount);
+}
+
+void DestroyBatchEvaluator(void* batchEvaluator)
+{
+    delete (LogicGraph::BatchEvaluator*)batchEvaluator;
+}
+
+void* submitBatch(void* batchEvaluator,const char* vectors,int vectorCount,LogicGraph::LogicGraph::SByte* results,LogicGraph::BatchEvaluator::Callback callback,void* user)
+{
+    LogicGraph::BatchEvaluator*evaluator = (LogicGraph::BatchEvaluator*)batchEvaluator;
+    auto batch = evaluator->submit(vectors,vectorCount < 0 ? 0 : (unsigned)vectorCount,results,callback,user);
+    return new std::shared_ptr<LogicGraph::BatchEvaluator::Batch>(batch);
+}
+
+bool waitBatch(void* batch,int timeoutMs)
+{
+    return (*(std::shared_ptr<LogicGraph::BatchEvaluator::Batch>*)batch)->wait(timeoutMs);
+}
+
+void DestroyBatch(void* batch)
+{
+    delete (std::shared_ptr<LogicGraph::BatchEvaluator::Batch>*)batch;
+}
+
+long long simulateFile(void* logicGraph,const char* stimulusPath,const char* resultPath)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    LogicGraph::FileSimulator simulator(*instance);
+    return simulator.run(stimulusPath,resultPath);
+}
+
+void* CreateToggleRecorder(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::ToggleRecorder(*instance);
+}
+
+void DestroyToggleRecorder(void* toggleRecorder)
+{
+    delete (LogicGraph::ToggleRecorder*)toggleRecorder;
+}
+
+void recordToggles(void* toggleRecorder,const char* vectors,int vectorCount)
+{
+    LogicGraph::ToggleRecorder*recorder = (LogicGraph::ToggleRecorder*)toggleRecorder;
+    if(vectorCount > 0) recorder->simulate(vectors,vectorCount);
+}
+
+void resetToggles(void* toggleRecorder)
+{
+    LogicGraph::ToggleRecorder*recorder = (LogicGraph::ToggleRecorder*)toggleRecorder;
+    recorder->reset();
+}
+
+int getToggleNodeCount(void* toggleRecorder)
+{
+    LogicGraph::ToggleRecorder*recorder = (LogicGraph::ToggleRecorder*)toggleRecorder;
+    return recorder->getNodeCount();
+}
+
+unsigned long long getToggleCounts(void* toggleRecorder,LogicGraph::LogicGraph::Key* keys,unsigned long long* counts)
+{
+    LogicGraph::ToggleRecorder*recorder = (LogicGraph::ToggleRecorder*)toggleRecorder;
+    for(unsigned n = 0; n < recorder->getNodeCount(); ++n){
+        keys[n] = recorder->getKey(n);
+        counts[n] = recorder->getToggleCount(n);
+    }
+    return recorder->getVectorCount();
+}
+
+void* CreateTimingSimulator(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::TimingSimulator(*instance);
+}
+
+void DestroyTimingSimulator(void* timingSimulator)
+{
+    delete (LogicGraph::TimingSimulator*)timingSimulator;
+}
+
+unsigned long long simulateTiming(void* timingSimulator,const char* vectors,int vectorCount)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    return vectorCount > 0 ? sim->simulate(vectors,vectorCount) : 0;
+}
+
+unsigned long long getGlitchCount(void* timingSimulator,int index)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    return sim->getGlitchCount(index);
+}
+
+unsigned long long getSettleTime(void* timingSimulator,int index)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    return sim->getSettleTime(index);
+}
+
+unsigned long long getEventCount(void* timingSimulator)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    return sim->getEventCount();
+}
+
+int getWaveformLength(void* timingSimulator,int index)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    return (int)sim->getWaveform(index).size();
+}
+
+void getWaveform(void* timingSimulator,int index,unsigned long long* times,LogicGraph::LogicGraph::SByte* values)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    auto& wave = sim->getWaveform(index);
+    for(size_t i = 0; i < wave.size(); ++i){
+        times[i] = wave[i].time;
+        values[i] = wave[i].value ? 1 : 0;
+    }
+}
+
+void clearWaveforms(void* timingSimulator)
+{
+    LogicGraph::TimingSimulator*sim = (LogicGraph::TimingSimulator*)timingSimulator;
+    sim->clearWaveforms();
+}
+
+void* CreateShardedSimulator(void* logicGraph,int shardCount)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::ShardedSimulator(*instance,shardCount < 1 ? 1 : (unsigned)shardCount);
+}
+
+void DestroyShardedSimulator(void* shardedSimulator)
+{
+    delete (LogicGraph::ShardedSimulator*)shardedSimulator;
+}
+
+long long simulateSharded(void* shardedSimulator,const char* vectors,int vectorCount,LogicGraph::LogicGraph::SByte* results)
+{
+    LogicGraph::ShardedSimulator*sim = (LogicGraph::ShardedSimulator*)shardedSimulator;
+    return sim->run(vectors,vectorCount < 0 ? 0 : (unsigned)vectorCount,results);
+}
+
+int getShardCount(void* shardedSimulator)
+{
+    LogicGraph::ShardedSimulator*sim = (LogicGraph::ShardedSimulator*)shardedSimulator;
+    return (int)sim->getPartitioner().getShardCount();
+}
+
+int getShardCutCount(void* shardedSimulator)
+{
+    LogicGraph::ShardedSimulator*sim = (LogicGraph::ShardedSimulator*)shardedSimulator;
+    return (int)sim->getPartitioner().getCutCount();
+}
+
+void* CreateGraphFork(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::GraphFork(*instance);
+}
+
+void* ForkGraphFork(void* graphFork)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    return new LogicGraph::GraphFork(fork->fork());
+}
+
+void DestroyGraphFork(void* graphFork)
+{
+    delete (LogicGraph::GraphFork*)graphFork;
+}
+
+LogicGraph::LogicGraph::Key forkAddGate(void* graphFork,int type)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    switch(type){
+    case  0: return fork->addGate(LogicGraph::LogicGraph::Gates::AND);
+    case  1: return fork->addGate(LogicGraph::LogicGraph::Gates::OR);
+    case  2: return fork->addInverter();
+    case  3: return fork->addGate(LogicGraph::LogicGraph::Gates::NAND);
+    case  4: return fork->addGate(LogicGraph::LogicGraph::Gates::NOR);
+    case  5: return fork->addGate(LogicGraph::LogicGraph::Gates::XOR);
+    case  6: return fork->addGate(LogicGraph::LogicGraph::Gates::PARITY);
+    case  7: return fork->addGate(LogicGraph::LogicGraph::Gates::XNOR);
+    case  8: return fork->addGate(LogicGraph::LogicGraph::Gates::MAJORITY);
+    default: return 0;
+    }
+}
+
+LogicGraph::LogicGraph::SByte forkConnectGates(void* graphFork,LogicGraph::LogicGraph::Key gate,LogicGraph::LogicGraph::Key input)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    return fork->connectGates(gate,input);
+}
+
+LogicGraph::LogicGraph::SByte forkDisconnectGates(void* graphFork,LogicGraph::LogicGraph::Key gate,LogicGraph::LogicGraph::Key input)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    return fork->disconnectGates(gate,input);
+}
+
+LogicGraph::LogicGraph::SByte forkRemoveGate(void* graphFork,LogicGraph::LogicGraph::Key gate)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    return fork->removeGate(gate);
+}
+
+LogicGraph::LogicGraph::SByte forkReplaceGate(void* graphFork,LogicGraph::LogicGraph::Key gate,int type)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    switch(type){
+    case  0: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::AND);
+    case  1: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::OR);
+    case  3: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::NAND);
+    case  4: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::NOR);
+    case  5: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::XOR);
+    case  6: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::PARITY);
+    case  7: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::XNOR);
+    case  8: return fork->replaceGate(gate,LogicGraph::LogicGraph::Gates::MAJORITY);
+    default: return -4;
+    }
+}
+
+void forkSetInputVal(void* graphFork,int index,bool value)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    fork->setInputVal(index,value);
+}
+
+void forkOpenOutput(void* graphFork,LogicGraph::LogicGraph::Key gate,int index)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    fork->openOutput(gate,index);
+}
+
+void forkCloseOutput(void* graphFork,int index)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    fork->closeOutput(index);
+}
+
+LogicGraph::LogicGraph::SByte forkGetOutput(void* graphFork,int index)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    return fork->getOutput(index);
+}
+
+int forkGetEditCount(void* graphFork)
+{
+    LogicGraph::GraphFork*fork = (LogicGraph::GraphFork*)graphFork;
+    return (int)fork->getEditCount();
+}
+
+void* CreateModule(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new std::shared_ptr<const LogicGraph::Module>(std::make_shared<LogicGraph::Module>(*instance));
+}
+
+void DestroyModule(void* module)
+{
+    delete (std::shared_ptr<const LogicGraph::Module>*)module;
+}
+
+int getModuleInputCount(void* module)
+{
+    auto body = (std::shared_ptr<const LogicGraph::Module>*)module;
+    return (int)(*body)->getInputCount();
+}
+
+int getModuleOutputCount(void* module)
+{
+    auto body = (std::shared_ptr<const LogicGraph::Module>*)module;
+    return (int)(*body)->getOutputCount();
+}
+
+void* CreateWordModule(int kind,int width)
+{
+    if(kind < 0 || kind > LogicGraph::WordOp::MUX || width < 1 || width > (int)LogicGraph::WordOp::MAX_WIDTH) return nullptr;
+
+    return new std::shared_ptr<const LogicGraph::Module>(std::make_shared<LogicGraph::WordOp>((LogicGraph::WordOp::Kind)kind,(unsigned)width));
+}
+
+void setInputWord(void* logicGraph,int first,int width,unsigned long long value)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    instance->setInputWord(first,width,value);
+}
+
+LogicGraph::LogicGraph::SByte getOutputWord(void* logicGraph,int first,int width,unsigned long long* value)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    uint64_t w;
+    LogicGraph::LogicGraph::SByte c = instance->getOutputWord(first,width,w);
+    *value = w;
+    return c;
+}
+
+LogicGraph::LogicGraph::Key addInstance(void* logicGraph,void* module)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    auto body = (std::shared_ptr<const LogicGraph::Module>*)module;
+    return instance->addInstance(*body);
+}
+
+LogicGraph::LogicGraph::Key getPortKey(void* logicGraph,LogicGraph::LogicGraph::Key instance,int index)
+{
+    LogicGraph::LogicGraph*graph = (LogicGraph::LogicGraph*)logicGraph;
+    return graph->getPortKey(instance,index);
+}
+
+int flatten(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return (int)instance->flatten();
+}
+
+void* CreateFourStateSimulator(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::FourStateSimulator(*instance);
+}
+
+void DestroyFourStateSimulator(void* fourStateSimulator)
+{
+    delete (LogicGraph::FourStateSimulator*)fourStateSimulator;
+}
+
+int simulateFourState(void* fourStateSimulator,const char* vectors,int vectorCount,LogicGraph::LogicGraph::SByte* results)
+{
+    LogicGraph::FourStateSimulator*simulator = (LogicGraph::FourStateSimulator*)fourStateSimulator;
+    return (int)simulator->run(vectors,vectorCount,results);
+}
+
+void* CreateSelfTester(void* logicGraph,int lfsrWidth,unsigned long long lfsrTaps,unsigned long long seed,int misrWidth,unsigned long long misrTaps)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    if(lfsrTaps == 0) lfsrTaps = LogicGraph::SelfTester::DEFAULT_TAPS;
+    if(misrTaps == 0) misrTaps = LogicGraph::SelfTester::DEFAULT_TAPS;
+    return new LogicGraph::SelfTester(*instance,lfsrWidth,lfsrTaps,seed,misrWidth,misrTaps);
+}
+
+void DestroySelfTester(void* selfTester)
+{
+    delete (LogicGraph::SelfTester*)selfTester;
+}
+
+unsigned long long runSelfTest(void* selfTester,unsigned long long patternCount)
+{
+    LogicGraph::SelfTester*tester = (LogicGraph::SelfTester*)selfTester;
+    return tester->run(patternCount);
+}
+
+unsigned long long getSelfTestPatternCount(void* selfTester)
+{
+    LogicGraph::SelfTester*tester = (LogicGraph::SelfTester*)selfTester;
+    return tester->getPatternCount();
+}
+
+void* CreateInputQueue(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::InputQueue(instance->getInputCount());
+}
+
+void DestroyInputQueue(void* inputQueue)
+{
+    delete (LogicGraph::InputQueue*)inputQueue;
+}
+
+bool pushInput(void* inputQueue,int index,bool val)
+{
+    LogicGraph::InputQueue*queue = (LogicGraph::InputQueue*)inputQueue;
+    return index >= 0 && queue->push((unsigned)index,val);
+}
+
+int drainInputQueue(void* inputQueue,void* logicGraph)
+{
+    LogicGraph::InputQueue*queue = (LogicGraph::InputQueue*)inputQueue;
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return (int)queue->drain(*instance);
+}
+
+void* CreateCompactNetlist(void* logicGraph)
+{
+    LogicGraph::LogicGraph*instance = (LogicGraph::LogicGraph*)logicGraph;
+    return new LogicGraph::CompactNetlist(*instance);
+}
+
+void DestroyCompactNetlist(void* compactNetlist)
+{
+    delete (LogicGraph::CompactNetlist*)compactNetlist;
+}
+
+long long simulateCompact(void* compactNetlist,const char* vectors,long long vectorCount,LogicGraph::LogicGraph::SByte* results)
+{
+    LogicGraph::CompactNetlist*netlist = (LogicGraph::CompactNetlist*)compactNetlist;
+    return (long long)netlist->run(vectors,vectorCount < 0 ? 0 : (size_t)vectorCount,results);
+}
+
+long long getCompactNodeCount(void* compactNetlist)
+{
+    LogicGraph::CompactNetlist*netlist = (LogicGraph::CompactNetlist*)compactNetlist;
+    return (long long)netlist->size();
+}
+
+long long getCompactByteSize(void* compactNetlist)
+{
+    LogicGraph::CompactNetlist*netlist = (LogicGraph::CompactNetlist*)compactNetlist;
+    return (long long)netlist->getByteSize();
+}
+
+void setTracing(bool enabled)
+{
+    LogicGraph::Tracer::setEnabled(enabled);
+}
+
+void setTraceCapacity(int capacity)
+{
+    LogicGraph::Tracer::setCapacity(capacity < 1 ? 1 : (unsigned)capacity);
+}
+
+void clearTrace()
+{
+    LogicGraph::Tracer::clear();
+}
+
+long long exportTrace(const char* path)
+{
+    return LogicGraph::Tracer::exportJson(path);
 }
\ No newline at end of file
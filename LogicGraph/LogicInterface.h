@@ -3,6 +3,23 @@
 #define Logic_Interface
 
 #include "LogicGraph.h"
+#include "FaultSimulator.h"
+#include "Equivalence.h"
+#include "OutputSolver.h"
+#include "LutMapper.h"
+#include "BatchEvaluator.h"
+#include "FileSimulator.h"
+#include "ToggleRecorder.h"
+#include "TimingSimulator.h"
+#include "ShardedSimulator.h"
+#include "GraphFork.h"
+#include "Module.h"
+#include "FourStateSimulator.h"
+#include "SelfTester.h"
+#include "Fraiger.h"
+#include "WordOp.h"
+#include "InputQueue.h"
+#include "CompactNetlist.h"
 
 /// <summary>
 /// Creates the LogicGraph instance.
@@ -14,6 +31,12 @@ extern "C" __declspec(dllexport) void* CreateLogicGraph(int inputCount,int outpu
 /// </summary>
 extern "C" __declspec(dllexport) void DestroyLogicGraph(void* logicGraph);
 
+/// <summary>
+/// Creates a deep copy of the LogicGraph instance with the same keys, gates, input values and outputs.
+/// Output callbacks are not copied. Destroy it with DestroyLogicGraph.
+/// </summary>
+extern "C" __declspec(dllexport) void* CloneLogicGraph(void* logicGraph);
+
 /// <summary>
 /// Adds a gate to the logic graph.
 /// </sumary>
@@ -24,7 +47,10 @@ extern "C" __declspec(dllexport) void DestroyLogicGraph(void* logicGraph);
 /// 2: NOT
 /// 3: NAND
 /// 4: NOR
-/// 5: XOR
+/// 5: XOR (exactly one input true)
+/// 6: PARITY (an odd number of inputs true)
+/// 7: XNOR (an even number of inputs true)
+/// 8: MAJORITY (more than half of the inputs true)
 /// </params>
 /// <returns>
 /// 0: Invalid type.
@@ -32,6 +58,24 @@ extern "C" __declspec(dllexport) void DestroyLogicGraph(void* logicGraph);
 /// </returns>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key addGate(void* logicGraph,int type);
 
+/// <summary>
+/// Adds a gate that is true when k or more of its inputs are.
+/// </summary>
+/// <returns>
+/// The key of the gate added.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key addThresholdGate(void* logicGraph,int k);
+
+/// <summary>
+/// Adds a multiplexer of 1 or 2 select inputs. Connect the 2 or 4 data inputs first,
+/// then the selects, lowest bit first.
+/// </summary>
+/// <returns>
+/// 0: selects is not 1 or 2.
+/// Else: The key of the node added.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key addMux(void* logicGraph,int selects);
+
 /// <summary>
 /// Connects two gates.
 /// </summary>
@@ -39,8 +83,9 @@ extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key addGate(void* logic
 ///  0: Success
 ///  1: Input already exists
 ///  2: Given key is an output
-///  3: (for inverter) Already has an input
+///  3: (for inverter, lookup table, instance or port) No room for another input
 /// -1: (for input) This is an input node, it cannot have an input added
+/// -2: The input is a module instance; connect one of its ports instead.
 /// </returns>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte connectGates(void*logicGraph,LogicGraph::LogicGraph::Key gate,LogicGraph::LogicGraph::Key input);
 
@@ -71,6 +116,16 @@ extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte disconnectGates(v
 /// </returns>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte removeGate(void* logicGraph,LogicGraph::LogicGraph::Key gate);
 
+/// <summary>
+/// Sets the time the gate takes to switch to true and to false, for timing simulation.
+/// Gates start with both at 1.
+/// </summary>
+/// <returns>
+///  0: Success
+/// -3: That key does not exist.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte setGateDelay(void* logicGraph,LogicGraph::LogicGraph::Key gate,unsigned rise,unsigned fall);
+
 /// <summary>
 /// Gets the key of the indexed input gate.
 /// </summary>
@@ -81,6 +136,22 @@ extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key getInputKey(void* l
 /// </summary>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key createKey(void* logicGraph);
 
+/// <summary>
+/// Returns one past the largest key handed out so far.
+/// </summary>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key getKeyLimit(void* logicGraph);
+
+/// <summary>
+/// Renumbers the nodes from 1 with no gaps, each after its inputs, and rebuilds them in that order.
+/// </summary>
+/// <params>
+/// remap: Null, or room for getKeyLimit entries; receives the new key of every old key, indexed by old key, 0 for keys with no node.
+/// </params>
+/// <returns>
+/// The new key limit.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key compact(void* logicGraph,LogicGraph::LogicGraph::Key* remap);
+
 /// <summary>
 /// Sets the value of the indexed input.
 /// </summary>
@@ -108,6 +179,105 @@ extern "C" __declspec(dllexport) void closeOutput(void* logicGraph,int index);
 /// </returns>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte getOutput(void* logicGraph,int index);
 
+/// <summary>
+/// Returns the number of inputs the output is connected to through any path; 0 for a closed output.
+/// </summary>
+extern "C" __declspec(dllexport) int getSupportSize(void* logicGraph,int index);
+
+/// <summary>
+/// Fills inputs, which must have room for getSupportSize values, with the indexes of the inputs
+/// the output is connected to, in ascending order. Setting any other input leaves the output as it is.
+/// </summary>
+/// <returns>
+/// The number of indexes written.
+/// </returns>
+extern "C" __declspec(dllexport) int getSupport(void* logicGraph,int index,int* inputs);
+
+/// <summary>
+/// Returns the number of nodes the output depends on, itself and its support included.
+/// </summary>
+extern "C" __declspec(dllexport) int getConeSize(void* logicGraph,int index);
+
+/// <summary>
+/// Works towards the value of every open output for a limited time, picking up where the
+/// last call stopped, so a large evaluation can be spread over many short calls.
+/// </summary>
+/// <params>
+/// nodeBudget: Nodes to evaluate at most; 0 for no limit.
+/// microseconds: Time to spend at most; 0 for no limit.
+/// </params>
+/// <returns>
+/// Whether every open output is settled.
+/// </returns>
+extern "C" __declspec(dllexport) bool evaluateSlice(void* logicGraph,int nodeBudget,int microseconds);
+
+/// <summary>
+/// Whether the indexed output is closed or its value is known, so getOutput returns at once.
+/// </summary>
+extern "C" __declspec(dllexport) bool isOutputSettled(void* logicGraph,int index);
+
+/// <summary>
+/// Keeps the outputs of up to capacity input vectors passed to evaluateInputs, dropping the
+/// least recently used first; 0, the default, keeps none. Empties the cache and its counts.
+/// </summary>
+extern "C" __declspec(dllexport) void setResultCacheCapacity(void* logicGraph,int capacity);
+
+/// <summary>
+/// Sets the inputs to a vector and reads every output, or answers from the result cache
+/// without touching the graph if the vector is there. Editing the graph, or opening or
+/// closing an output, empties the cache.
+/// </summary>
+/// <params>
+/// inputs: (input count + 63) / 64 words, input i in bit i % 64 of word i / 64.
+/// results: Receives each output coded as getOutput.
+/// </params>
+/// <returns>
+/// Whether the outputs came from the cache.
+/// </returns>
+extern "C" __declspec(dllexport) bool evaluateInputs(void* logicGraph,const unsigned long long* inputs,LogicGraph::LogicGraph::SByte* results);
+
+/// <summary>
+/// Gets the number of vectors evaluateInputs answered from the result cache and the number it had to simulate.
+/// </summary>
+extern "C" __declspec(dllexport) void getResultCacheStats(void* logicGraph,unsigned long long* hits,unsigned long long* misses);
+
+/// <summary>
+/// Called once per output change that applyInputChanges reports.
+/// </summary>
+typedef void (*OutputChangedCallback)(int index,LogicGraph::LogicGraph::SByte oldValue,LogicGraph::LogicGraph::SByte newValue,void* user);
+
+/// <summary>
+/// Sets the listed inputs, then reports the outputs whose values differ from the last ones reported.
+/// Only the outputs the changes propagated to are read. Outputs opened, closed or rewired since
+/// the last report count as well; an output never reported before had the value -3.
+/// </summary>
+/// <params>
+/// indexes, values: count input indexes and their new values (nonzero for true).
+/// changedIndexes, oldValues, newValues: Room for the output count; receive the changed outputs,
+/// values coded as getOutput.
+/// </params>
+/// <returns>
+/// The number of outputs that changed.
+/// </returns>
+extern "C" __declspec(dllexport) int applyInputChanges(void* logicGraph,const int* indexes,const int* values,int count,int* changedIndexes,LogicGraph::LogicGraph::SByte* oldValues,LogicGraph::LogicGraph::SByte* newValues);
+
+/// <summary>
+/// Registers a callback, called with user for each change applyInputChanges reports.
+/// The callback must not edit the graph.
+/// </summary>
+/// <returns>
+/// The id to remove the callback with.
+/// </returns>
+extern "C" __declspec(dllexport) int addOutputCallback(void* logicGraph,OutputChangedCallback callback,void* user);
+
+/// <summary>
+/// Removes a callback added with addOutputCallback.
+/// </summary>
+/// <returns>
+/// Whether a callback had that id.
+/// </returns>
+extern "C" __declspec(dllexport) bool removeOutputCallback(void* logicGraph,int id);
+
 /// <summary>
 /// Returns the output of the gate based on the inputs.
 /// </summary>
@@ -126,7 +296,7 @@ extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte testOutput(void*
 ///  0: Success
 ///  1: Input already exists
 ///  2: Given key is an output
-///  3: (for inverter) Already has an input
+///  3: (for inverter or lookup table) No room for another input
 /// -1: (for input) This is an input node, it cannot have an input added
 /// </returns>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte inputToGate(void* logicGraph,LogicGraph::LogicGraph::Key gate,int index);
@@ -163,4 +333,614 @@ extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte removeInputToGate
 /// </returns>
 extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte removeConnection(void* logicGraph,LogicGraph::LogicGraph::Key gate0,LogicGraph::LogicGraph::Key gate1);
 
+/// <summary>
+/// Creates a fault simulator over a snapshot of the logic graph.
+/// Later edits to the graph do not reach the simulator.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateFaultSimulator(void* logicGraph);
+
+/// <summary>
+/// Destroys the fault simulator.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyFaultSimulator(void* faultSimulator);
+
+/// <summary>
+/// Returns the number of faults in the collapsed fault list.
+/// </summary>
+extern "C" __declspec(dllexport) int getFaultCount(void* faultSimulator);
+
+/// <summary>
+/// Returns the number of faults detected so far.
+/// </summary>
+extern "C" __declspec(dllexport) int getDetectedFaultCount(void* faultSimulator);
+
+/// <summary>
+/// Returns the detected share of the fault list, 0 to 1.
+/// </summary>
+extern "C" __declspec(dllexport) double getFaultCoverage(void* faultSimulator);
+
+/// <summary>
+/// Simulates the undetected faults against the test vectors.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back.
+/// </params>
+/// <returns>
+/// The number of faults detected by these vectors.
+/// </returns>
+extern "C" __declspec(dllexport) int simulateFaults(void* faultSimulator,const char* vectors,int vectorCount);
+
+/// <summary>
+/// Describes the indexed fault.
+/// </summary>
+/// <params>
+/// gate: Receives the key of the node the fault sits on.
+/// pin: Receives -1 for the node's output, else the position of the faulty input in key order.
+/// value: Receives the stuck-at value.
+/// </params>
+/// <returns>
+///  1: Detected
+///  0: Not detected
+/// -1: No such fault
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte getFault(void* faultSimulator,int index,LogicGraph::LogicGraph::Key* gate,int* pin,int* value);
+
+/// <summary>
+/// Checks that two logic graphs compute the same outputs for every input.
+/// </summary>
+/// <params>
+/// inputMap: For each input of A, the input of B it drives, or -1. Inputs of B left out are free.
+/// outputMap: For each output of A, the output of B that must match it, or -1 to skip it.
+/// counterexampleA: Null, or room for the input count of A plus one; receives a '0'/'1' vector of A on a difference.
+/// counterexampleB: Null, or room for the input count of B plus one; receives the matching vector of B.
+/// conflictBudget: Conflicts the solver may spend on each output pair; negative for no limit.
+/// </params>
+/// <returns>
+///  1: Equivalent
+///  0: Not equivalent, see the counterexamples.
+/// -1: Undecided within the conflict budget.
+/// -2: A map entry is out of range or two inputs of A drive the same input of B.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte equivalent(void* logicGraphA,void* logicGraphB,const int* inputMap,const int* outputMap,char* counterexampleA,char* counterexampleB,int conflictBudget);
+
+/// <summary>
+/// Creates an output solver over a snapshot of the logic graph.
+/// Later edits to the graph do not reach the solver.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateOutputSolver(void* logicGraph);
+
+/// <summary>
+/// Destroys the output solver.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyOutputSolver(void* outputSolver);
+
+/// <summary>
+/// Looks for inputs that give the indexed output the value.
+/// </summary>
+/// <params>
+/// assumptions: Null, or one character per input: '0' or '1' holds the input at that value
+/// for this query, anything else leaves it free.
+/// inputs: Null, or room for the input count plus one; receives the '0'/'1' input vector on success.
+/// conflictBudget: Conflicts the solver may spend; negative for no limit.
+/// </params>
+/// <returns>
+///  1: Found, see inputs.
+///  0: No input vector gives the output that value.
+/// -1: No inputs (from Node.output)
+/// -3: An output does not exist.
+/// -4: Undecided within the conflict budget.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte solveOutput(void* outputSolver,int index,bool value,const char* assumptions,char* inputs,int conflictBudget);
+
+/// <summary>
+/// Adds a lookup table node to the logic graph.
+/// Bit m of the table is the output when input i, in connection order, is bit i of m.
+/// </summary>
+/// <returns>
+/// The key of the node added.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key addLut(void* logicGraph,unsigned long long table);
+
+/// <summary>
+/// Maps the logic graph in place onto lookup table nodes of at most lutSize inputs.
+/// Nodes bound to an output keep their keys; nodes absorbed into a table are removed.
+/// </summary>
+/// <returns>
+/// -1: The table size is not 1 to 6.
+/// Else: The number of lookup table nodes in the graph.
+/// </returns>
+extern "C" __declspec(dllexport) int mapToLuts(void* logicGraph,int lutSize);
+
+/// <summary>
+/// Moves every node reading the old node, and every output bound to it, over to the new one,
+/// then removes the old node and the part of its cone nothing reads any more.
+/// </summary>
+/// <returns>
+/// -1: A node reading old reads with already.
+/// -2: with is fed by old, so moving its readers would close a loop.
+/// -3: A key does not exist, old is an input or an instance, with is an instance, or the two are the same.
+/// Else: The number of nodes removed.
+/// </returns>
+extern "C" __declspec(dllexport) int replaceNode(void* logicGraph,LogicGraph::LogicGraph::Key old,LogicGraph::LogicGraph::Key with);
+
+/// <summary>
+/// Merges the nodes of the logic graph that compute the same function: random simulation
+/// picks the candidates and the SAT solver proves each before it is merged.
+/// Instances are flattened first.
+/// </summary>
+/// <params>
+/// rounds: Simulation rounds of 64 patterns.
+/// conflictBudget: Conflicts the solver may spend on each candidate; negative for no limit.
+/// removed: If not null, receives the number of nodes removed, the merged ones included.
+/// </params>
+/// <returns>
+/// The number of nodes merged into another.
+/// </returns>
+extern "C" __declspec(dllexport) int fraig(void* logicGraph,int rounds,int conflictBudget,int* removed);
+
+/// <summary>
+/// Creates a batch evaluator with its own worker threads over a snapshot of the logic graph.
+/// Later edits to the graph do not reach the evaluator.
+/// </summary>
+/// <params>
+/// threadCount: The number of workers; 0 for one per hardware thread.
+/// </params>
+extern "C" __declspec(dllexport) void* CreateBatchEvaluator(void* logicGraph,int threadCount);
+
+/// <summary>
+/// Destroys the batch evaluator once the batches already submitted are done.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyBatchEvaluator(void* batchEvaluator);
+
+/// <summary>
+/// Queues a batch of input vectors and returns at once.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back. Copied.
+/// results: Room for vectorCount * output count values, kept alive until the batch is done.
+/// Vector v, output o lands at v * output count + o, coded as getOutput.
+/// callback: Null, or called with user on a worker thread once the batch is done.
+/// </params>
+/// <returns>
+/// A handle to the batch, to be released with DestroyBatch whether or not the batch is done.
+/// </returns>
+extern "C" __declspec(dllexport) void* submitBatch(void* batchEvaluator,const char* vectors,int vectorCount,LogicGraph::LogicGraph::SByte* results,LogicGraph::BatchEvaluator::Callback callback,void* user);
+
+/// <summary>
+/// Waits for the batch; a negative timeout waits for good.
+/// </summary>
+/// <returns>
+/// Whether the batch is done.
+/// </returns>
+extern "C" __declspec(dllexport) bool waitBatch(void* batch,int timeoutMs);
+
+/// <summary>
+/// Releases the batch handle. A batch still running finishes, and calls back, regardless.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyBatch(void* batch);
+
+/// <summary>
+/// Streams every vector of a stimulus file through the logic graph into a result file.
+/// </summary>
+/// <params>
+/// stimulusPath: One '0'/'1' vector per line, or (input count + 7) / 8 bytes per vector with input i in bit i % 8 of byte i / 8.
+/// resultPath: Receives (output count + 7) / 8 bytes per vector, output o in bit o % 8 of byte o / 8.
+/// Outputs that are closed or report an error read 0.
+/// </params>
+/// <returns>
+/// -1: The stimulus file could not be opened.
+/// -2: The result file could not be written.
+/// Else: The number of vectors simulated.
+/// </returns>
+extern "C" __declspec(dllexport) long long simulateFile(void* logicGraph,const char* stimulusPath,const char* resultPath);
+
+/// <summary>
+/// Creates a toggle recorder over a snapshot of the logic graph.
+/// Later edits to the graph do not reach the recorder.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateToggleRecorder(void* logicGraph);
+
+/// <summary>
+/// Destroys the toggle recorder.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyToggleRecorder(void* toggleRecorder);
+
+/// <summary>
+/// Simulates the vectors in order, counting every node's changes of value from one vector to the next.
+/// The first vector follows on from the last vector of the previous call.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back.
+/// </params>
+extern "C" __declspec(dllexport) void recordToggles(void* toggleRecorder,const char* vectors,int vectorCount);
+
+/// <summary>
+/// Forgets the counts and the last vector.
+/// </summary>
+extern "C" __declspec(dllexport) void resetToggles(void* toggleRecorder);
+
+/// <summary>
+/// Returns the number of nodes counted, inputs included.
+/// </summary>
+extern "C" __declspec(dllexport) int getToggleNodeCount(void* toggleRecorder);
+
+/// <summary>
+/// Exports the node to toggle count table.
+/// </summary>
+/// <params>
+/// keys, counts: Room for getToggleNodeCount entries each; receive every node's key and toggle count.
+/// </params>
+/// <returns>
+/// The number of vectors recorded.
+/// </returns>
+extern "C" __declspec(dllexport) unsigned long long getToggleCounts(void* toggleRecorder,LogicGraph::LogicGraph::Key* keys,unsigned long long* counts);
+
+/// <summary>
+/// Creates a timing simulator over a snapshot of the logic graph and its gate delays,
+/// settled on all-zero inputs. Later edits to the graph do not reach the simulator.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateTimingSimulator(void* logicGraph);
+
+/// <summary>
+/// Destroys the timing simulator.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyTimingSimulator(void* timingSimulator);
+
+/// <summary>
+/// Applies the vectors in order, each once the previous one has settled.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back.
+/// </params>
+/// <returns>
+/// The longest time any of the vectors took to settle.
+/// </returns>
+extern "C" __declspec(dllexport) unsigned long long simulateTiming(void* timingSimulator,const char* vectors,int vectorCount);
+
+/// <summary>
+/// Returns the number of pulses on the indexed output that came and went within one vector.
+/// </summary>
+extern "C" __declspec(dllexport) unsigned long long getGlitchCount(void* timingSimulator,int index);
+
+/// <summary>
+/// Returns the longest time the indexed output took to settle after a vector was applied.
+/// </summary>
+extern "C" __declspec(dllexport) unsigned long long getSettleTime(void* timingSimulator,int index);
+
+/// <summary>
+/// Returns the number of switches simulated so far.
+/// </summary>
+extern "C" __declspec(dllexport) unsigned long long getEventCount(void* timingSimulator);
+
+/// <summary>
+/// Returns the number of switches in the waveform of the indexed output.
+/// </summary>
+extern "C" __declspec(dllexport) int getWaveformLength(void* timingSimulator,int index);
+
+/// <summary>
+/// Copies the waveform of the indexed output.
+/// </summary>
+/// <params>
+/// times, values: Room for getWaveformLength entries; receive when each switch happened and the value switched to.
+/// </params>
+extern "C" __declspec(dllexport) void getWaveform(void* timingSimulator,int index,unsigned long long* times,LogicGraph::LogicGraph::SByte* values);
+
+/// <summary>
+/// Empties every waveform; glitch counts and settle times are kept.
+/// </summary>
+extern "C" __declspec(dllexport) void clearWaveforms(void* timingSimulator);
+
 #endif//Logic_Interface
+
+/// <summary>
+/// Cuts a snapshot of the logic graph into shards with few edges between them and starts
+/// a worker process for each. Later edits to the graph do not reach the simulator.
+/// Workers only run on POSIX systems.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateShardedSimulator(void* logicGraph,int shardCount);
+
+/// <summary>
+/// Stops the worker processes and destroys the sharded simulator.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyShardedSimulator(void* shardedSimulator);
+
+/// <summary>
+/// Simulates the vectors across the worker processes.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back.
+/// results: Room for vectorCount * output count values.
+/// Vector v, output o lands at v * output count + o, coded as LogicGraph.getOutput.
+/// </params>
+/// <returns>
+/// -1: The workers are not running, or one of them stopped answering; they are shut down.
+/// Else: The number of vectors simulated.
+/// </returns>
+extern "C" __declspec(dllexport) long long simulateSharded(void* shardedSimulator,const char* vectors,int vectorCount,LogicGraph::LogicGraph::SByte* results);
+
+/// <summary>
+/// Returns the number of shards the graph was cut into.
+/// </summary>
+extern "C" __declspec(dllexport) int getShardCount(void* shardedSimulator);
+
+/// <summary>
+/// Returns the number of edges between gates of different shards.
+/// </summary>
+extern "C" __declspec(dllexport) int getShardCutCount(void* shardedSimulator);
+
+/// <summary>
+/// Creates a copy-on-write fork of the logic graph: a snapshot to edit without touching the graph.
+/// Later edits to the graph do not reach the fork.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateGraphFork(void* logicGraph);
+
+/// <summary>
+/// Creates a fork of a fork, sharing everything but the edits made to either from here on.
+/// </summary>
+extern "C" __declspec(dllexport) void* ForkGraphFork(void* graphFork);
+
+/// <summary>
+/// Destroys the fork; its own forks are unaffected.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyGraphFork(void* graphFork);
+
+/// <summary>
+/// Adds a gate to the fork, with the types of addGate.
+/// </summary>
+/// <returns>
+/// 0: Invalid type.
+/// Else: The key of the gate added.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key forkAddGate(void* graphFork,int type);
+
+/// <summary>
+/// Connects two gates of the fork.
+/// </summary>
+/// <returns>
+///  0: Success
+///  1: Input already exists
+///  2: Given key is an output
+///  3: (for inverter or lookup table) No room for another input
+/// -1: (for input) This is an input node, it cannot have an input added
+/// -3: A key does not exist.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte forkConnectGates(void* graphFork,LogicGraph::LogicGraph::Key gate,LogicGraph::LogicGraph::Key input);
+
+/// <summary>
+/// Removes an input from a gate of the fork.
+/// </summary>
+/// <returns>
+///  0: Success
+/// -1: Node has no inputs.
+/// -2: Passed key is not an input.
+/// -3: A key does not exist.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte forkDisconnectGates(void* graphFork,LogicGraph::LogicGraph::Key gate,LogicGraph::LogicGraph::Key input);
+
+/// <summary>
+/// Removes a gate from the fork.
+/// </summary>
+/// <returns>
+/// -3: That key does not exist.
+///  0: Success
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte forkRemoveGate(void* graphFork,LogicGraph::LogicGraph::Key gate);
+
+/// <summary>
+/// Changes the function of a gate of the fork, keeping its inputs. Types are those of addGate, but for 2 (NOT).
+/// </summary>
+/// <returns>
+///  0: Success
+/// -1: The node is not a gate.
+/// -3: That key does not exist.
+/// -4: Invalid type.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte forkReplaceGate(void* graphFork,LogicGraph::LogicGraph::Key gate,int type);
+
+extern "C" __declspec(dllexport) void forkSetInputVal(void* graphFork,int index,bool value);
+
+extern "C" __declspec(dllexport) void forkOpenOutput(void* graphFork,LogicGraph::LogicGraph::Key gate,int index);
+
+extern "C" __declspec(dllexport) void forkCloseOutput(void* graphFork,int index);
+
+/// <summary>
+/// Returns the indexed output of the fork, coded as getOutput.
+/// </summary>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte forkGetOutput(void* graphFork,int index);
+
+/// <summary>
+/// Returns the number of nodes the fork holds its own copy of.
+/// </summary>
+extern "C" __declspec(dllexport) int forkGetEditCount(void* graphFork);
+
+
+/// <summary>
+/// Creates a module from the graph, whose inputs and outputs become the module's. The module
+/// keeps its own copy; the graph may be changed or destroyed afterwards.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateModule(void* logicGraph);
+
+/// <summary>
+/// Releases the module. Instances already added keep it alive as long as they need it.
+/// </summary>
+extern "C" __declspec(dllexport) void DestroyModule(void* module);
+
+extern "C" __declspec(dllexport) int getModuleInputCount(void* module);
+
+extern "C" __declspec(dllexport) int getModuleOutputCount(void* module);
+
+/// <summary>
+/// Creates a word-level datapath cell as a module: add its instances with addInstance.
+/// Inputs are operand A then B (or the shift amount, or B and then the select), least
+/// significant bit first; outputs are the result bits, then the carry or borrow.
+/// </summary>
+/// <params>
+/// kind: 0 ADD, 1 SUB, 2 AND, 3 OR, 4 XOR, 5 EQUAL, 6 LESS (unsigned), 7 SHIFT_LEFT, 8 SHIFT_RIGHT, 9 MUX
+/// width: 1 to 64.
+/// </params>
+/// <returns>
+/// Null if kind or width is out of range; else the module, released with DestroyModule.
+/// </returns>
+extern "C" __declspec(dllexport) void* CreateWordModule(int kind,int width);
+
+/// <summary>
+/// Sets width inputs from first on to the bits of value, lowest bit first.
+/// </summary>
+extern "C" __declspec(dllexport) void setInputWord(void* logicGraph,int first,int width,unsigned long long value);
+
+/// <summary>
+/// Reads width outputs from first on into the bits of value, lowest bit first.
+/// </summary>
+/// <returns>
+///  0: Success
+/// Else: The error of the first output that has one, as getOutput.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::SByte getOutputWord(void* logicGraph,int first,int width,unsigned long long* value);
+
+/// <summary>
+/// Adds an instance of the module, and a port node for each of its outputs. Connect the
+/// module's inputs to the instance in order, and read its outputs from the ports.
+/// </summary>
+/// <returns>
+/// The key of the instance.
+/// </returns>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key addInstance(void* logicGraph,void* module);
+
+/// <summary>
+/// Returns the key of the port reading the indexed output of an instance, or 0 if there is none.
+/// </summary>
+extern "C" __declspec(dllexport) LogicGraph::LogicGraph::Key getPortKey(void* logicGraph,LogicGraph::LogicGraph::Key instance,int index);
+
+/// <summary>
+/// Replaces every instance whose inputs are all connected by a copy of its module's gates.
+/// Ports keep their keys.
+/// </summary>
+/// <returns>
+/// The number of instances replaced.
+/// </returns>
+extern "C" __declspec(dllexport) int flatten(void* logicGraph);
+
+/// <summary>
+/// Creates a simulator over 0, 1, X and Z for the graph as it is now.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateFourStateSimulator(void* logicGraph);
+
+extern "C" __declspec(dllexport) void DestroyFourStateSimulator(void* fourStateSimulator);
+
+/// <summary>
+/// Simulates the vectors over four values, 64 at a time.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0', '1', 'x' and 'z', each as long as the input count, back to back.
+/// results: Room for vectorCount * output count values; vector v, output o lands at v * output count + o.
+/// </params>
+/// <returns>
+/// The number of vectors simulated. Results are 0, 1, 2 for X, 3 for Z, or -3 for a closed output.
+/// </returns>
+extern "C" __declspec(dllexport) int simulateFourState(void* fourStateSimulator,const char* vectors,int vectorCount,LogicGraph::LogicGraph::SByte* results);
+
+/// <summary>
+/// Creates a self-tester for the graph as it is now: LFSR patterns in, MISR signature out.
+/// </summary>
+/// <params>
+/// lfsrWidth, misrWidth: 1 to 64.
+/// lfsrTaps, misrTaps: Bit j stands for the x^j term of the polynomial; 0 takes x^32 + x^22 + x^2 + x + 1.
+/// seed: The first lfsrWidth bits of the pattern stream; must not be 0.
+/// </params>
+extern "C" __declspec(dllexport) void* CreateSelfTester(void* logicGraph,int lfsrWidth,unsigned long long lfsrTaps,unsigned long long seed,int misrWidth,unsigned long long misrTaps);
+
+extern "C" __declspec(dllexport) void DestroySelfTester(void* selfTester);
+
+/// <summary>
+/// Applies the next patternCount patterns, continuing from the last run.
+/// </summary>
+/// <returns>
+/// The signature after the last pattern.
+/// </returns>
+extern "C" __declspec(dllexport) unsigned long long runSelfTest(void* selfTester,unsigned long long patternCount);
+
+/// <summary>
+/// Returns the number of patterns applied so far.
+/// </summary>
+extern "C" __declspec(dllexport) unsigned long long getSelfTestPatternCount(void* selfTester);
+
+/// <summary>
+/// Creates a queue of input updates for the logic graph's inputs.
+/// Any thread may push into it; the thread that evaluates the graph drains it.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateInputQueue(void* logicGraph);
+
+extern "C" __declspec(dllexport) void DestroyInputQueue(void* inputQueue);
+
+/// <summary>
+/// Queues a value for an input without blocking; safe from any thread.
+/// A later push to the same input before the next drain replaces this one.
+/// </summary>
+/// <returns>
+/// False if there is no such input.
+/// </returns>
+extern "C" __declspec(dllexport) bool pushInput(void* inputQueue,int index,bool val);
+
+/// <summary>
+/// Sets every input pushed since the last drain to its last pushed value.
+/// Call it from the thread that evaluates the graph, before evaluating.
+/// </summary>
+/// <returns>
+/// The number of inputs set.
+/// </returns>
+extern "C" __declspec(dllexport) int drainInputQueue(void* inputQueue,void* logicGraph);
+
+/// <summary>
+/// Packs a snapshot of the logic graph into a compact netlist of a few bytes per gate.
+/// Later edits to the graph do not reach it.
+/// </summary>
+extern "C" __declspec(dllexport) void* CreateCompactNetlist(void* logicGraph);
+
+extern "C" __declspec(dllexport) void DestroyCompactNetlist(void* compactNetlist);
+
+/// <summary>
+/// Simulates the vectors on the compact netlist.
+/// </summary>
+/// <params>
+/// vectors: vectorCount strings of '0'/'1', each as long as the input count, back to back.
+/// results: Room for vectorCount * output count values.
+/// Vector v, output o lands at v * output count + o, coded as LogicGraph.getOutput.
+/// </params>
+/// <returns>
+/// The number of vectors simulated.
+/// </returns>
+extern "C" __declspec(dllexport) long long simulateCompact(void* compactNetlist,const char* vectors,long long vectorCount,LogicGraph::LogicGraph::SByte* results);
+
+/// <summary>
+/// Returns the number of nodes of the compact netlist, inputs and flattened module gates included.
+/// </summary>
+extern "C" __declspec(dllexport) long long getCompactNodeCount(void* compactNetlist);
+
+/// <summary>
+/// Returns the bytes the compact netlist takes.
+/// </summary>
+extern "C" __declspec(dllexport) long long getCompactByteSize(void* compactNetlist);
+
+/// <summary>
+/// Turns timeline tracing of graph operations on or off for every graph and thread.
+/// </summary>
+extern "C" __declspec(dllexport) void setTracing(bool enabled);
+
+/// <summary>
+/// Sets the trace events each thread keeps, the latest once its buffer is full; threads that start tracing from now on take it.
+/// </summary>
+extern "C" __declspec(dllexport) void setTraceCapacity(int capacity);
+
+/// <summary>
+/// Drops every recorded trace event.
+/// </summary>
+extern "C" __declspec(dllexport) void clearTrace();
+
+/// <summary>
+/// Writes the recorded trace events to a Chrome trace JSON file, which chrome://tracing and Perfetto open.
+/// </summary>
+/// <returns>
+/// -1: The file could not be written.
+/// Else: The number of events written.
+/// </returns>
+extern "C" __declspec(dllexport) long long exportTrace(const char* path);
@@ -0,0 +1,596 @@
+/// Technology mapping of a logic graph into lookup table nodes.
+#ifndef LOGIC_LUT_MAPPER
+#define LOGIC_LUT_MAPPER
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Covers a logic graph with cones of at most K inputs and replaces each
+    /// cone with one lookup table node.
+    /// Cuts are enumerated bottom up, keeping a few priority cuts per node.
+    /// A depth optimal cover is found first, then area flow is recovered
+    /// without making the cover deeper.
+    /// </summary>
+    class LutMapper
+    {
+    public:
+
+        typedef Netlist::Word Word;
+        typedef LogicGraph::Key Key;
+
+        LutMapper() = delete;
+
+        explicit LutMapper(unsigned lutSize = LogicGraph::LutNode::MAX_INPUTS)
+        {
+            k = lutSize;
+            lutCount = 0;
+            depth = 0;
+            removed = 0;
+        }
+
+        /// <summary>
+        /// Maps the graph in place. Nodes bound to an output, and nodes that feed
+        /// nothing, keep their keys; the nodes absorbed into a table are removed.
+        /// Gates with more inputs than fit a table, and nodes that report an error,
+        /// are kept as they are. Module instances are flattened first.
+        /// </summary>
+        /// <returns>
+        /// -1: The table size is not 1 to 6.
+        /// Else: The number of lookup table nodes in the graph.
+        /// </returns>
+        int map(LogicGraph& graph)
+        {
+            if(k < 1 || k > LogicGraph::LutNode::MAX_INPUTS) return -1;
+
+            Tracer::Span span("lut map");
+
+            graph.flatten();
+
+            Netlist net(graph);
+            unsigned size = net.size();
+
+            setup(graph,net);
+
+            //Depth first; then recover area within the depth found.
+            enumerate(net,false);
+            std::vector<Cut> chosen = best;
+            std::vector<bool> fixedNodes = fixed;
+            unsigned bestDepth = cover(net);
+            unsigned bestCount = count(net);
+
+            required.assign(size,bestDepth);
+
+            for(unsigned n = size; n-- > 0;){
+
+                if(!used[n] || n < net.getInputCount()) continue;
+
+                if(fixed[n]){
+
+                    for(unsigned i = 0; i < net.getFanInCount(n); ++i){
+
+                        unsigned f = net.getFanIn(n)[i];
+                        required[f] = std::min(required[f],required[n] - 1);
+                    }
+                }
+                else{
+
+                    for(unsigned i = 0; i < best[n].size; ++i){
+
+                        unsigned f = best[n].leaves[i];
+                        required[f] = std::min(required[f],required[n] - 1);
+                    }
+                }
+            }
+
+            enumerate(net,true);
+
+            if(cover(net) > bestDepth || count(net) > bestCount){
+
+                best = chosen;
+                fixed = fixedNodes;
+                cover(net);
+            }
+
+            depth = cover(net);
+
+            rebuild(graph,net);
+
+            return (int)lutCount;
+        }
+
+        /// <summary>
+        /// Returns the number of table levels on the longest path of the last mapping.
+        /// </summary>
+        unsigned getDepth() const
+        {
+            return depth;
+        }
+
+        /// <summary>
+        /// Returns the number of nodes the last mapping absorbed into tables.
+        /// </summary>
+        unsigned getRemoved() const
+        {
+            return removed;
+        }
+
+    private:
+
+        static const unsigned MAX_CUTS = 8;
+
+        struct Cut
+        {
+            unsigned leaves[LogicGraph::LutNode::MAX_INPUTS];
+            unsigned size;
+            unsigned depth;
+            float flow;
+        };
+
+        void setup(const LogicGraph& graph,const Netlist& net)
+        {
+            unsigned size = net.size();
+
+            fanOut.assign(size,0);
+            root.assign(size,false);
+
+            for(unsigned o = 0; o < net.getOutputCount(); ++o){
+
+                unsigned n = net.getOutputNode(o);
+
+                if(n == Netlist::NONE) continue;
+
+                ++fanOut[n];
+                root[n] = true;
+            }
+
+            for(unsigned n = 0; n < size; ++n){
+
+                for(unsigned i = 0; i < net.getFanInCount(n); ++i){
+
+                    unsigned f = net.getFanIn(n)[i];
+                    ++fanOut[f];
+
+                    //Nodes that feed a node left alone must survive as they are.
+                    if(net.getStatus(n) < 0) root[f] = true;
+                }
+            }
+
+            //Instances flatten leaves alone are not in the netlist. What feeds them must survive
+            //too, and rebuild reconnects them in their input order.
+            instances.clear();
+
+            for(auto& a : graph.nodes){
+
+                if(a.second == nullptr || a.second->type() != LogicGraph::INSTANCE_NODE) continue;
+
+                std::vector<Key> ks;
+                bool fed = false;
+
+                a.second->getInputs(ks);
+
+                for(auto f : ks){
+
+                    unsigned m = net.indexOf(f);
+
+                    if(m == Netlist::NONE || !mappable(net,m)) continue;
+
+                    ++fanOut[m];
+                    root[m] = true;
+                    fed = true;
+                }
+
+                if(fed) instances.push_back(std::make_pair(a.first,std::move(ks)));
+            }
+
+            for(unsigned n = 0; n < size; ++n){
+
+                if(fanOut[n] == 0) root[n] = true;
+                if(n < net.getInputCount() || net.getStatus(n) < 0) root[n] = false;
+            }
+        }
+
+        static bool mappable(const Netlist& net,unsigned n)
+        {
+            return n >= net.getInputCount() && net.getStatus(n) == 0;
+        }
+
+        /// <summary>
+        /// Finds the priority cuts of every node and picks the best of each.
+        /// </summary>
+        void enumerate(const Netlist& net,bool recover)
+        {
+            unsigned size = net.size();
+
+            cuts.assign(size,std::vector<Cut>());
+            best.assign(size,Cut());
+            fixed.assign(size,false);
+            arrival.assign(size,0);
+            flow.assign(size,0.0f);
+
+            std::vector<Cut> partial;
+            std::vector<Cut> next;
+
+            for(unsigned n = 0; n < size; ++n){
+
+                if(!mappable(net,n)){
+
+                    cuts[n].push_back(trivial(n));
+                    continue;
+                }
+
+                unsigned fanIns = net.getFanInCount(n);
+                const unsigned* f = net.getFanIn(n);
+
+                partial.assign(1,Cut());
+                partial[0].size = 0;
+
+                for(unsigned i = 0; i < fanIns && !partial.empty(); ++i){
+
+                    next.clear();
+
+                    for(auto& p : partial){
+
+                        for(auto& c : cuts[f[i]]){
+
+                            Cut u;
+
+                            if(merge(p,c,u)) insert(next,cost(u,n),recover,n);
+                        }
+                    }
+
+                    partial.swap(next);
+                }
+
+                if(partial.empty()){
+
+                    //Too wide for one table; keep the node as it is.
+                    fixed[n] = true;
+
+                    float sum = 1.0f;
+
+                    for(unsigned i = 0; i < fanIns; ++i){
+
+                        arrival[n] = std::max(arrival[n],arrival[f[i]] + 1);
+                        sum += flow[f[i]];
+                    }
+
+                    flow[n] = sum / std::max(1u,fanOut[n]);
+                    cuts[n].push_back(trivial(n));
+                    continue;
+                }
+
+                if(recover){
+
+                    //Prefer cuts within the depth the first pass reached.
+                    std::stable_sort(partial.begin(),partial.end(),[&](const Cut& a,const Cut& b){
+                        bool aFits = a.depth <= required[n];
+                        bool bFits = b.depth <= required[n];
+                        if(aFits != bFits) return aFits;
+                        return aFits ? better(a,b,true) : better(a,b,false);
+                    });
+                }
+
+                best[n] = partial[0];
+                arrival[n] = best[n].depth;
+                flow[n] = best[n].flow;
+                cuts[n] = partial;
+                cuts[n].push_back(trivial(n));
+            }
+        }
+
+        Cut trivial(unsigned n) const
+        {
+            Cut c;
+            c.leaves[0] = n;
+            c.size = 1;
+            c.depth = 0;
+            c.flow = 0.0f;
+            return c;
+        }
+
+        /// <summary>
+        /// Unites the leaves of two cuts, if they fit in a table.
+        /// </summary>
+        bool merge(const Cut& a,const Cut& b,Cut& u) const
+        {
+            unsigned i = 0;
+            unsigned j = 0;
+
+            u.size = 0;
+
+            while(i < a.size || j < b.size){
+
+                unsigned next;
+
+                if(j >= b.size || (i < a.size && a.leaves[i] < b.leaves[j])) next = a.leaves[i++];
+                else if(i >= a.size || b.leaves[j] < a.leaves[i]) next = b.leaves[j++];
+                else{
+                    next = a.leaves[i++];
+                    ++j;
+                }
+
+                if(u.size == k) return false;
+
+                u.leaves[u.size++] = next;
+            }
+
+            return true;
+        }
+
+        Cut cost(Cut c,unsigned n) const
+        {
+            c.depth = 0;
+            c.flow = 1.0f;
+
+            for(unsigned i = 0; i < c.size; ++i){
+
+                c.depth = std::max(c.depth,arrival[c.leaves[i]] + 1);
+                c.flow += flow[c.leaves[i]];
+            }
+
+            c.flow /= std::max(1u,fanOut[n]);
+
+            return c;
+        }
+
+        static bool better(const Cut& a,const Cut& b,bool area)
+        {
+            if(area){
+                if(a.flow != b.flow) return a.flow < b.flow;
+                if(a.depth != b.depth) return a.depth < b.depth;
+            }
+            else{
+                if(a.depth != b.depth) return a.depth < b.depth;
+                if(a.flow != b.flow) return a.flow < b.flow;
+            }
+
+            return a.size < b.size;
+        }
+
+        static bool subset(const Cut& a,const Cut& b)
+        {
+            return std::includes(b.leaves,b.leaves + b.size,a.leaves,a.leaves + a.size);
+        }
+
+        /// <summary>
+        /// Adds a cut to a priority list, dropping dominated cuts and the worst past MAX_CUTS.
+        /// </summary>
+        void insert(std::vector<Cut>& list,const Cut& c,bool recover,unsigned n) const
+        {
+            for(auto& a : list){
+
+                if(subset(a,c)) return;
+            }
+
+            list.erase(std::remove_if(list.begin(),list.end(),[&](const Cut& a){ return subset(c,a); }),list.end());
+
+            bool area = recover && c.depth <= required[n];
+            auto at = std::find_if(list.begin(),list.end(),[&](const Cut& a){ return better(c,a,area); });
+
+            list.insert(at,c);
+
+            if(list.size() > MAX_CUTS) list.pop_back();
+        }
+
+        /// <summary>
+        /// Marks the nodes the chosen cuts use, from the roots down.
+        /// </summary>
+        /// <returns>
+        /// The depth of the cover.
+        /// </returns>
+        unsigned cover(const Netlist& net)
+        {
+            unsigned size = net.size();
+            unsigned deepest = 0;
+
+            used.assign(size,false);
+
+            for(unsigned n = size; n-- > 0;){
+
+                if(root[n]) used[n] = true;
+
+                if(!used[n] || !mappable(net,n)) continue;
+
+                deepest = std::max(deepest,arrival[n]);
+
+                if(fixed[n]){
+
+                    for(unsigned i = 0; i < net.getFanInCount(n); ++i) used[net.getFanIn(n)[i]] = true;
+                }
+                else{
+
+                    for(unsigned i = 0; i < best[n].size; ++i) used[best[n].leaves[i]] = true;
+                }
+            }
+
+            return deepest;
+        }
+
+        unsigned count(const Netlist& net) const
+        {
+            unsigned c = 0;
+
+            for(unsigned n = 0; n < net.size(); ++n){
+
+                if(used[n] && mappable(net,n)) ++c;
+            }
+
+            return c;
+        }
+
+        /// <summary>
+        /// Returns the table of a node over the leaves of a cut.
+        /// </summary>
+        Word table(const Netlist& net,unsigned n,const Cut& c,std::vector<Word>& values,std::vector<unsigned>& mark,unsigned stamp) const
+        {
+            static const Word projections[] = {
+                0xAAAAAAAAAAAAAAAAull,
+                0xCCCCCCCCCCCCCCCCull,
+                0xF0F0F0F0F0F0F0F0ull,
+                0xFF00FF00FF00FF00ull,
+                0xFFFF0000FFFF0000ull,
+                0xFFFFFFFF00000000ull
+            };
+
+            std::vector<unsigned> stack(1,n);
+            std::vector<unsigned> cone;
+
+            for(unsigned i = 0; i < c.size; ++i){
+
+                values[c.leaves[i]] = projections[i];
+                mark[c.leaves[i]] = stamp;
+            }
+
+            while(!stack.empty()){
+
+                unsigned m = stack.back();
+                stack.pop_back();
+
+                if(mark[m] == stamp) continue;
+
+                mark[m] = stamp;
+                cone.push_back(m);
+
+                for(unsigned i = 0; i < net.getFanInCount(m); ++i) stack.push_back(net.getFanIn(m)[i]);
+            }
+
+            std::sort(cone.begin(),cone.end());
+
+            for(auto m : cone) values[m] = net.evaluate(m,values.data());
+
+            unsigned rows = 1u << c.size;
+
+            return rows == 64 ? values[n] : values[n] & (((Word)1 << rows) - 1);
+        }
+
+        /// <summary>
+        /// Swaps the mapped nodes of the graph for the cover.
+        /// </summary>
+        void rebuild(LogicGraph& graph,const Netlist& net)
+        {
+            unsigned size = net.size();
+
+            struct Rebuilt
+            {
+                Key key;
+                LogicGraph::S_Ptr node;
+                std::vector<Key> fanIn;
+            };
+
+            std::vector<Rebuilt> built;
+            std::vector<std::pair<Key,Key>> kept;
+            std::vector<Word> values(size);
+            std::vector<unsigned> mark(size,0);
+
+            lutCount = 0;
+            removed = 0;
+
+            for(unsigned n = 0; n < size; ++n){
+
+                if(net.getStatus(n) < 0 && n >= net.getInputCount()){
+
+                    for(unsigned i = 0; i < net.getFanInCount(n); ++i){
+
+                        unsigned f = net.getFanIn(n)[i];
+                        if(mappable(net,f)) kept.push_back(std::make_pair(net.getKey(n),net.getKey(f)));
+                    }
+                }
+
+                if(!mappable(net,n)) continue;
+
+                if(!used[n]){
+
+                    ++removed;
+                    continue;
+                }
+
+                Rebuilt r;
+                r.key = net.getKey(n);
+
+                auto& old = graph.nodes[r.key];
+
+                if(fixed[n]){
+
+                    r.node = old->create(r.key);
+                    old->getInputs(r.fanIn);
+                }
+                else{
+
+                    r.node = std::make_shared<LogicGraph::LutNode>(r.key,table(net,n,best[n],values,mark,n + 1));
+                    ++lutCount;
+
+                    for(unsigned i = 0; i < best[n].size; ++i) r.fanIn.push_back(net.getKey(best[n].leaves[i]));
+                }
+
+                r.node->setDelay(old->getRiseDelay(),old->getFallDelay());
+
+                built.push_back(std::move(r));
+            }
+
+            std::vector<std::pair<unsigned,Key>> bound;
+
+            //Only the outputs on nodes about to be swapped; the rest, those on gates removed earlier
+            //included, keep the nodes they hold.
+            for(unsigned o = 0; o < graph.outputCount; ++o){
+
+                if(graph.outputs[o] == nullptr) continue;
+
+                unsigned n = net.indexOf(graph.outputs[o]->getKey());
+
+                if(n != Netlist::NONE && mappable(net,n)) bound.push_back(std::make_pair(o,graph.outputs[o]->getKey()));
+            }
+
+            for(unsigned n = 0; n < size; ++n){
+
+                if(mappable(net,n)) graph.removeGate(net.getKey(n));
+            }
+
+            for(auto& r : built){
+
+                graph.nodes[r.key] = r.node;
+            }
+
+            //In netlist order, so no node has outputs yet when its inputs are connected.
+            for(auto& r : built){
+
+                for(auto f : r.fanIn) graph.connectGates(r.key,f);
+            }
+
+            for(auto& e : kept){
+
+                graph.connectGates(e.first,e.second);
+            }
+
+            for(auto& b : bound){
+
+                graph.openOutput(b.second,b.first);
+            }
+
+            //Removing the gates dropped their place in each instance's inputs, so connect them all again.
+            for(auto& i : instances){
+
+                for(auto f : i.second) graph.disconnectGates(i.first,f);
+                for(auto f : i.second) graph.connectGates(i.first,f);
+            }
+        }
+
+        unsigned k;
+        unsigned lutCount;
+        unsigned depth;
+        unsigned removed;
+        std::vector<std::vector<Cut>> cuts;
+        std::vector<Cut> best;
+        std::vector<bool> fixed;
+        std::vector<bool> used;
+        std::vector<bool> root;
+        std::vector<unsigned> arrival;
+        std::vector<unsigned> required;
+        std::vector<unsigned> fanOut;
+        std::vector<float> flow;
+        std::vector<std::pair<Key,std::vector<Key>>> instances;
+    };
+}
+
+#endif//LOGIC_LUT_MAPPER
@@ -0,0 +1,128 @@
+/// A read only memory mapping of a whole file.
+#ifndef LOGIC_MAPPED_FILE
+#define LOGIC_MAPPED_FILE
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Maps a file into memory for reading, so it is paged in as it is scanned
+    /// instead of being copied through a buffer.
+    /// </summary>
+    class MappedFile
+    {
+    public:
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        explicit MappedFile(const char* path)
+        {
+            bytes = nullptr;
+            length = 0;
+            opened = false;
+
+        #ifdef _WIN32
+            mapping = NULL;
+            file = CreateFileA(path,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+
+            if(file == INVALID_HANDLE_VALUE) return;
+
+            LARGE_INTEGER size;
+
+            if(!GetFileSizeEx(file,&size)) return;
+
+            length = (size_t)size.QuadPart;
+            opened = true;
+
+            if(length == 0) return;
+
+            mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+
+            if(mapping != NULL) bytes = (const char*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+            if(bytes == nullptr) opened = false;
+        #else
+            file = open(path,O_RDONLY);
+
+            if(file < 0) return;
+
+            struct stat info;
+
+            if(fstat(file,&info) != 0) return;
+
+            length = (size_t)info.st_size;
+            opened = true;
+
+            if(length == 0) return;
+
+            void* view = mmap(nullptr,length,PROT_READ,MAP_PRIVATE,file,0);
+
+            if(view == MAP_FAILED){
+                opened = false;
+                return;
+            }
+
+            bytes = (const char*)view;
+            madvise(view,length,MADV_SEQUENTIAL);
+        #endif
+        }
+
+        ~MappedFile()
+        {
+        #ifdef _WIN32
+            if(bytes != nullptr) UnmapViewOfFile(bytes);
+            if(mapping != NULL) CloseHandle(mapping);
+            if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        #else
+            if(bytes != nullptr) munmap((void*)bytes,length);
+            if(file >= 0) close(file);
+        #endif
+        }
+
+        /// <summary>
+        /// Whether the file could be opened and mapped. An empty file is open with no data.
+        /// </summary>
+        bool isOpen() const
+        {
+            return opened;
+        }
+
+        const char* data() const
+        {
+            return bytes;
+        }
+
+        size_t size() const
+        {
+            return length;
+        }
+
+    private:
+
+        const char* bytes;
+        size_t length;
+        bool opened;
+
+    #ifdef _WIN32
+        HANDLE file;
+        HANDLE mapping;
+    #else
+        int file;
+    #endif
+    };
+}
+
+#endif//LOGIC_MAPPED_FILE
@@ -0,0 +1,116 @@
+/// A circuit defined once and instantiated by reference.
+#ifndef LOGIC_MODULE
+#define LOGIC_MODULE
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// A module defined by a graph: the graph's inputs and outputs are the module's.
+    /// The module keeps its own copy of the graph, so the graph may be changed or
+    /// destroyed afterwards. Add it to graphs with LogicGraph.addInstance; every
+    /// instance shares this one copy, so an instance costs one node and a port node
+    /// per output however large the module is. Instances in the defining graph are
+    /// allowed, which nests modules; each module's netlist has its own instances
+    /// inlined once, when the module is made.
+    /// </summary>
+    class Module : public LogicGraph::ModuleBody
+    {
+    public:
+
+        typedef LogicGraph::SByte SByte;
+        typedef Netlist::Word Word;
+
+        Module() = delete;
+
+        explicit Module(const LogicGraph& definition)
+            : graph(definition.clone()),body(definition)
+        {
+        }
+
+        unsigned getInputCount() const
+        {
+            return body.getInputCount();
+        }
+
+        unsigned getOutputCount() const
+        {
+            return body.getOutputCount();
+        }
+
+        const LogicGraph& getGraph() const
+        {
+            return graph;
+        }
+
+        const Netlist& getBody() const
+        {
+            return body;
+        }
+
+        void evaluate(const SByte* inputs,SByte* outputs) const
+        {
+            //Instances share the module, across threads too, so each thread keeps its own
+            //scratch and evaluating allocates nothing once it has grown to the largest module.
+            thread_local std::vector<Word> words;
+            thread_local std::vector<Word> values;
+
+            words.resize(body.getInputCount());
+            values.resize(body.size());
+
+            bool errors = false;
+
+            for(unsigned i = 0; i < words.size(); ++i){
+
+                words[i] = inputs[i] > 0 ? 1 : 0;
+                if(inputs[i] < 0) errors = true;
+            }
+
+            body.simulate(words.data(),values.data());
+
+            for(unsigned o = 0; o < body.getOutputCount(); ++o){
+
+                outputs[o] = body.getOutputNode(o) == Netlist::NONE ? -1 : body.getOutput(o,values.data(),0);
+            }
+
+            if(errors) markErrors(inputs,outputs);
+        }
+
+    protected:
+
+        /// <summary>
+        /// Gives the outputs whose gates read an input in error that error, found the way
+        /// the netlist finds its own: each node takes the first error among its inputs.
+        /// </summary>
+        void markErrors(const SByte* inputs,SByte* outputs) const
+        {
+            thread_local std::vector<SByte> status;
+
+            status.resize(body.size());
+
+            for(unsigned n = 0; n < body.size(); ++n){
+
+                SByte s = n < body.getInputCount() ? (inputs[n] < 0 ? inputs[n] : 0) : body.getStatus(n);
+
+                for(unsigned i = 0; s == 0 && i < body.getFanInCount(n); ++i) s = status[body.getFanIn(n)[i]];
+
+                status[n] = s;
+            }
+
+            for(unsigned o = 0; o < body.getOutputCount(); ++o){
+
+                unsigned n = body.getOutputNode(o);
+
+                if(n != Netlist::NONE && status[n] < 0) outputs[o] = status[n];
+            }
+        }
+
+    private:
+
+        LogicGraph graph;
+        Netlist body;
+    };
+}
+
+#endif//LOGIC_MODULE
@@ -0,0 +1,765 @@
+/// A levelized, read-only form of a logic graph for the bit-parallel engines.
+#ifndef LOGIC_NETLIST
+#define LOGIC_NETLIST
+
+#include "LogicGraph.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// A snapshot of a logic graph with the nodes in topological order.
+    /// Inputs come first, so input i is node i; every gate comes after its inputs.
+    /// Values are 64-bit words, one pattern per bit, so one pass evaluates 64 patterns.
+    /// Module instances are flattened: each is replaced by a copy of its module's gates,
+    /// which have key 0, and each port by a buffer of the gate it reads.
+    /// </summary>
+    class Netlist
+    {
+    public:
+
+        typedef LogicGraph::Key Key;
+        typedef LogicGraph::SByte SByte;
+        typedef uint64_t Word;
+
+        /// <summary>
+        /// The kernel used to evaluate a node.
+        /// </summary>
+        enum Op : unsigned char
+        {
+            INPUT,
+            BUF,
+            NOT,
+            AND,
+            NAND,
+            OR,
+            NOR,
+            ONEHOT,
+            CONST0,
+            CONST1,
+            SYMMETRIC,
+            LUT,
+            XOR,
+            XNOR,
+            THRESHOLD,
+            MUX
+        };
+
+        static const unsigned NONE = ~0u;
+
+        static const Word ONES = ~(Word)0;
+
+        Netlist() = delete;
+
+        explicit Netlist(const LogicGraph& graph)
+        {
+            Tracer::Span span("compile netlist");
+
+            inputCount = graph.inputCount;
+
+            std::unordered_map<Key,unsigned> index;
+            std::unordered_map<Key,std::vector<unsigned>> ports;
+            std::vector<Key> ks;
+            std::vector<unsigned> from;
+
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                Key k = graph.inputs[i]->getKey();
+                index[k] = i;
+                append(k,INPUT,ks);
+                rises.push_back(0);
+                falls.push_back(0);
+            }
+
+            //Depth first, post order, so every node follows its inputs.
+            std::vector<std::pair<Key,bool>> stack;
+
+            for(auto& a : graph.nodes){
+
+                if(a.second == nullptr || index.count(a.first) > 0) continue;
+
+                stack.push_back(std::make_pair(a.first,false));
+
+                while(!stack.empty()){
+
+                    auto top = stack.back();
+                    stack.pop_back();
+
+                    if(index.count(top.first) > 0) continue;
+
+                    auto& node = graph.nodes.at(top.first);
+
+                    ks.clear();
+                    node->getInputs(ks);
+
+                    if(!top.second){
+
+                        stack.push_back(std::make_pair(top.first,true));
+
+                        for(auto b = ks.rbegin(); b != ks.rend(); ++b){
+
+                            if(index.count(*b) == 0) stack.push_back(std::make_pair(*b,false));
+                        }
+
+                        continue;
+                    }
+
+                    if(node->type() == LogicGraph::INSTANCE_NODE){
+
+                        from.clear();
+
+                        for(auto& b : ks) from.push_back(index[b]);
+
+                        index[top.first] = NONE;
+                        inlineModule(((LogicGraph::InstanceNode*)node.get())->getModule()->getBody(),from,ports[top.first]);
+                        continue;
+                    }
+
+                    index[top.first] = (unsigned)keys.size();
+                    rises.push_back(node->getRiseDelay());
+                    falls.push_back(node->getFallDelay());
+
+                    if(node->type() == LogicGraph::PORT_NODE && !ks.empty()){
+
+                        auto instance = ports.find(ks[0]);
+
+                        fanIn.push_back(instance == ports.end() ? index[ks[0]] : instance->second[((LogicGraph::PortNode*)node.get())->getIndex()]);
+                        append(top.first,BUF,ks);
+                        continue;
+                    }
+
+                    for(auto& b : ks){
+
+                        fanIn.push_back(index[b]);
+                    }
+
+                    if(ks.empty()){
+
+                        append(top.first,CONST0,ks);
+                    }
+                    else if(node->type() == LogicGraph::INVERTER_NODE){
+
+                        append(top.first,NOT,ks);
+                    }
+                    else if(node->type() == LogicGraph::LUT_NODE){
+
+                        pendingLut = ((LogicGraph::LutNode*)node.get())->getTable();
+                        append(top.first,isMux(pendingLut,(unsigned)ks.size()) ? MUX : LUT,ks);
+                    }
+                    else{
+
+                        auto gate = (LogicGraph::GateNode*)node.get();
+                        append(top.first,classify(gate->getGate(),(unsigned)ks.size()),ks);
+                    }
+                }
+            }
+
+            outputs.resize(graph.outputCount,(unsigned)NONE);
+
+            unsigned removed = NONE;
+            std::vector<Key> none;
+
+            for(unsigned i = 0; i < graph.outputCount; ++i){
+
+                if(graph.outputs[i] == nullptr) continue;
+
+                auto a = index.find(graph.outputs[i]->getKey());
+
+                if(a != index.end()){
+
+                    outputs[i] = a->second;
+                    continue;
+                }
+
+                //Bound to a gate since removed, which the graph reports as having no inputs.
+                if(removed == NONE){
+
+                    removed = (unsigned)ops.size();
+                    rises.push_back(0);
+                    falls.push_back(0);
+                    append(0,CONST0,none);
+                }
+
+                outputs[i] = removed;
+            }
+
+            keyIndex = std::move(index);
+        }
+
+        unsigned size() const
+        {
+            return (unsigned)ops.size();
+        }
+
+        unsigned getInputCount() const
+        {
+            return inputCount;
+        }
+
+        unsigned getOutputCount() const
+        {
+            return (unsigned)outputs.size();
+        }
+
+        /// <summary>
+        /// Returns the node bound to the indexed output, or NONE if it is closed.
+        /// </summary>
+        unsigned getOutputNode(unsigned index) const
+        {
+            return outputs[index];
+        }
+
+        /// <summary>
+        /// Returns the node index of a graph key, or NONE if the key was not in the graph.
+        /// </summary>
+        unsigned indexOf(Key k) const
+        {
+            auto a = keyIndex.find(k);
+
+            return a == keyIndex.end() ? NONE : a->second;
+        }
+
+        Key getKey(unsigned n) const
+        {
+            return keys[n];
+        }
+
+        Op getOp(unsigned n) const
+        {
+            return ops[n];
+        }
+
+        /// <summary>
+        /// Returns the longest path from an input to the node.
+        /// </summary>
+        unsigned getLevel(unsigned n) const
+        {
+            return levels[n];
+        }
+
+        /// <summary>
+        /// Returns the error the graph would report for the node.
+        /// </summary>
+        /// <returns>
+        ///  0: The node has a value.
+        /// -1: No inputs, here or in a higher node (as Node.output)
+        /// </returns>
+        SByte getStatus(unsigned n) const
+        {
+            return status[n];
+        }
+
+        /// <summary>
+        /// Returns the time the node takes to switch to true; 0 for inputs.
+        /// </summary>
+        unsigned getRiseDelay(unsigned n) const
+        {
+            return rises[n];
+        }
+
+        /// <summary>
+        /// Returns the time the node takes to switch to false; 0 for inputs.
+        /// </summary>
+        unsigned getFallDelay(unsigned n) const
+        {
+            return falls[n];
+        }
+
+        unsigned getFanInCount(unsigned n) const
+        {
+            return fanStart[n + 1] - fanStart[n];
+        }
+
+        const unsigned* getFanIn(unsigned n) const
+        {
+            return fanIn.data() + fanStart[n];
+        }
+
+        /// <summary>
+        /// Returns whether a symmetric node is true when the given number of its inputs are.
+        /// </summary>
+        bool getTableEntry(unsigned n,unsigned trues) const
+        {
+            switch(ops[n]){
+            case BUF:
+            case OR:        return trues > 0;
+            case NOT:
+            case NOR:       return trues == 0;
+            case AND:       return trues == getFanInCount(n);
+            case NAND:      return trues != getFanInCount(n);
+            case ONEHOT:    return trues == 1;
+            case CONST1:    return true;
+            case SYMMETRIC: return tables[aux[n] + trues] != 0;
+            case XOR:       return (trues & 1) != 0;
+            case XNOR:      return (trues & 1) == 0;
+            case THRESHOLD: return trues >= aux[n];
+            default:        return false;
+            }
+        }
+
+        /// <summary>
+        /// Returns the table of a lookup table or multiplexer node; input i is bit i of the index.
+        /// </summary>
+        Word getLutTable(unsigned n) const
+        {
+            return luts[aux[n]];
+        }
+
+        /// <summary>
+        /// Evaluates every node. values must hold size() words; the first
+        /// getInputCount() words are taken from inputWords.
+        /// </summary>
+        void simulate(const Word* inputWords,Word* values) const
+        {
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                values[i] = inputWords[i];
+            }
+
+            for(unsigned n = inputCount; n < ops.size(); ++n){
+
+                values[n] = evaluate(n,values);
+            }
+        }
+
+        /// <summary>
+        /// Evaluates one node from the words of its inputs.
+        /// </summary>
+        Word evaluate(unsigned n,const Word* values) const
+        {
+            const unsigned* f = getFanIn(n);
+
+            return evaluateWith(n,[&](unsigned i){ return values[f[i]]; });
+        }
+
+        /// <summary>
+        /// Evaluates one node, fetching the word of its i'th input from fetch(i).
+        /// </summary>
+        template<typename Fetch>
+        Word evaluateWith(unsigned n,Fetch fetch) const
+        {
+            Op op = ops[n];
+
+            return evaluateOp(op,getFanInCount(n),fetch,aux[n],op == SYMMETRIC ? tables.data() + aux[n] : nullptr,
+                op == LUT ? luts[aux[n]] : 0);
+        }
+
+        /// <summary>
+        /// Evaluates a kernel on count inputs, fetching the word of the i'th from fetch(i).
+        /// k is the bound of a THRESHOLD, table the count + 1 entries of a SYMMETRIC and
+        /// lut the table of a LUT; the other kernels ignore them.
+        /// </summary>
+        template<typename Fetch>
+        static Word evaluateOp(Op op,unsigned count,Fetch fetch,unsigned k,const unsigned char* table,Word lut)
+        {
+            Word w;
+
+            switch(op){
+            case BUF:
+                return fetch(0);
+
+            case NOT:
+                return ~fetch(0);
+
+            case AND:
+            case NAND:
+                w = ONES;
+                for(unsigned i = 0; i < count; ++i) w &= fetch(i);
+                return op == AND ? w : ~w;
+
+            case OR:
+            case NOR:
+                w = 0;
+                for(unsigned i = 0; i < count; ++i) w |= fetch(i);
+                return op == OR ? w : ~w;
+
+            case ONEHOT:
+            {
+                Word one = 0;
+                Word many = 0;
+                for(unsigned i = 0; i < count; ++i){
+                    Word x = fetch(i);
+                    many |= one & x;
+                    one |= x;
+                }
+                return one & ~many;
+            }
+
+            case CONST0:
+                return 0;
+
+            case CONST1:
+                return ONES;
+
+            case XOR:
+            case XNOR:
+                w = 0;
+                for(unsigned i = 0; i < count; ++i) w ^= fetch(i);
+                return op == XOR ? w : ~w;
+
+            case MUX:
+            {
+                //Halve the data inputs once per select, lowest select first.
+                Word halves[4];
+                unsigned size = count == 3 ? 2 : 4;
+
+                for(unsigned m = 0; m < size; ++m) halves[m] = fetch(m);
+
+                for(unsigned i = size; i < count; ++i){
+                    Word s = fetch(i);
+                    size >>= 1;
+                    for(unsigned m = 0; m < size; ++m){
+                        halves[m] = (halves[2 * m] & ~s) | (halves[2 * m + 1] & s);
+                    }
+                }
+                return halves[0];
+            }
+
+            case THRESHOLD:
+            {
+                //Compare the counts against k a bit plane at a time, top bit first.
+                Word planes[32];
+                unsigned width = countPlanes(count,fetch,planes);
+                Word above = 0,equal = ONES;
+
+                for(unsigned b = width; b-- > 0;){
+                    if((k >> b) & 1) equal &= planes[b];
+                    else{
+                        above |= equal & planes[b];
+                        equal &= ~planes[b];
+                    }
+                }
+                return above | equal;
+            }
+
+            case SYMMETRIC:
+            {
+                //Count the true inputs of every pattern in bit planes, then match the counts against the table.
+                Word planes[32];
+                unsigned width = countPlanes(count,fetch,planes);
+
+                w = 0;
+                for(unsigned t = 0; t <= count; ++t){
+                    if(!table[t]) continue;
+                    Word match = ONES;
+                    for(unsigned b = 0; b < width; ++b){
+                        match &= (t >> b) & 1 ? planes[b] : ~planes[b];
+                    }
+                    w |= match;
+                }
+                return w;
+            }
+
+            case LUT:
+            {
+                //Fold the table one input at a time, last input first.
+                Word halves[64];
+                unsigned size = 1u << count;
+
+                for(unsigned m = 0; m < size; ++m){
+                    halves[m] = (lut >> m) & 1 ? ONES : 0;
+                }
+
+                for(unsigned i = count; i-- > 0;){
+                    Word x = fetch(i);
+                    size >>= 1;
+                    for(unsigned m = 0; m < size; ++m){
+                        halves[m] = (x & halves[m + size]) | (~x & halves[m]);
+                    }
+                }
+                return halves[0];
+            }
+
+            default:
+                return 0;
+            }
+        }
+
+        /// <summary>
+        /// Returns the indexed output for one pattern of a simulated value array.
+        /// </summary>
+        /// <returns>
+        ///  0: False
+        ///  1: True
+        /// -1: No inputs (from Node.output)
+        /// -3: An output does not exist.
+        /// </returns>
+        SByte getOutput(unsigned index,const Word* values,unsigned pattern) const
+        {
+            unsigned n = outputs[index];
+
+            if(n == NONE) return -3;
+
+            if(status[n] < 0) return status[n];
+
+            return (values[n] >> pattern) & 1 ? 1 : 0;
+        }
+
+        /// <summary>
+        /// Packs pattern strings of '0'/'1' (as LogicGraph.feedInputString) into input words.
+        /// Pattern p is read from vectors + p * getInputCount() and lands in bit p.
+        /// </summary>
+        void packInputs(const char* vectors,unsigned patternCount,Word* inputWords) const
+        {
+            for(unsigned i = 0; i < inputCount; ++i){
+
+                inputWords[i] = 0;
+            }
+
+            for(unsigned p = 0; p < patternCount && p < 64; ++p){
+
+                const char* v = vectors + (size_t)p * inputCount;
+
+                for(unsigned i = 0; i < inputCount; ++i){
+
+                    if(v[i] == '1') inputWords[i] |= (Word)1 << p;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Adds up the true inputs of every pattern: bit p of planes[b] is bit b of pattern p's count.
+        /// </summary>
+        /// <returns>
+        /// The number of planes, enough to hold count.
+        /// </returns>
+        template<typename Fetch>
+        static unsigned countPlanes(unsigned count,Fetch fetch,Word* planes)
+        {
+            unsigned width = 1;
+            while((1u << width) <= count) ++width;
+
+            std::fill(planes,planes + width,0);
+
+            for(unsigned i = 0; i < count; ++i){
+                Word carry = fetch(i);
+                for(unsigned b = 0; carry != 0 && b < width; ++b){
+                    Word t = planes[b] & carry;
+                    planes[b] ^= carry;
+                    carry = t;
+                }
+            }
+
+            return width;
+        }
+
+        static int popcount(Word w)
+        {
+        #if defined(__GNUC__)
+            return __builtin_popcountll(w);
+        #else
+            w = w - ((w >> 1) & 0x5555555555555555ull);
+            w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+            w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return (int)((w * 0x0101010101010101ull) >> 56);
+        #endif
+        }
+
+    private:
+
+        void append(Key k,Op op,const std::vector<Key>& ks)
+        {
+            unsigned n = (unsigned)ops.size();
+
+            if(fanStart.empty()) fanStart.push_back(0);
+
+            keys.push_back(k);
+            ops.push_back(op);
+            aux.push_back(0);
+            fanStart.push_back((unsigned)fanIn.size());
+
+            unsigned level = 0;
+            SByte s = 0;
+
+            if(op != INPUT){
+
+                if(getFanInCount(n) == 0) s = -1;
+
+                for(unsigned i = 0; i < getFanInCount(n); ++i){
+
+                    unsigned f = getFanIn(n)[i];
+                    level = std::max(level,levels[f] + 1);
+                    if(s == 0 && status[f] < 0) s = status[f];
+                }
+            }
+
+            levels.push_back(level);
+            status.push_back(s);
+
+            if(op == SYMMETRIC){
+
+                aux[n] = (unsigned)tables.size();
+                tables.insert(tables.end(),pending.begin(),pending.end());
+            }
+            else if(op == LUT || op == MUX){
+
+                aux[n] = (unsigned)luts.size();
+                luts.push_back(pendingLut);
+            }
+            else if(op == THRESHOLD){
+
+                aux[n] = (unsigned)(std::find(pending.begin(),pending.end(),1) - pending.begin());
+            }
+        }
+
+        /// <summary>
+        /// Appends a copy of a module's gates reading the nodes in from, and lists the nodes
+        /// holding its outputs in outs. As with an instance in the graph, a missing input leaves
+        /// every output -1, an input in error reaches the outputs whose gates read it, and a
+        /// closed output is -1.
+        /// </summary>
+        void inlineModule(const Netlist& body,const std::vector<unsigned>& from,std::vector<unsigned>& outs)
+        {
+            std::vector<Key> none;
+            unsigned unconnected = NONE;
+
+            auto missing = [&](){
+                if(unconnected == NONE){
+
+                    unconnected = (unsigned)ops.size();
+                    rises.push_back(0);
+                    falls.push_back(0);
+                    append(0,CONST0,none);
+                }
+                return unconnected;
+            };
+
+            if(from.size() < body.inputCount){
+
+                outs.assign(body.outputs.size(),missing());
+                return;
+            }
+
+            std::vector<unsigned> map(body.size());
+
+            for(unsigned i = 0; i < body.inputCount; ++i) map[i] = from[i];
+
+            for(unsigned n = body.inputCount; n < body.size(); ++n){
+
+                unsigned count = body.getFanInCount(n);
+                const unsigned* f = body.getFanIn(n);
+
+                for(unsigned i = 0; i < count; ++i) fanIn.push_back(map[f[i]]);
+
+                rises.push_back(body.rises[n]);
+                falls.push_back(body.falls[n]);
+
+                if(body.ops[n] == SYMMETRIC){
+
+                    pending.assign(body.tables.begin() + body.aux[n],body.tables.begin() + body.aux[n] + count + 1);
+                }
+                else if(body.ops[n] == LUT || body.ops[n] == MUX){
+
+                    pendingLut = body.luts[body.aux[n]];
+                }
+                else if(body.ops[n] == THRESHOLD){
+
+                    pending.resize(count + 1);
+
+                    for(unsigned t = 0; t <= count; ++t) pending[t] = body.getTableEntry(n,t) ? 1 : 0;
+                }
+
+                map[n] = (unsigned)ops.size();
+                append(0,body.ops[n],none);
+            }
+
+            outs.resize(body.outputs.size());
+
+            for(unsigned o = 0; o < body.outputs.size(); ++o){
+
+                outs[o] = body.outputs[o] == NONE ? missing() : map[body.outputs[o]];
+            }
+        }
+
+        /// <summary>
+        /// Picks the kernel for a gate by tabulating it over every count of true inputs.
+        /// </summary>
+        Op classify(const LogicGraph::Gate& gate,unsigned count)
+        {
+            pending.resize(count + 1);
+
+            for(unsigned t = 0; t <= count; ++t){
+
+                pending[t] = gate(t,count - t) ? 1 : 0;
+            }
+
+            auto only = [&](unsigned at,unsigned char v){
+                for(unsigned t = 0; t <= count; ++t){
+                    if(pending[t] != (t == at ? v : 1 - v)) return false;
+                }
+                return true;
+            };
+
+            if(count == 0) return CONST0;
+
+            if(count == 1 && pending[0] == 0 && pending[1] == 1) return BUF;
+            if(count == 1 && pending[0] == 1 && pending[1] == 0) return NOT;
+            if(only(count,1)) return AND;
+            if(only(count,0)) return NAND;
+            if(only(0,0)) return OR;
+            if(only(0,1)) return NOR;
+
+            bool odd = true,even = true,rising = true;
+
+            for(unsigned t = 0; t <= count; ++t){
+
+                odd = odd && pending[t] == (t & 1);
+                even = even && pending[t] != (t & 1);
+                rising = rising && (t == 0 || pending[t] >= pending[t - 1]);
+            }
+
+            if(odd) return XOR;
+            if(even) return XNOR;
+            if(only(1,1)) return ONEHOT;
+
+            if(std::count(pending.begin(),pending.end(),0) == (int)pending.size()) return CONST0;
+            if(std::count(pending.begin(),pending.end(),1) == (int)pending.size()) return CONST1;
+
+            //False up to some count of true inputs and true from there on.
+            if(rising) return THRESHOLD;
+
+            return SYMMETRIC;
+        }
+
+        /// <summary>
+        /// Whether a lookup table is the one LogicGraph.addMux gives its node.
+        /// </summary>
+        static bool isMux(Word table,unsigned count)
+        {
+            if(count != 3 && count != 6) return false;
+
+            unsigned data = count == 3 ? 2 : 4;
+
+            for(unsigned m = 0; m < (1u << count); ++m){
+
+                if(((table >> m) & 1) != ((m >> (m >> data)) & 1)) return false;
+            }
+
+            return true;
+        }
+
+        unsigned inputCount;
+        std::vector<Op> ops;
+        std::vector<unsigned> fanStart;
+        std::vector<unsigned> fanIn;
+        std::vector<unsigned> aux;
+        std::vector<unsigned> levels;
+        std::vector<SByte> status;
+        std::vector<unsigned> rises;
+        std::vector<unsigned> falls;
+        std::vector<Key> keys;
+        std::vector<unsigned> outputs;
+        std::vector<unsigned char> tables;
+        std::vector<unsigned char> pending;
+        std::vector<Word> luts;
+        Word pendingLut;
+        std::unordered_map<Key,unsigned> keyIndex;
+    };
+
+    const unsigned Netlist::NONE;
+
+    const Netlist::Word Netlist::ONES;
+}
+
+#endif//LOGIC_NETLIST
@@ -0,0 +1,93 @@
+/// Satisfiability queries on the outputs of a logic graph.
+#ifndef LOGIC_OUTPUT_SOLVER
+#define LOGIC_OUTPUT_SOLVER
+
+#include "Cnf.h"
+#include <string>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Finds input vectors that drive an output of a logic graph to a value.
+    /// Holds one solver for a snapshot of the graph: each query encodes only the
+    /// part of the output's cone not yet encoded, and what the solver learns in
+    /// one query carries over to the next.
+    /// </summary>
+    class OutputSolver
+    {
+    public:
+
+        typedef LogicGraph::SByte SByte;
+
+        OutputSolver() = delete;
+
+        explicit OutputSolver(const LogicGraph& graph) : netlist(graph),cnf(netlist,solver)
+        {
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        /// <summary>
+        /// Looks for inputs that give the indexed output the value.
+        /// </summary>
+        /// <params>
+        /// assumptions: Null, or one character per input: '0' or '1' holds the input at that value
+        /// for this query, anything else leaves it free.
+        /// inputs: On success, receives the input vector as '0'/'1' (as LogicGraph.feedInputString).
+        /// conflictBudget: Conflicts the solver may spend; negative for no limit.
+        /// </params>
+        /// <returns>
+        ///  1: Found, see inputs.
+        ///  0: No input vector gives the output that value.
+        /// -1: No inputs (from Node.output)
+        /// -3: An output does not exist.
+        /// -4: Undecided within the conflict budget.
+        /// </returns>
+        SByte solve(unsigned index,bool value,const char* assumptions,std::string* inputs = nullptr,long long conflictBudget = -1)
+        {
+            if(index >= netlist.getOutputCount()) return -3;
+
+            unsigned n = netlist.getOutputNode(index);
+
+            if(n == Netlist::NONE) return -3;
+            if(netlist.getStatus(n) < 0) return netlist.getStatus(n);
+
+            std::vector<Cnf::Lit> assumed(1,cnf.literal(n) ^ (value ? 0 : 1));
+
+            for(unsigned i = 0; assumptions != nullptr && i < netlist.getInputCount(); ++i){
+
+                if(assumptions[i] == '0' || assumptions[i] == '1'){
+
+                    assumed.push_back(cnf.literal(i) ^ (assumptions[i] == '1' ? 0 : 1));
+                }
+            }
+
+            SByte r = solver.solve(assumed,conflictBudget);
+
+            if(r < 0) return -4;
+
+            if(r == 1 && inputs != nullptr){
+
+                inputs->resize(netlist.getInputCount());
+
+                for(unsigned i = 0; i < netlist.getInputCount(); ++i){
+
+                    (*inputs)[i] = cnf.isEncoded(i) && solver.modelLit(cnf.literal(i)) ? '1' : '0';
+                }
+            }
+
+            return r;
+        }
+
+    private:
+
+        Netlist netlist;
+        Solver solver;
+        Cnf cnf;
+    };
+}
+
+#endif//LOGIC_OUTPUT_SOLVER
@@ -0,0 +1,188 @@
+/// Cuts a netlist into shards with few edges between them.
+#ifndef LOGIC_PARTITIONER
+#define LOGIC_PARTITIONER
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Splits the gates of a netlist into a number of shards of about equal size,
+    /// keeping the edges between gates of different shards few. Every edge runs from
+    /// a shard to the same or a later one, so the shards can be evaluated in order, or
+    /// pipelined, without coming back to an earlier shard. Inputs belong to no shard.
+    /// The netlist's depth first order is cut into equal runs, then gates are moved to
+    /// a neighbouring shard while that cuts fewer edges, keeps the order and keeps every
+    /// shard within the size tolerance.
+    /// </summary>
+    class Partitioner
+    {
+    public:
+
+        Partitioner() = delete;
+
+        /// <params>
+        /// shardCount: At least 1; no more shards are made than there are gates.
+        /// tolerance: How far, as a fraction of the mean, a shard may grow or shrink while refining.
+        /// </params>
+        Partitioner(const Netlist& netlist,unsigned shardCount,double tolerance = 0.05)
+        {
+            unsigned size = netlist.size();
+            unsigned inCount = netlist.getInputCount();
+            unsigned gates = size - inCount;
+
+            shardCount = std::max(1u,std::min(shardCount,gates));
+            shards.assign(size,(unsigned)Netlist::NONE);
+            sizes.assign(gates == 0 ? 0 : shardCount,0);
+
+            for(unsigned n = inCount; n < size; ++n){
+
+                unsigned s = (unsigned)((unsigned long long)(n - inCount) * shardCount / gates);
+
+                shards[n] = s;
+                ++sizes[s];
+            }
+
+            if(sizes.size() > 1) refine(netlist,tolerance);
+
+            cutCount = 0;
+
+            for(unsigned n = inCount; n < size; ++n){
+
+                const unsigned* f = netlist.getFanIn(n);
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i){
+
+                    if(f[i] >= inCount && shards[f[i]] != shards[n]) ++cutCount;
+                }
+            }
+        }
+
+        /// <summary>
+        /// The number of shards; 0 when the netlist has no gates.
+        /// </summary>
+        unsigned getShardCount() const
+        {
+            return (unsigned)sizes.size();
+        }
+
+        /// <summary>
+        /// Returns the shard of a netlist node, or NONE for an input.
+        /// </summary>
+        unsigned getShard(unsigned n) const
+        {
+            return shards[n];
+        }
+
+        unsigned getShardSize(unsigned s) const
+        {
+            return sizes[s];
+        }
+
+        /// <summary>
+        /// The number of edges from a gate to a gate in another shard.
+        /// </summary>
+        unsigned getCutCount() const
+        {
+            return cutCount;
+        }
+
+    private:
+
+        /// <summary>
+        /// Passes over the gates before giving up on finding a better cut.
+        /// </summary>
+        static const unsigned PASSES = 16;
+
+        void refine(const Netlist& netlist,double tolerance)
+        {
+            unsigned size = netlist.size();
+            unsigned inCount = netlist.getInputCount();
+            unsigned shardCount = (unsigned)sizes.size();
+            double mean = (double)(size - inCount) / shardCount;
+            unsigned slack = (unsigned)(mean * tolerance);
+            unsigned low = (unsigned)mean > slack ? (unsigned)mean - slack : 1;
+            unsigned high = (unsigned)mean + slack + 1;
+
+            //Gates fed by each gate, to weigh moves by both ends of their edges.
+            std::vector<unsigned> outStart(size + 1,0);
+
+            for(unsigned n = inCount; n < size; ++n){
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) ++outStart[netlist.getFanIn(n)[i] + 1];
+            }
+
+            for(unsigned n = 0; n < size; ++n) outStart[n + 1] += outStart[n];
+
+            std::vector<unsigned> fanOut(outStart[size]);
+            std::vector<unsigned> fill(outStart.begin(),outStart.end() - 1);
+
+            for(unsigned n = inCount; n < size; ++n){
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) fanOut[fill[netlist.getFanIn(n)[i]]++] = n;
+            }
+
+            for(unsigned pass = 0; pass < PASSES; ++pass){
+
+                bool moved = false;
+
+                for(unsigned n = inCount; n < size; ++n){
+
+                    unsigned s = shards[n];
+
+                    //Edges to the shard before, this shard and the shard after, and
+                    //whether a fan-in or fan-out in this shard pins the gate here.
+                    int before = 0,here = 0,after = 0;
+                    bool faninHere = false,fanoutHere = false;
+
+                    const unsigned* f = netlist.getFanIn(n);
+
+                    for(unsigned i = 0; i < netlist.getFanInCount(n); ++i){
+
+                        if(f[i] < inCount) continue;
+
+                        unsigned t = shards[f[i]];
+
+                        if(t == s){ ++here; faninHere = true; }
+                        else if(t + 1 == s) ++before;
+                    }
+
+                    for(unsigned i = outStart[n]; i < outStart[n + 1]; ++i){
+
+                        unsigned t = shards[fanOut[i]];
+
+                        if(t == s){ ++here; fanoutHere = true; }
+                        else if(t == s + 1) ++after;
+                    }
+
+                    if(sizes[s] <= low) continue;
+
+                    if(!fanoutHere && s + 1 < shardCount && after > here && after >= before && sizes[s + 1] < high){
+
+                        shards[n] = s + 1;
+                        --sizes[s];
+                        ++sizes[s + 1];
+                        moved = true;
+                    }
+                    else if(!faninHere && s > 0 && before > here && sizes[s - 1] < high){
+
+                        shards[n] = s - 1;
+                        --sizes[s];
+                        ++sizes[s - 1];
+                        moved = true;
+                    }
+                }
+
+                if(!moved) break;
+            }
+        }
+
+        std::vector<unsigned> shards;
+        std::vector<unsigned> sizes;
+        unsigned cutCount;
+    };
+
+    const unsigned Partitioner::PASSES;
+}
+
+#endif//LOGIC_PARTITIONER
@@ -0,0 +1,223 @@
+/// Random pattern self-test: LFSR patterns in, MISR signature out.
+#ifndef LOGIC_SELF_TESTER
+#define LOGIC_SELF_TESTER
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Runs pseudo-random patterns through a netlist and compacts the outputs into a
+    /// signature, as built-in self-test hardware does, 64 patterns per pass.
+    /// The patterns come from one LFSR bit stream s: input i of pattern t is s[t + i],
+    /// as if the stream were shifted through a scan chain. The LFSR of width W follows
+    /// s[t + W] = parity(taps & (s[t] ... s[t + W - 1])), bit j of taps standing for the
+    /// x^j term of the polynomial x^W + ... + 1.
+    /// The MISR of its own width and taps shifts once per pattern and takes output o on bit
+    /// o mod width. Outputs that are closed or report an error add nothing.
+    /// Runs continue where the last one stopped, so a long run may be split into many.
+    /// </summary>
+    class SelfTester
+    {
+    public:
+
+        typedef Netlist::Word Word;
+
+        /// <summary>
+        /// Taps of x^32 + x^22 + x^2 + x + 1, a maximal length polynomial of width 32.
+        /// </summary>
+        static const Word DEFAULT_TAPS = 0x00400007;
+
+        SelfTester() = delete;
+
+        /// <params>
+        /// lfsrWidth, misrWidth: 1 to 64.
+        /// seed: The first lfsrWidth bits of the stream; must not be 0.
+        /// </params>
+        SelfTester(const LogicGraph& graph,unsigned lfsrWidth = 32,Word lfsrTaps = DEFAULT_TAPS,Word seed = 1,
+                   unsigned misrWidth = 32,Word misrTaps = DEFAULT_TAPS)
+            : netlist(graph)
+        {
+            lfsr.width = std::max(1u,std::min(64u,lfsrWidth));
+            lfsr.taps = lfsrTaps & mask(lfsr.width);
+            lfsr.state = seed & mask(lfsr.width);
+
+            misr.width = std::max(1u,std::min(64u,misrWidth));
+            misr.taps = misrTaps & mask(misr.width);
+            misr.state = 0;
+
+            patternCount = 0;
+
+            unsigned inCount = netlist.getInputCount();
+
+            //Room for the stream bits of 64 patterns: the last input of the last one is s[63 + inCount - 1].
+            window.resize((inCount + 126) / 64);
+
+            for(auto& w : window) w = lfsr.next(64);
+
+            inputWords.resize(inCount);
+            values.resize(netlist.size());
+        }
+
+        /// <summary>
+        /// Applies the next count patterns.
+        /// </summary>
+        /// <returns>
+        /// The signature after the last of them.
+        /// </returns>
+        Word run(unsigned long long count)
+        {
+            unsigned outCount = netlist.getOutputCount();
+            Word folded[64];
+
+            while(count > 0){
+
+                unsigned block = (unsigned)std::min<unsigned long long>(64,count);
+
+                for(unsigned i = 0; i < inputWords.size(); ++i){
+
+                    unsigned w = i / 64,b = i % 64;
+
+                    inputWords[i] = b == 0 ? window[w] : (window[w] >> b) | (window[w + 1] << (64 - b));
+                }
+
+                netlist.simulate(inputWords.data(),values.data());
+
+                std::fill(folded,folded + 64,0);
+
+                for(unsigned o = 0; o < outCount; ++o){
+
+                    unsigned n = netlist.getOutputNode(o);
+
+                    if(n == Netlist::NONE || netlist.getStatus(n) < 0) continue;
+
+                    folded[o % misr.width] ^= values[n];
+                }
+
+                //Row p now holds the folded response of pattern p.
+                transpose(folded);
+
+                for(unsigned p = 0; p < block; ++p) misr.clock(folded[p]);
+
+                advance(block);
+
+                patternCount += block;
+                count -= block;
+            }
+
+            return misr.state;
+        }
+
+        Word getSignature() const
+        {
+            return misr.state;
+        }
+
+        /// <summary>
+        /// The number of patterns applied so far.
+        /// </summary>
+        unsigned long long getPatternCount() const
+        {
+            return patternCount;
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+    private:
+
+        struct Register
+        {
+            unsigned width;
+            Word taps;
+            Word state;
+
+            /// <summary>
+            /// Steps the LFSR count times; bit i of the result is the i'th stream bit.
+            /// </summary>
+            Word next(unsigned count)
+            {
+                Word bits = 0;
+
+                for(unsigned i = 0; i < count; ++i){
+
+                    bits |= (state & 1) << i;
+
+                    Word feedback = (Word)(Netlist::popcount(state & taps) & 1);
+
+                    state = (state >> 1) | (feedback << (width - 1));
+                }
+
+                return bits;
+            }
+
+            /// <summary>
+            /// Shifts the MISR once and adds a response.
+            /// </summary>
+            void clock(Word response)
+            {
+                Word top = (state >> (width - 1)) & 1;
+
+                state = (((state << 1) & mask(width)) ^ (top ? taps : 0) ^ response) & mask(width);
+            }
+        };
+
+        static Word mask(unsigned width)
+        {
+            return width >= 64 ? Netlist::ONES : ((Word)1 << width) - 1;
+        }
+
+        /// <summary>
+        /// Moves the stream window on by count bits, count at most 64.
+        /// </summary>
+        void advance(unsigned count)
+        {
+            if(count == 64){
+
+                std::copy(window.begin() + 1,window.end(),window.begin());
+                window.back() = lfsr.next(64);
+                return;
+            }
+
+            for(unsigned w = 0; w + 1 < window.size(); ++w){
+
+                window[w] = (window[w] >> count) | (window[w + 1] << (64 - count));
+            }
+
+            window.back() = (window.back() >> count) | (lfsr.next(count) << (64 - count));
+        }
+
+        /// <summary>
+        /// Transposes a 64 by 64 bit matrix: bit b of row r trades places with bit r of row b.
+        /// </summary>
+        static void transpose(Word* rows)
+        {
+            Word m = 0x00000000FFFFFFFFull;
+
+            for(unsigned j = 32; j != 0; j >>= 1,m ^= m << j){
+
+                for(unsigned k = 0; k < 64; k = (k + j + 1) & ~j){
+
+                    Word t = ((rows[k] >> j) ^ rows[k + j]) & m;
+
+                    rows[k] ^= t << j;
+                    rows[k + j] ^= t;
+                }
+            }
+        }
+
+        Netlist netlist;
+        Register lfsr;
+        Register misr;
+        std::vector<Word> window;
+        std::vector<Word> inputWords;
+        std::vector<Word> values;
+        unsigned long long patternCount;
+    };
+
+    const SelfTester::Word SelfTester::DEFAULT_TAPS;
+}
+
+#endif//LOGIC_SELF_TESTER
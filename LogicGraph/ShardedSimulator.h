@@ -0,0 +1,528 @@
+/// Simulation of a netlist split over several worker processes.
+#ifndef LOGIC_SHARDED_SIMULATOR
+#define LOGIC_SHARDED_SIMULATOR
+
+#include "Partitioner.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Simulates a snapshot of a logic graph cut into shards (see Partitioner), each
+    /// shard in its own worker process with only its own gates to evaluate.
+    /// Input words and the values that cross between shards live in a ring of slots
+    /// in memory shared by every process, one slot per block of 64 vectors in flight.
+    /// The driver, in the calling process, talks to each worker over a Unix domain
+    /// socket: it names a block for the worker to evaluate once every earlier shard the
+    /// worker reads from is done with it, and the worker answers when it is done too.
+    /// Since edges only run to later shards, the shards work as a pipeline, each on a
+    /// different block.
+    /// Workers are started by the constructor and stopped by the destructor. Only POSIX
+    /// systems have the workers; elsewhere isRunning() is false and run fails.
+    /// </summary>
+    class ShardedSimulator
+    {
+    public:
+
+        typedef LogicGraph::SByte SByte;
+        typedef Netlist::Word Word;
+
+        ShardedSimulator() = delete;
+        ShardedSimulator(const ShardedSimulator&) = delete;
+        ShardedSimulator& operator=(const ShardedSimulator&) = delete;
+
+        /// <params>
+        /// shardCount: The number of worker processes; at most one per gate.
+        /// </params>
+        ShardedSimulator(const LogicGraph& graph,unsigned shardCount) : netlist(graph),partitioner(netlist,shardCount)
+        {
+            unsigned size = netlist.size();
+            unsigned inCount = netlist.getInputCount();
+            unsigned count = partitioner.getShardCount();
+
+            //Shared words: the inputs, then every gate read from another shard or by the driver.
+            std::vector<unsigned> place(size,(unsigned)Netlist::NONE);
+
+            for(unsigned i = 0; i < inCount; ++i) place[i] = i;
+
+            slotWords = inCount;
+
+            auto share = [&](unsigned n){
+                if(place[n] == Netlist::NONE) place[n] = slotWords++;
+            };
+
+            for(unsigned n = inCount; n < size; ++n){
+
+                const unsigned* f = netlist.getFanIn(n);
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i){
+
+                    if(f[i] >= inCount && partitioner.getShard(f[i]) != partitioner.getShard(n)) share(f[i]);
+                }
+            }
+
+            outputPlaces.resize(netlist.getOutputCount(),(unsigned)Netlist::NONE);
+
+            for(unsigned o = 0; o < netlist.getOutputCount(); ++o){
+
+                unsigned n = netlist.getOutputNode(o);
+
+                if(n == Netlist::NONE) continue;
+
+                share(n);
+                outputPlaces[o] = place[n];
+            }
+
+            //Each shard's program: its gates in netlist order, each input a local value or a shared word.
+            shards.resize(count);
+
+            std::vector<unsigned> local(size,(unsigned)Netlist::NONE);
+
+            for(unsigned n = inCount; n < size; ++n){
+
+                Shard& s = shards[partitioner.getShard(n)];
+
+                local[n] = (unsigned)s.nodes.size();
+                s.nodes.push_back(n);
+                s.publish.push_back(place[n]);
+            }
+
+            for(unsigned s = 0; s < count; ++s){
+
+                Shard& shard = shards[s];
+                std::vector<unsigned char> reads(count,0);
+
+                shard.start.push_back(0);
+
+                for(auto n : shard.nodes){
+
+                    const unsigned* f = netlist.getFanIn(n);
+
+                    for(unsigned i = 0; i < netlist.getFanInCount(n); ++i){
+
+                        unsigned m = f[i];
+
+                        if(m >= inCount && partitioner.getShard(m) == s){
+
+                            shard.sources.push_back(local[m]);
+                        }
+                        else{
+
+                            shard.sources.push_back((unsigned)shard.nodes.size() + place[m]);
+
+                            if(m >= inCount) reads[partitioner.getShard(m)] = 1;
+                        }
+                    }
+
+                    shard.start.push_back((unsigned)shard.sources.size());
+                }
+
+                for(unsigned t = 0; t < count; ++t){
+
+                    if(reads[t]) shard.reads.push_back(t);
+                }
+
+                shard.values.resize(shard.nodes.size());
+            }
+
+            memory = nullptr;
+            memoryBytes = (size_t)SLOTS * std::max(1u,slotWords) * sizeof(Word);
+            running = false;
+
+            start();
+        }
+
+        ~ShardedSimulator()
+        {
+            stop();
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        const Partitioner& getPartitioner() const
+        {
+            return partitioner;
+        }
+
+        /// <summary>
+        /// Whether every worker process is up.
+        /// </summary>
+        bool isRunning() const
+        {
+            return running;
+        }
+
+        /// <summary>
+        /// Simulates test vectors of '0'/'1' characters, one getInputCount() long string after another.
+        /// </summary>
+        /// <params>
+        /// results: Room for count * output count values; vector v, output o lands at
+        /// v * output count + o, coded as LogicGraph.getOutput.
+        /// </params>
+        /// <returns>
+        /// -1: The workers are not running, or one of them stopped answering; they are shut down.
+        /// Else: The number of vectors simulated.
+        /// </returns>
+        long long run(const char* vectors,unsigned count,SByte* results)
+        {
+            if(!running) return -1;
+
+        #ifdef _WIN32
+            return -1;
+        #else
+            unsigned shardCount = (unsigned)shards.size();
+            unsigned blocks = (count + 63) / 64;
+            unsigned written = 0,collected = 0;
+
+            for(auto& s : shards){
+
+                s.done = 0;
+                s.busy = false;
+            }
+
+            while(collected < blocks){
+
+                while(written < blocks && written < collected + SLOTS){
+
+                    unsigned patterns = std::min(64u,count - written * 64);
+
+                    netlist.packInputs(vectors + (size_t)written * 64 * netlist.getInputCount(),patterns,slot(written));
+                    ++written;
+                }
+
+                unsigned done = written;
+
+                for(unsigned s = 0; s < shardCount; ++s){
+
+                    Shard& shard = shards[s];
+
+                    done = std::min(done,shard.done);
+
+                    if(shard.busy || shard.done >= written) continue;
+
+                    bool ready = true;
+
+                    for(auto t : shard.reads){
+
+                        if(shards[t].done <= shard.done) ready = false;
+                    }
+
+                    if(!ready) continue;
+
+                    if(!send(shard.socket,shard.done)) return fail();
+
+                    shard.busy = true;
+                }
+
+                for(; collected < done; ++collected){
+
+                    collect(collected,std::min(64u,count - collected * 64),results + (size_t)collected * 64 * netlist.getOutputCount());
+                }
+
+                if(collected == blocks) break;
+
+                if(!await()) return fail();
+            }
+
+            return count;
+        #endif
+        }
+
+    private:
+
+        /// <summary>
+        /// Blocks in flight: enough for every shard of a pipeline to have one.
+        /// </summary>
+        static const unsigned SLOTS = 16;
+
+        /// <summary>
+        /// The block number that tells a worker to exit.
+        /// </summary>
+        static const unsigned STOP = ~0u;
+
+        /// <summary>
+        /// A shard's gates, how to reach their inputs, and where to publish them.
+        /// </summary>
+        struct Shard
+        {
+            std::vector<unsigned> nodes;
+            /// <summary>
+            /// Inputs of nodes[j] are sources[start[j]] to sources[start[j + 1]]: below nodes.size(),
+            /// a value of this shard; else the shared word at that minus nodes.size().
+            /// </summary>
+            std::vector<unsigned> start;
+            std::vector<unsigned> sources;
+            /// <summary>
+            /// The shared word of each gate, or NONE if nobody outside the shard reads it.
+            /// </summary>
+            std::vector<unsigned> publish;
+            /// <summary>
+            /// The earlier shards this one reads from.
+            /// </summary>
+            std::vector<unsigned> reads;
+            std::vector<Word> values;
+            int socket;
+            int pid;
+            unsigned done;
+            bool busy;
+        };
+
+        Word* slot(unsigned block) const
+        {
+            return memory + (size_t)(block % SLOTS) * slotWords;
+        }
+
+        void collect(unsigned block,unsigned patterns,SByte* results) const
+        {
+            const Word* words = slot(block);
+            unsigned outCount = netlist.getOutputCount();
+
+            for(unsigned o = 0; o < outCount; ++o){
+
+                unsigned n = netlist.getOutputNode(o);
+                SByte status = n == Netlist::NONE ? -3 : netlist.getStatus(n);
+                Word w = status < 0 ? 0 : words[outputPlaces[o]];
+
+                for(unsigned p = 0; p < patterns; ++p){
+
+                    results[(size_t)p * outCount + o] = status < 0 ? status : (SByte)((w >> p) & 1);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Evaluates one block of a shard; runs in the worker.
+        /// </summary>
+        void evaluate(Shard& shard,unsigned block) const
+        {
+            Word* words = slot(block);
+            unsigned localCount = (unsigned)shard.nodes.size();
+
+            for(unsigned j = 0; j < localCount; ++j){
+
+                const unsigned* f = shard.sources.data() + shard.start[j];
+                Word w = netlist.evaluateWith(shard.nodes[j],[&](unsigned i){
+                    return f[i] < localCount ? shard.values[f[i]] : words[f[i] - localCount];
+                });
+
+                shard.values[j] = w;
+
+                if(shard.publish[j] != Netlist::NONE) words[shard.publish[j]] = w;
+            }
+        }
+
+    #ifdef _WIN32
+        void start()
+        {
+        }
+
+        void stop()
+        {
+        }
+    #else
+        void start()
+        {
+            //No socket or process yet, so stop() leaves a shard alone until it has both.
+            for(auto& s : shards){
+
+                s.socket = -1;
+                s.pid = -1;
+            }
+
+            void* view = mmap(nullptr,memoryBytes,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_ANONYMOUS,-1,0);
+
+            if(view == MAP_FAILED) return;
+
+            memory = (Word*)view;
+
+            for(unsigned s = 0; s < shards.size(); ++s){
+
+                int pair[2];
+
+                if(socketpair(AF_UNIX,SOCK_STREAM,0,pair) != 0){
+                    shards.resize(s);
+                    stop();
+                    return;
+                }
+
+                pid_t pid = fork();
+
+                if(pid == 0){
+
+                    close(pair[0]);
+
+                    //Drop the driver's ends of the earlier workers, so they see it go.
+                    for(unsigned t = 0; t < s; ++t) close(shards[t].socket);
+
+                    work(shards[s],pair[1]);
+                }
+
+                close(pair[1]);
+
+                if(pid < 0){
+                    close(pair[0]);
+                    shards.resize(s);
+                    stop();
+                    return;
+                }
+
+                shards[s].socket = pair[0];
+                shards[s].pid = (int)pid;
+            }
+
+            running = true;
+        }
+
+        /// <summary>
+        /// The worker loop: evaluate each block named until told to stop or the driver goes.
+        /// </summary>
+        void work(Shard& shard,int socket) const
+        {
+            unsigned block;
+
+            while(receive(socket,block) && block != STOP){
+
+                evaluate(shard,block);
+
+                if(!send(socket,block)) break;
+            }
+
+            _exit(0);
+        }
+
+        void stop()
+        {
+            for(auto& s : shards){
+
+                if(s.socket < 0) continue;
+
+                send(s.socket,STOP);
+                close(s.socket);
+            }
+
+            for(auto& s : shards){
+
+                if(s.pid <= 0) continue;
+
+                while(waitpid(s.pid,nullptr,0) < 0 && errno == EINTR){
+                }
+            }
+
+            shards.clear();
+
+            if(memory != nullptr) munmap(memory,memoryBytes);
+
+            memory = nullptr;
+            running = false;
+        }
+
+        long long fail()
+        {
+            for(auto& s : shards){
+
+                if(s.pid > 0) kill(s.pid,SIGKILL);
+            }
+
+            stop();
+
+            return -1;
+        }
+
+        static bool send(int socket,unsigned block)
+        {
+            ssize_t sent;
+
+            while((sent = ::send(socket,&block,sizeof block,MSG_NOSIGNAL)) < 0 && errno == EINTR){
+            }
+
+            return sent == (ssize_t)sizeof block;
+        }
+
+        static bool receive(int socket,unsigned& block)
+        {
+            char* to = (char*)&block;
+            size_t got = 0;
+
+            while(got < sizeof block){
+
+                ssize_t r = recv(socket,to + got,sizeof block - got,0);
+
+                if(r < 0 && errno == EINTR) continue;
+                if(r <= 0) return false;
+
+                got += (size_t)r;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Waits for at least one busy worker to finish its block.
+        /// </summary>
+        bool await()
+        {
+            std::vector<pollfd> polls;
+
+            for(auto& s : shards){
+
+                if(!s.busy) continue;
+
+                pollfd p = {s.socket,POLLIN,0};
+                polls.push_back(p);
+            }
+
+            if(polls.empty()) return false;
+
+            while(poll(polls.data(),(nfds_t)polls.size(),-1) < 0){
+
+                if(errno != EINTR) return false;
+            }
+
+            for(auto& p : polls){
+
+                if(p.revents == 0) continue;
+
+                for(auto& s : shards){
+
+                    if(s.socket != p.fd) continue;
+
+                    unsigned block;
+
+                    if(!receive(s.socket,block) || block != s.done) return false;
+
+                    s.busy = false;
+                    ++s.done;
+                }
+            }
+
+            return true;
+        }
+    #endif
+
+        Netlist netlist;
+        Partitioner partitioner;
+        std::vector<Shard> shards;
+        std::vector<unsigned> outputPlaces;
+        Word* memory;
+        size_t memoryBytes;
+        unsigned slotWords;
+        bool running;
+    };
+
+    const unsigned ShardedSimulator::SLOTS;
+    const unsigned ShardedSimulator::STOP;
+}
+
+#endif//LOGIC_SHARDED_SIMULATOR
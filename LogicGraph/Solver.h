@@ -0,0 +1,736 @@
+/// A conflict driven clause learning SAT solver.
+#ifndef LOGIC_SOLVER
+#define LOGIC_SOLVER
+
+#include <vector>
+#include <algorithm>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// An incremental CDCL SAT solver: two watched literals, first-UIP learning,
+    /// VSIDS branching with phase saving, Luby restarts and learnt clause reduction.
+    /// Clauses and learnt clauses persist between calls to solve, and each call
+    /// may take a list of assumptions that hold for that call only.
+    /// </summary>
+    class Solver
+    {
+    public:
+
+        /// <summary>
+        /// A literal: variable * 2, plus 1 when negated.
+        /// </summary>
+        typedef int Lit;
+
+        typedef char SByte;
+
+        static Lit mkLit(int var,bool negated = false)
+        {
+            return var * 2 + (negated ? 1 : 0);
+        }
+
+        static int var(Lit l)
+        {
+            return l >> 1;
+        }
+
+        static bool sign(Lit l)
+        {
+            return (l & 1) != 0;
+        }
+
+        Solver()
+        {
+            ok = true;
+            qhead = 0;
+            varInc = 1.0;
+            clauseInc = 1.0;
+            conflicts = 0;
+            learntCount = 0;
+            maxLearnts = 0;
+        }
+
+        int varCount() const
+        {
+            return (int)assigns.size();
+        }
+
+        long long getConflicts() const
+        {
+            return conflicts;
+        }
+
+        int newVar()
+        {
+            int v = (int)assigns.size();
+
+            assigns.push_back(0);
+            levels.push_back(0);
+            reasons.push_back(NO_REASON);
+            activity.push_back(0.0);
+            polarity.push_back(1);
+            seen.push_back(0);
+            heapIndex.push_back(-1);
+            model.push_back(false);
+            watches.resize(watches.size() + 2);
+
+            heapInsert(v);
+
+            return v;
+        }
+
+        /// <summary>
+        /// Adds a permanent clause.
+        /// </summary>
+        /// <returns>
+        /// false: The clauses are now unsatisfiable.
+        /// </returns>
+        bool addClause(std::vector<Lit> lits)
+        {
+            if(!ok) return false;
+
+            cancelUntil(0);
+
+            std::sort(lits.begin(),lits.end());
+
+            size_t j = 0;
+            Lit last = -1;
+
+            for(size_t i = 0; i < lits.size(); ++i){
+
+                SByte v = value(lits[i]);
+
+                if(v > 0 || lits[i] == (last ^ 1)) return true;
+                if(v < 0 || lits[i] == last) continue;
+
+                last = lits[j++] = lits[i];
+            }
+
+            lits.resize(j);
+
+            if(lits.empty()) return ok = false;
+
+            if(lits.size() == 1){
+
+                enqueue(lits[0],NO_REASON);
+
+                return ok = propagate() == NO_REASON;
+            }
+
+            attach(newClause(lits,false));
+
+            return true;
+        }
+
+        /// <summary>
+        /// Searches for an assignment satisfying every clause and the assumptions.
+        /// </summary>
+        /// <params>
+        /// conflictBudget: Gives up after this many conflicts; negative for no limit.
+        /// </params>
+        /// <returns>
+        ///  1: Satisfiable, the assignment is in modelValue.
+        ///  0: Unsatisfiable under the assumptions.
+        /// -1: The budget ran out.
+        /// </returns>
+        SByte solve(const std::vector<Lit>& assumptions = std::vector<Lit>(),long long conflictBudget = -1)
+        {
+            if(!ok) return 0;
+
+            if(maxLearnts == 0) maxLearnts = std::max(clauses.size() / 3,(size_t)2000);
+
+            long long limit = conflictBudget < 0 ? -1 : conflicts + conflictBudget;
+            SByte result = -1;
+
+            for(int restart = 0; result == -1; ++restart){
+
+                if(limit >= 0 && conflicts >= limit) break;
+
+                result = search((long long)(luby(restart) * 100),assumptions,limit);
+            }
+
+            if(result == 1){
+
+                for(size_t v = 0; v < assigns.size(); ++v){
+
+                    model[v] = assigns[v] > 0;
+                }
+            }
+
+            cancelUntil(0);
+
+            return result;
+        }
+
+        /// <summary>
+        /// Returns the variable's value in the last satisfying assignment.
+        /// </summary>
+        bool modelValue(int v) const
+        {
+            return model[v];
+        }
+
+        /// <summary>
+        /// Returns the literal's value in the last satisfying assignment.
+        /// </summary>
+        bool modelLit(Lit l) const
+        {
+            return model[var(l)] != sign(l);
+        }
+
+    private:
+
+        typedef unsigned CRef;
+
+        static const CRef NO_REASON = ~0u;
+
+        struct Clause
+        {
+            std::vector<Lit> lits;
+            double activity;
+            bool learnt;
+            bool removed;
+        };
+
+        struct Watcher
+        {
+            CRef clause;
+            Lit blocker;
+        };
+
+        SByte value(Lit l) const
+        {
+            SByte v = assigns[var(l)];
+
+            return sign(l) ? -v : v;
+        }
+
+        int decisionLevel() const
+        {
+            return (int)trailLimits.size();
+        }
+
+        CRef newClause(const std::vector<Lit>& lits,bool learnt)
+        {
+            Clause c;
+            c.lits = lits;
+            c.activity = 0.0;
+            c.learnt = learnt;
+            c.removed = false;
+            clauses.push_back(std::move(c));
+
+            if(learnt) ++learntCount;
+
+            return (CRef)(clauses.size() - 1);
+        }
+
+        void attach(CRef cr)
+        {
+            const Clause& c = clauses[cr];
+            Watcher w0 = {cr,c.lits[1]};
+            Watcher w1 = {cr,c.lits[0]};
+
+            watches[c.lits[0] ^ 1].push_back(w0);
+            watches[c.lits[1] ^ 1].push_back(w1);
+        }
+
+        void enqueue(Lit l,CRef reason)
+        {
+            int v = var(l);
+
+            assigns[v] = sign(l) ? -1 : 1;
+            levels[v] = decisionLevel();
+            reasons[v] = reason;
+            trail.push_back(l);
+        }
+
+        /// <summary>
+        /// Propagates every unit clause.
+        /// </summary>
+        /// <returns>
+        /// The conflicting clause, or NO_REASON.
+        /// </returns>
+        CRef propagate()
+        {
+            CRef conflict = NO_REASON;
+
+            while(qhead < trail.size()){
+
+                Lit p = trail[qhead++];
+                Lit falseLit = p ^ 1;
+                std::vector<Watcher>& ws = watches[p];
+
+                size_t i = 0;
+                size_t j = 0;
+
+                while(i < ws.size()){
+
+                    Watcher w = ws[i++];
+
+                    if(value(w.blocker) > 0){
+
+                        ws[j++] = w;
+                        continue;
+                    }
+
+                    std::vector<Lit>& lits = clauses[w.clause].lits;
+
+                    if(lits[0] == falseLit) std::swap(lits[0],lits[1]);
+
+                    Watcher kept = {w.clause,lits[0]};
+
+                    if(lits[0] != w.blocker && value(lits[0]) > 0){
+
+                        ws[j++] = kept;
+                        continue;
+                    }
+
+                    bool moved = false;
+
+                    for(size_t k = 2; k < lits.size(); ++k){
+
+                        if(value(lits[k]) >= 0){
+
+                            std::swap(lits[1],lits[k]);
+                            Watcher moving = {w.clause,lits[0]};
+                            watches[lits[1] ^ 1].push_back(moving);
+                            moved = true;
+                            break;
+                        }
+                    }
+
+                    if(moved) continue;
+
+                    ws[j++] = kept;
+
+                    if(value(lits[0]) < 0){
+
+                        conflict = w.clause;
+                        qhead = trail.size();
+
+                        while(i < ws.size()) ws[j++] = ws[i++];
+                    }
+                    else enqueue(lits[0],w.clause);
+                }
+
+                ws.resize(j);
+            }
+
+            return conflict;
+        }
+
+        /// <summary>
+        /// Derives the first-UIP clause of a conflict.
+        /// </summary>
+        void analyze(CRef conflict,std::vector<Lit>& learnt,int& backLevel)
+        {
+            learnt.clear();
+            learnt.push_back(0);
+
+            int pathCount = 0;
+            Lit p = -1;
+            size_t index = trail.size();
+
+            do{
+                Clause& c = clauses[conflict];
+
+                if(c.learnt) bumpClause(c);
+
+                for(size_t k = p == -1 ? 0 : 1; k < c.lits.size(); ++k){
+
+                    Lit q = c.lits[k];
+                    int v = var(q);
+
+                    if(seen[v] || levels[v] == 0) continue;
+
+                    seen[v] = 1;
+                    bumpVar(v);
+
+                    if(levels[v] >= decisionLevel()) ++pathCount;
+                    else learnt.push_back(q);
+                }
+
+                while(!seen[var(trail[--index])]);
+
+                p = trail[index];
+                conflict = reasons[var(p)];
+                seen[var(p)] = 0;
+                --pathCount;
+
+            }while(pathCount > 0);
+
+            learnt[0] = p ^ 1;
+            marked = learnt;
+
+            //Drop literals implied by the rest of the clause.
+            size_t j = 1;
+            for(size_t i = 1; i < learnt.size(); ++i){
+
+                CRef r = reasons[var(learnt[i])];
+                bool redundant = r != NO_REASON;
+
+                if(redundant){
+
+                    const std::vector<Lit>& lits = clauses[r].lits;
+
+                    for(size_t k = 1; k < lits.size(); ++k){
+
+                        int v = var(lits[k]);
+
+                        if(!seen[v] && levels[v] > 0){
+
+                            redundant = false;
+                            break;
+                        }
+                    }
+                }
+
+                if(!redundant) learnt[j++] = learnt[i];
+            }
+
+            learnt.resize(j);
+
+            for(size_t i = 1; i < marked.size(); ++i){
+
+                seen[var(marked[i])] = 0;
+            }
+
+            backLevel = 0;
+
+            if(learnt.size() > 1){
+
+                size_t max = 1;
+
+                for(size_t i = 2; i < learnt.size(); ++i){
+
+                    if(levels[var(learnt[i])] > levels[var(learnt[max])]) max = i;
+                }
+
+                std::swap(learnt[1],learnt[max]);
+                backLevel = levels[var(learnt[1])];
+            }
+        }
+
+        void cancelUntil(int level)
+        {
+            if(decisionLevel() <= level) return;
+
+            for(size_t i = trail.size(); i-- > (size_t)trailLimits[level];){
+
+                int v = var(trail[i]);
+
+                assigns[v] = 0;
+                reasons[v] = NO_REASON;
+                polarity[v] = sign(trail[i]) ? 1 : 0;
+
+                if(heapIndex[v] < 0) heapInsert(v);
+            }
+
+            trail.resize(trailLimits[level]);
+            trailLimits.resize(level);
+            qhead = trail.size();
+        }
+
+        SByte search(long long restartConflicts,const std::vector<Lit>& assumptions,long long limit)
+        {
+            std::vector<Lit> learnt;
+            long long local = 0;
+
+            for(;;){
+
+                CRef conflict = propagate();
+
+                if(conflict != NO_REASON){
+
+                    ++conflicts;
+                    ++local;
+
+                    if(decisionLevel() == 0){
+
+                        ok = false;
+                        return 0;
+                    }
+
+                    int backLevel;
+                    analyze(conflict,learnt,backLevel);
+                    cancelUntil(backLevel);
+
+                    if(learnt.size() == 1){
+
+                        enqueue(learnt[0],NO_REASON);
+                    }
+                    else{
+
+                        CRef cr = newClause(learnt,true);
+                        attach(cr);
+                        bumpClause(clauses[cr]);
+                        enqueue(learnt[0],cr);
+                    }
+
+                    varInc *= 1 / 0.95;
+                    clauseInc *= 1 / 0.999;
+
+                    continue;
+                }
+
+                if((limit >= 0 && conflicts >= limit) || local >= restartConflicts){
+
+                    cancelUntil(0);
+                    return -1;
+                }
+
+                if(learntCount >= maxLearnts + trail.size()){
+
+                    reduce();
+                    maxLearnts += maxLearnts / 10;
+                }
+
+                Lit next = -1;
+
+                while(decisionLevel() < (int)assumptions.size()){
+
+                    Lit a = assumptions[decisionLevel()];
+
+                    if(value(a) > 0){
+
+                        trailLimits.push_back((int)trail.size());
+                    }
+                    else if(value(a) < 0){
+
+                        return 0;
+                    }
+                    else{
+
+                        next = a;
+                        break;
+                    }
+                }
+
+                if(next == -1){
+
+                    int v = pickBranchVar();
+
+                    if(v < 0) return 1;
+
+                    next = mkLit(v,polarity[v] != 0);
+                }
+
+                trailLimits.push_back((int)trail.size());
+                enqueue(next,NO_REASON);
+            }
+        }
+
+        /// <summary>
+        /// Drops the less active half of the learnt clauses.
+        /// </summary>
+        void reduce()
+        {
+            std::vector<CRef> candidates;
+
+            for(CRef cr = 0; cr < clauses.size(); ++cr){
+
+                const Clause& c = clauses[cr];
+
+                if(!c.learnt || c.removed || c.lits.size() <= 2) continue;
+
+                int v = var(c.lits[0]);
+
+                if(reasons[v] == cr && value(c.lits[0]) > 0) continue;
+
+                candidates.push_back(cr);
+            }
+
+            std::sort(candidates.begin(),candidates.end(),[&](CRef a,CRef b){
+                return clauses[a].activity < clauses[b].activity;
+            });
+
+            for(size_t i = 0; i < candidates.size() / 2; ++i){
+
+                clauses[candidates[i]].removed = true;
+            }
+
+            //Compact the clause list and rebuild the watches over it.
+            std::vector<CRef> moved(clauses.size(),NO_REASON);
+            size_t j = 0;
+            learntCount = 0;
+
+            for(size_t i = 0; i < clauses.size(); ++i){
+
+                if(clauses[i].removed) continue;
+
+                if(clauses[i].learnt) ++learntCount;
+
+                moved[i] = (CRef)j;
+                if(i != j) clauses[j] = std::move(clauses[i]);
+                ++j;
+            }
+
+            clauses.resize(j);
+
+            for(auto& r : reasons){
+
+                if(r != NO_REASON) r = moved[r];
+            }
+
+            for(auto& ws : watches){
+
+                ws.clear();
+            }
+
+            for(CRef cr = 0; cr < clauses.size(); ++cr){
+
+                attach(cr);
+            }
+        }
+
+        void bumpVar(int v)
+        {
+            if((activity[v] += varInc) > 1e100){
+
+                for(auto& a : activity) a *= 1e-100;
+                varInc *= 1e-100;
+            }
+
+            if(heapIndex[v] >= 0) heapUp(heapIndex[v]);
+        }
+
+        void bumpClause(Clause& c)
+        {
+            if((c.activity += clauseInc) > 1e20){
+
+                for(auto& a : clauses) a.activity *= 1e-20;
+                clauseInc *= 1e-20;
+            }
+        }
+
+        int pickBranchVar()
+        {
+            while(!heap.empty()){
+
+                int v = heapPop();
+
+                if(assigns[v] == 0) return v;
+            }
+
+            return -1;
+        }
+
+        static double luby(int x)
+        {
+            int size = 1;
+            int seq = 0;
+
+            while(size < x + 1){
+
+                ++seq;
+                size = 2 * size + 1;
+            }
+
+            while(size - 1 != x){
+
+                size = (size - 1) >> 1;
+                --seq;
+                x = x % size;
+            }
+
+            double r = 1;
+
+            for(int i = 0; i < seq; ++i) r *= 2;
+
+            return r;
+        }
+
+        void heapInsert(int v)
+        {
+            heapIndex[v] = (int)heap.size();
+            heap.push_back(v);
+            heapUp(heapIndex[v]);
+        }
+
+        int heapPop()
+        {
+            int top = heap[0];
+
+            heapIndex[top] = -1;
+            heap[0] = heap.back();
+            heap.pop_back();
+
+            if(!heap.empty()){
+
+                heapIndex[heap[0]] = 0;
+                heapDown(0);
+            }
+
+            return top;
+        }
+
+        void heapUp(int i)
+        {
+            int v = heap[i];
+
+            while(i > 0){
+
+                int parent = (i - 1) >> 1;
+
+                if(activity[heap[parent]] >= activity[v]) break;
+
+                heap[i] = heap[parent];
+                heapIndex[heap[i]] = i;
+                i = parent;
+            }
+
+            heap[i] = v;
+            heapIndex[v] = i;
+        }
+
+        void heapDown(int i)
+        {
+            int v = heap[i];
+            int size = (int)heap.size();
+
+            for(;;){
+
+                int child = 2 * i + 1;
+
+                if(child >= size) break;
+
+                if(child + 1 < size && activity[heap[child + 1]] > activity[heap[child]]) ++child;
+
+                if(activity[heap[child]] <= activity[v]) break;
+
+                heap[i] = heap[child];
+                heapIndex[heap[i]] = i;
+                i = child;
+            }
+
+            heap[i] = v;
+            heapIndex[v] = i;
+        }
+
+        bool ok;
+        size_t qhead;
+        double varInc;
+        double clauseInc;
+        long long conflicts;
+        size_t learntCount;
+        size_t maxLearnts;
+        std::vector<Clause> clauses;
+        std::vector<std::vector<Watcher>> watches;
+        std::vector<SByte> assigns;
+        std::vector<int> levels;
+        std::vector<CRef> reasons;
+        std::vector<double> activity;
+        std::vector<SByte> polarity;
+        std::vector<SByte> seen;
+        std::vector<int> heap;
+        std::vector<int> heapIndex;
+        std::vector<Lit> trail;
+        std::vector<int> trailLimits;
+        std::vector<Lit> marked;
+        std::vector<bool> model;
+    };
+
+    const Solver::CRef Solver::NO_REASON;
+}
+
+#endif//LOGIC_SOLVER
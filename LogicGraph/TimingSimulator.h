@@ -0,0 +1,400 @@
+/// Event driven timing simulation with per-gate rise and fall delays.
+#ifndef LOGIC_TIMING_SIMULATOR
+#define LOGIC_TIMING_SIMULATOR
+
+#include "Netlist.h"
+#include <algorithm>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Simulates a snapshot of a logic graph in time, each gate switching after its
+    /// rise or fall delay (LogicGraph.setGateDelay). Delays are inertial: a gate whose
+    /// inputs change back before its output has switched drops the pending switch.
+    /// Events wait on a timing wheel of WHEEL slots, one per time unit; events further
+    /// out than that wait in a heap until the wheel comes round to them.
+    /// Each vector is applied once the previous one has settled, one time unit later,
+    /// starting from the state all-zero inputs settle to.
+    /// For every output the simulator keeps the waveform, the glitches (pulses that
+    /// come and go within one vector) and the longest time the output took to settle.
+    /// </summary>
+    class TimingSimulator
+    {
+    public:
+
+        typedef Netlist::Word Word;
+        typedef LogicGraph::SByte SByte;
+        typedef unsigned long long Time;
+
+        /// <summary>
+        /// One switch of an output: the time and the value it switched to.
+        /// </summary>
+        struct Transition
+        {
+            Time time;
+            bool value;
+        };
+
+        TimingSimulator() = delete;
+
+        explicit TimingSimulator(const LogicGraph& graph) : netlist(graph)
+        {
+            unsigned size = netlist.size();
+            unsigned outCount = netlist.getOutputCount();
+
+            outStart.assign(size + 1,0);
+
+            for(unsigned n = 0; n < size; ++n){
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) ++outStart[netlist.getFanIn(n)[i] + 1];
+            }
+
+            for(unsigned n = 0; n < size; ++n) outStart[n + 1] += outStart[n];
+
+            fanOut.resize(outStart[size]);
+
+            std::vector<unsigned> fill(outStart.begin(),outStart.end() - 1);
+
+            for(unsigned n = 0; n < size; ++n){
+
+                for(unsigned i = 0; i < netlist.getFanInCount(n); ++i) fanOut[fill[netlist.getFanIn(n)[i]]++] = n;
+            }
+
+            slots.resize(size);
+
+            for(unsigned o = 0; o < outCount; ++o){
+
+                unsigned n = netlist.getOutputNode(o);
+
+                if(n != Netlist::NONE && netlist.getStatus(n) == 0) slots[n].push_back(o);
+            }
+
+            //Settle the all-zero vector without delays.
+            std::vector<Word> inputWords(netlist.getInputCount(),0);
+            std::vector<Word> values(size);
+
+            netlist.simulate(inputWords.data(),values.data());
+
+            current.resize(size);
+
+            for(unsigned n = 0; n < size; ++n) current[n] = (unsigned char)(values[n] & 1);
+
+            pending.assign(size,0);
+            pendingValue.assign(size,0);
+            generation.assign(size,0);
+            marked.assign(size,0);
+            wheel.resize(WHEEL);
+
+            waveforms.resize(outCount);
+            glitches.assign(outCount,0);
+            settle.assign(outCount,0);
+            switches.assign(outCount,0);
+            initial.assign(outCount,0);
+            lastSwitch.assign(outCount,0);
+
+            now = 0;
+            scheduled = 0;
+            eventCount = 0;
+            vectorCount = 0;
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        /// <summary>
+        /// Applies one vector of '0'/'1' characters (as LogicGraph.feedInputString) and runs until the graph settles.
+        /// </summary>
+        /// <returns>
+        /// The time from applying the vector to the last switch it caused.
+        /// </returns>
+        Time apply(const char* vector)
+        {
+            Time start = now;
+            unsigned outCount = netlist.getOutputCount();
+
+            for(unsigned o = 0; o < outCount; ++o){
+
+                unsigned n = netlist.getOutputNode(o);
+
+                switches[o] = 0;
+                initial[o] = n == Netlist::NONE ? 0 : current[n];
+            }
+
+            for(unsigned i = 0; i < netlist.getInputCount(); ++i){
+
+                unsigned char v = vector[i] == '1' ? 1 : 0;
+
+                if(v != current[i]) change(i,v);
+            }
+
+            evaluateMarked();
+
+            Time last = run(start);
+
+            for(unsigned o = 0; o < outCount; ++o){
+
+                if(switches[o] == 0) continue;
+
+                unsigned n = netlist.getOutputNode(o);
+                unsigned net = current[n] != initial[o] ? 1 : 0;
+
+                glitches[o] += (switches[o] - net) / 2;
+                settle[o] = std::max(settle[o],lastSwitch[o] - start);
+            }
+
+            ++vectorCount;
+            now = last + 1;
+
+            return last - start;
+        }
+
+        /// <summary>
+        /// Applies test vectors of '0'/'1' characters, one getInputCount() long string after another, in order.
+        /// </summary>
+        /// <returns>
+        /// The longest time any of the vectors took to settle.
+        /// </returns>
+        Time simulate(const char* vectors,unsigned count)
+        {
+            Time longest = 0;
+
+            for(unsigned v = 0; v < count; ++v){
+
+                longest = std::max(longest,apply(vectors + (size_t)v * netlist.getInputCount()));
+            }
+
+            return longest;
+        }
+
+        /// <summary>
+        /// The time the next vector will be applied at.
+        /// </summary>
+        Time getTime() const
+        {
+            return now;
+        }
+
+        /// <summary>
+        /// The number of switches simulated so far, cancelled ones left out.
+        /// </summary>
+        unsigned long long getEventCount() const
+        {
+            return eventCount;
+        }
+
+        unsigned long long getVectorCount() const
+        {
+            return vectorCount;
+        }
+
+        /// <summary>
+        /// The switches of the indexed output since the waveforms were last cleared.
+        /// Closed outputs, and outputs that report an error, have none.
+        /// </summary>
+        const std::vector<Transition>& getWaveform(unsigned index) const
+        {
+            return waveforms[index];
+        }
+
+        /// <summary>
+        /// The number of pulses on the indexed output that came and went within one vector.
+        /// </summary>
+        unsigned long long getGlitchCount(unsigned index) const
+        {
+            return glitches[index];
+        }
+
+        /// <summary>
+        /// The longest time the indexed output took to settle after a vector was applied.
+        /// </summary>
+        Time getSettleTime(unsigned index) const
+        {
+            return settle[index];
+        }
+
+        void clearWaveforms()
+        {
+            for(auto& w : waveforms) w.clear();
+        }
+
+    private:
+
+        /// <summary>
+        /// Time units on the wheel; a power of two.
+        /// </summary>
+        static const unsigned WHEEL = 1024;
+
+        struct Event
+        {
+            Time time;
+            unsigned node;
+            unsigned generation;
+            unsigned char value;
+        };
+
+        struct Later
+        {
+            bool operator()(const Event& a,const Event& b) const
+            {
+                return a.time > b.time;
+            }
+        };
+
+        void schedule(unsigned n,unsigned char value,Time t)
+        {
+            Event e = {t,n,generation[n],value};
+
+            if(t - now < WHEEL){
+
+                wheel[t & (WHEEL - 1)].push_back(e);
+                ++scheduled;
+            }
+            else{
+
+                overflow.push_back(e);
+                std::push_heap(overflow.begin(),overflow.end(),Later());
+            }
+
+            pending[n] = 1;
+            pendingValue[n] = value;
+        }
+
+        /// <summary>
+        /// Switches a node now and marks what it feeds for evaluation.
+        /// </summary>
+        void change(unsigned n,unsigned char value)
+        {
+            current[n] = value;
+
+            for(auto o : slots[n]){
+
+                Transition t = {now,value != 0};
+                waveforms[o].push_back(t);
+                ++switches[o];
+                lastSwitch[o] = now;
+            }
+
+            for(unsigned i = outStart[n]; i < outStart[n + 1]; ++i){
+
+                unsigned m = fanOut[i];
+
+                if(!marked[m] && netlist.getStatus(m) == 0){
+
+                    marked[m] = 1;
+                    dirty.push_back(m);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Re-evaluates the marked nodes and schedules, keeps or cancels their switches.
+        /// </summary>
+        void evaluateMarked()
+        {
+            for(auto m : dirty){
+
+                marked[m] = 0;
+
+                const unsigned* f = netlist.getFanIn(m);
+                Word w = netlist.evaluateWith(m,[&](unsigned i){ return current[f[i]] ? Netlist::ONES : 0; });
+                unsigned char value = (unsigned char)(w & 1);
+
+                if(pending[m]){
+
+                    if(value == pendingValue[m]) continue;
+
+                    ++generation[m];
+                    pending[m] = 0;
+                }
+
+                if(value != current[m]) schedule(m,value,now + (value ? netlist.getRiseDelay(m) : netlist.getFallDelay(m)));
+            }
+
+            dirty.clear();
+        }
+
+        /// <summary>
+        /// Runs events until none are left.
+        /// </summary>
+        /// <returns>
+        /// The time of the last switch, or start if nothing switched.
+        /// </returns>
+        Time run(Time start)
+        {
+            Time last = start;
+
+            while(scheduled > 0 || !overflow.empty()){
+
+                if(scheduled == 0) now = overflow.front().time;
+
+                while(!overflow.empty() && overflow.front().time - now < WHEEL){
+
+                    Event e = overflow.front();
+                    std::pop_heap(overflow.begin(),overflow.end(),Later());
+                    overflow.pop_back();
+                    wheel[e.time & (WHEEL - 1)].push_back(e);
+                    ++scheduled;
+                }
+
+                std::vector<Event>& slot = wheel[now & (WHEEL - 1)];
+
+                //Zero delays land back in this slot, so drain it until it stays empty.
+                while(!slot.empty()){
+
+                    due.swap(slot);
+                    scheduled -= due.size();
+
+                    for(auto& e : due){
+
+                        if(e.generation != generation[e.node]) continue;
+
+                        pending[e.node] = 0;
+
+                        if(current[e.node] == e.value) continue;
+
+                        change(e.node,e.value);
+                        ++eventCount;
+                        last = now;
+                    }
+
+                    due.clear();
+                    evaluateMarked();
+                }
+
+                if(scheduled > 0 || !overflow.empty()) ++now;
+            }
+
+            return last;
+        }
+
+        Netlist netlist;
+        std::vector<unsigned> outStart;
+        std::vector<unsigned> fanOut;
+        std::vector<std::vector<unsigned>> slots;
+        std::vector<unsigned char> current;
+        std::vector<unsigned char> pending;
+        std::vector<unsigned char> pendingValue;
+        std::vector<unsigned> generation;
+        std::vector<unsigned char> marked;
+        std::vector<unsigned> dirty;
+        std::vector<std::vector<Event>> wheel;
+        std::vector<Event> overflow;
+        std::vector<Event> due;
+        std::vector<std::vector<Transition>> waveforms;
+        std::vector<unsigned long long> glitches;
+        std::vector<Time> settle;
+        std::vector<unsigned> switches;
+        std::vector<unsigned char> initial;
+        std::vector<Time> lastSwitch;
+        Time now;
+        size_t scheduled;
+        unsigned long long eventCount;
+        unsigned long long vectorCount;
+    };
+
+    const unsigned TimingSimulator::WHEEL;
+}
+
+#endif//LOGIC_TIMING_SIMULATOR
@@ -0,0 +1,132 @@
+/// Per-node toggle counting for switching activity estimates.
+#ifndef LOGIC_TOGGLE_RECORDER
+#define LOGIC_TOGGLE_RECORDER
+
+#include "Netlist.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Counts how often every node of a snapshot of a logic graph changes value
+    /// over a sequence of input vectors. Vectors are simulated 64 at a time, and
+    /// the toggles within a word are counted with one XOR against the word shifted
+    /// by a vector and a popcount. Counts live in an array parallel to the netlist.
+    /// </summary>
+    class ToggleRecorder
+    {
+    public:
+
+        typedef Netlist::Word Word;
+        typedef LogicGraph::Key Key;
+
+        ToggleRecorder() = delete;
+
+        explicit ToggleRecorder(const LogicGraph& graph) : netlist(graph)
+        {
+            toggles.resize(netlist.size(),0);
+            last.resize(netlist.size(),0);
+            values.resize(netlist.size());
+            vectorCount = 0;
+        }
+
+        const Netlist& getNetlist() const
+        {
+            return netlist;
+        }
+
+        /// <summary>
+        /// Simulates test vectors of '0'/'1' characters, one getInputCount() long string after
+        /// another (as LogicGraph.feedInputString), in order. The first vector of a call follows
+        /// on from the last vector of the previous call.
+        /// </summary>
+        void simulate(const char* vectors,unsigned count)
+        {
+            unsigned inCount = netlist.getInputCount();
+            std::vector<Word> inputWords(inCount);
+
+            for(unsigned v = 0; v < count; v += 64){
+
+                unsigned patterns = std::min(64u,count - v);
+
+                netlist.packInputs(vectors + (size_t)v * inCount,patterns,inputWords.data());
+                netlist.simulate(inputWords.data(),values.data());
+
+                record(patterns);
+            }
+        }
+
+        /// <summary>
+        /// Forgets the counts and the last vector.
+        /// </summary>
+        void reset()
+        {
+            std::fill(toggles.begin(),toggles.end(),0);
+            vectorCount = 0;
+        }
+
+        unsigned long long getVectorCount() const
+        {
+            return vectorCount;
+        }
+
+        /// <summary>
+        /// The number of nodes counted; nodes are numbered as in the netlist, inputs first.
+        /// </summary>
+        unsigned getNodeCount() const
+        {
+            return netlist.size();
+        }
+
+        Key getKey(unsigned n) const
+        {
+            return netlist.getKey(n);
+        }
+
+        unsigned long long getToggleCount(unsigned n) const
+        {
+            return toggles[n];
+        }
+
+        /// <summary>
+        /// Returns the toggle count of the node with the key, or 0 if the snapshot has no such node.
+        /// </summary>
+        unsigned long long getToggles(Key k) const
+        {
+            unsigned n = netlist.indexOf(k);
+
+            return n == Netlist::NONE ? 0 : toggles[n];
+        }
+
+    private:
+
+        void record(unsigned patterns)
+        {
+            Word valid = patterns == 64 ? Netlist::ONES : ((Word)1 << patterns) - 1;
+
+            //Bit p of a word compares vector p with vector p - 1; bit 0 compares with the last
+            //vector recorded, if there is one.
+            Word compared = vectorCount == 0 ? valid & ~(Word)1 : valid;
+
+            for(unsigned n = 0; n < netlist.size(); ++n){
+
+                if(netlist.getStatus(n) < 0) continue;
+
+                Word w = values[n];
+                Word previous = (w << 1) | last[n];
+
+                toggles[n] += Netlist::popcount((w ^ previous) & compared);
+                last[n] = (w >> (patterns - 1)) & 1;
+            }
+
+            vectorCount += patterns;
+        }
+
+        Netlist netlist;
+        std::vector<unsigned long long> toggles;
+        std::vector<Word> last;
+        std::vector<Word> values;
+        unsigned long long vectorCount;
+    };
+}
+
+#endif//LOGIC_TOGGLE_RECORDER
@@ -0,0 +1,249 @@
+/// Timeline tracing of graph operations, exported as Chrome trace JSON.
+#ifndef LOGIC_TRACER
+#define LOGIC_TRACER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Records how long graph operations take, and on which thread, while tracing is on.
+    /// Operations open a Span for their duration; each finished span goes into a ring
+    /// buffer of the thread that ran it, which keeps the latest events once full.
+    /// The buffers outlive their threads until clear(), and export as Chrome trace
+    /// events, which chrome://tracing and Perfetto open.
+    /// While tracing is off a span costs one relaxed load and a branch.
+    /// </summary>
+    class Tracer
+    {
+    public:
+
+        /// <summary>
+        /// Times the scope it lives in under a name, which must be a string literal.
+        /// </summary>
+        class Span
+        {
+        public:
+
+            explicit Span(const char* name)
+                : name(nullptr),start(0)
+            {
+                if(isEnabled()){
+
+                    this->name = name;
+                    start = now();
+                }
+            }
+
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+
+            ~Span()
+            {
+                if(name != nullptr) record(name,start,now() - start);
+            }
+
+        private:
+
+            const char* name;
+            uint64_t start;
+        };
+
+        Tracer() = delete;
+
+        static void setEnabled(bool enabled)
+        {
+            flag().store(enabled,std::memory_order_relaxed);
+        }
+
+        static bool isEnabled()
+        {
+            return flag().load(std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Sets the events each thread keeps, 1 at least; buffers made from now on take it.
+        /// </summary>
+        static void setCapacity(unsigned capacity)
+        {
+            state().capacity.store(std::max(1u,capacity),std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Drops every recorded event.
+        /// </summary>
+        static void clear()
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+
+            for(auto& b : s.buffers){
+
+                std::lock_guard<std::mutex> hold(b->mutex);
+                b->events.clear();
+                b->next = 0;
+            }
+        }
+
+        /// <summary>
+        /// Writes the recorded events as a Chrome trace: complete events with times in
+        /// microseconds from the first use of the tracer, one trace thread per thread.
+        /// </summary>
+        /// <returns>
+        /// The number of events written.
+        /// </returns>
+        static size_t exportJson(std::ostream& out)
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            size_t count = 0;
+            const char* separator = "";
+
+            out << "{\"traceEvents\":[";
+
+            for(auto& b : s.buffers){
+
+                std::lock_guard<std::mutex> hold(b->mutex);
+
+                out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->thread
+                    << ",\"args\":{\"name\":\"thread " << b->thread << "\"}}";
+                separator = ",";
+
+                //Oldest first: once the ring has wrapped, the oldest event is the next to go.
+                size_t size = b->events.size();
+                size_t first = size < b->capacity ? 0 : b->next;
+
+                for(size_t i = 0; i < size; ++i){
+
+                    const Event& e = b->events[(first + i) % size];
+
+                    out << ",{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->thread
+                        << ",\"ts\":" << e.start / 1000 << '.' << digits(e.start % 1000)
+                        << ",\"dur\":" << e.duration / 1000 << '.' << digits(e.duration % 1000) << '}';
+                    ++count;
+                }
+            }
+
+            out << "],\"displayTimeUnit\":\"ns\"}";
+
+            return count;
+        }
+
+        /// <returns>
+        /// -1: The file could not be written.
+        /// Else: The number of events written.
+        /// </returns>
+        static long long exportJson(const char* path)
+        {
+            std::ofstream file(path,std::ios::binary);
+
+            if(!file) return -1;
+
+            size_t count = exportJson(file);
+
+            file.flush();
+
+            return file ? (long long)count : -1;
+        }
+
+    private:
+
+        struct Event
+        {
+            const char* name;
+            uint64_t start;
+            uint64_t duration;
+        };
+
+        struct Buffer
+        {
+            std::mutex mutex;
+            std::vector<Event> events;
+            size_t next;
+            size_t capacity;
+            unsigned thread;
+        };
+
+        struct State
+        {
+            std::atomic<unsigned> capacity;
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            std::chrono::steady_clock::time_point epoch;
+
+            State()
+                : capacity(65536),epoch(std::chrono::steady_clock::now())
+            {
+            }
+        };
+
+        /// <summary>
+        /// Constant initialized, so unlike state() it is read without a guard.
+        /// </summary>
+        static std::atomic<bool>& flag()
+        {
+            static std::atomic<bool> enabled(false);
+
+            return enabled;
+        }
+
+        static State& state()
+        {
+            static State s;
+
+            return s;
+        }
+
+        /// <summary>
+        /// Nanoseconds since the tracer was first used.
+        /// </summary>
+        static uint64_t now()
+        {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state().epoch).count();
+        }
+
+        static std::string digits(uint64_t fraction)
+        {
+            std::string s = std::to_string(fraction);
+
+            return std::string(3 - s.size(),'0') + s;
+        }
+
+        static void record(const char* name,uint64_t start,uint64_t duration)
+        {
+            //Shared with the registry, so the events outlive the thread.
+            thread_local std::shared_ptr<Buffer> buffer;
+
+            if(buffer == nullptr){
+
+                State& s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+
+                buffer = std::make_shared<Buffer>();
+                buffer->next = 0;
+                buffer->capacity = s.capacity.load(std::memory_order_relaxed);
+                buffer->thread = (unsigned)s.buffers.size() + 1;
+                s.buffers.push_back(buffer);
+            }
+
+            //Only export and clear take the lock from other threads, so it is almost never contended.
+            std::lock_guard<std::mutex> hold(buffer->mutex);
+            Event e = { name,start,duration };
+
+            if(buffer->events.size() < buffer->capacity) buffer->events.push_back(e);
+            else buffer->events[buffer->next] = e;
+
+            buffer->next = (buffer->next + 1) % buffer->capacity;
+        }
+    };
+}
+
+#endif//LOGIC_TRACER
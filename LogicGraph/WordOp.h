@@ -0,0 +1,261 @@
+/// Word-level datapath cells: modules evaluated with native integer operations.
+#ifndef LOGIC_WORD_OP
+#define LOGIC_WORD_OP
+
+#include "Module.h"
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// A multi-bit datapath cell, placed in graphs with LogicGraph.addInstance like any module.
+    /// Its input bits are the instance's inputs in connection order, operand A first, least
+    /// significant bit first, so connecting the bits concatenates them into the operands; its
+    /// output bits are the instance's ports, one slice per bit.
+    /// The graph evaluates the cell on native integers. Its gates, built in the constructor,
+    /// are what flatten copies and what the compiled engines simulate.
+    /// The instance reads each node once, so feed one signal into two bits through a buffer.
+    /// </summary>
+    class WordOp : public Module
+    {
+    public:
+
+        /// <summary>
+        /// The operation, with the inputs and outputs it takes, each width bits unless noted.
+        /// </summary>
+        enum Kind
+        {
+            ADD,            //A, B -> A + B, then the carry out (1 bit)
+            SUB,            //A, B -> A - B, then the borrow out (1 bit), set when A < B
+            AND,            //A, B -> A & B
+            OR,             //A, B -> A | B
+            XOR,            //A, B -> A ^ B
+            EQUAL,          //A, B -> A == B (1 bit)
+            LESS,           //A, B -> A < B unsigned (1 bit)
+            SHIFT_LEFT,     //A, amount (getShiftBits() bits) -> A << amount, 0 from width on
+            SHIFT_RIGHT,    //A, amount (getShiftBits() bits) -> A >> amount, 0 from width on
+            MUX             //A, B, select (1 bit) -> select ? B : A
+        };
+
+        static const unsigned MAX_WIDTH = 64;
+
+        WordOp() = delete;
+
+        /// <params>
+        /// width: 1 to MAX_WIDTH; others are clamped.
+        /// </params>
+        WordOp(Kind kind,unsigned width)
+            : Module(build(kind,std::max(1u,std::min(MAX_WIDTH,width)))),kind(kind),width(std::max(1u,std::min(MAX_WIDTH,width)))
+        {
+        }
+
+        Kind getKind() const
+        {
+            return kind;
+        }
+
+        unsigned getWidth() const
+        {
+            return width;
+        }
+
+        /// <summary>
+        /// The number of amount bits a shift of the given width takes.
+        /// </summary>
+        static unsigned getShiftBits(unsigned width)
+        {
+            unsigned bits = 1;
+
+            while((1u << bits) < width) ++bits;
+
+            return bits;
+        }
+
+        void evaluate(const SByte* inputs,SByte* outputs) const
+        {
+            //Which outputs an input in error reaches is a matter of the gates, so they decide.
+            for(unsigned i = 0; i < getInputCount(); ++i){
+
+                if(inputs[i] < 0){
+
+                    Module::evaluate(inputs,outputs);
+                    return;
+                }
+            }
+
+            uint64_t mask = width == 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+            uint64_t a = pack(inputs,width);
+            uint64_t b = pack(inputs + width,kind == SHIFT_LEFT || kind == SHIFT_RIGHT ? getShiftBits(width) : width);
+            uint64_t r;
+
+            switch(kind){
+            case ADD:
+                r = (a + b) & mask;
+                //A full width sum wraps around, so it carried if it came out smaller.
+                outputs[width] = width == 64 ? (r < a ? 1 : 0) : (SByte)(((a + b) >> width) & 1);
+                break;
+
+            case SUB:
+                r = (a - b) & mask;
+                outputs[width] = a < b ? 1 : 0;
+                break;
+
+            case AND:           r = a & b; break;
+            case OR:            r = a | b; break;
+            case XOR:           r = a ^ b; break;
+            case EQUAL:         outputs[0] = a == b ? 1 : 0; return;
+            case LESS:          outputs[0] = a < b ? 1 : 0; return;
+            case SHIFT_LEFT:    r = b >= width ? 0 : (a << b) & mask; break;
+            case SHIFT_RIGHT:   r = b >= width ? 0 : a >> b; break;
+            default:            r = inputs[2 * width] ? b : a; break;
+            }
+
+            for(unsigned i = 0; i < width; ++i) outputs[i] = (SByte)((r >> i) & 1);
+        }
+
+    private:
+
+        static uint64_t pack(const SByte* bits,unsigned count)
+        {
+            uint64_t w = 0;
+
+            for(unsigned i = 0; i < count; ++i){
+
+                if(bits[i]) w |= (uint64_t)1 << i;
+            }
+
+            return w;
+        }
+
+        typedef LogicGraph::Key Key;
+
+        /// <summary>
+        /// Builds the gates of an operation.
+        /// </summary>
+        static LogicGraph build(Kind kind,unsigned width)
+        {
+            unsigned inCount = kind == SHIFT_LEFT || kind == SHIFT_RIGHT ? width + getShiftBits(width) :
+                kind == MUX ? 2 * width + 1 : 2 * width;
+            unsigned outCount = kind == ADD || kind == SUB ? width + 1 : kind == EQUAL || kind == LESS ? 1 : width;
+            LogicGraph graph(inCount,outCount);
+            std::vector<Key> a(width),b;
+
+            for(unsigned i = 0; i < width; ++i) a[i] = graph.getInputKey(i);
+            for(unsigned i = width; i < inCount; ++i) b.push_back(graph.getInputKey(i));
+
+            auto gate = [&](LogicGraph::Gate g,std::initializer_list<Key> ks){
+                Key k = g ? graph.addGate(g) : graph.addInverter();
+                for(auto x : ks) graph.connectGates(k,x);
+                return k;
+            };
+
+            auto mux = [&](Key zero,Key one,Key select){
+                Key k = graph.addMux(1);
+                graph.connectGates(k,zero);
+                graph.connectGates(k,one);
+                graph.connectGates(k,select);
+                return k;
+            };
+
+            switch(kind){
+            case ADD:
+            case SUB:
+            {
+                //Ripple carry; A - B is A + ~B + 1.
+                std::vector<Key> y(b.begin(),b.end());
+
+                if(kind == SUB){
+
+                    for(auto& k : y) k = gate(nullptr,{k});
+                }
+
+                Key carry = 0;
+
+                for(unsigned i = 0; i < width; ++i){
+
+                    if(i == 0){
+
+                        graph.openOutput(gate(kind == ADD ? LogicGraph::Gates::PARITY : LogicGraph::Gates::XNOR,{a[0],y[0]}),0);
+                        carry = gate(kind == ADD ? LogicGraph::Gates::AND : LogicGraph::Gates::OR,{a[0],y[0]});
+                        continue;
+                    }
+
+                    graph.openOutput(gate(LogicGraph::Gates::PARITY,{a[i],y[i],carry}),i);
+                    carry = gate(LogicGraph::Gates::MAJORITY,{a[i],y[i],carry});
+                }
+
+                graph.openOutput(kind == ADD ? carry : gate(nullptr,{carry}),width);
+                break;
+            }
+
+            case AND:
+            case OR:
+            case XOR:
+            {
+                LogicGraph::Gate g = kind == AND ? LogicGraph::Gates::AND : kind == OR ? LogicGraph::Gates::OR : LogicGraph::Gates::PARITY;
+
+                for(unsigned i = 0; i < width; ++i) graph.openOutput(gate(g,{a[i],b[i]}),i);
+                break;
+            }
+
+            case EQUAL:
+            {
+                Key all = graph.addGate(LogicGraph::Gates::AND);
+
+                for(unsigned i = 0; i < width; ++i) graph.connectGates(all,gate(LogicGraph::Gates::XNOR,{a[i],b[i]}));
+
+                graph.openOutput(all,0);
+                break;
+            }
+
+            case LESS:
+            {
+                //From the bottom bit up: where the bits differ B decides, else the lower bits do.
+                Key less = gate(LogicGraph::Gates::AND,{gate(nullptr,{a[0]}),b[0]});
+
+                for(unsigned i = 1; i < width; ++i) less = mux(b[i],less,gate(LogicGraph::Gates::XNOR,{a[i],b[i]}));
+
+                graph.openOutput(less,0);
+                break;
+            }
+
+            case SHIFT_LEFT:
+            case SHIFT_RIGHT:
+            {
+                //A barrel shifter: stage j moves the bits by 2^j where amount bit j is set.
+                std::vector<Key> x(a);
+
+                for(unsigned j = 0; j < b.size(); ++j){
+
+                    Key off = gate(nullptr,{b[j]});
+                    std::vector<Key> next(width);
+
+                    for(unsigned i = 0; i < width; ++i){
+
+                        long long from = kind == SHIFT_LEFT ? (long long)i - (1ll << j) : (long long)i + (1ll << j);
+
+                        next[i] = from < 0 || from >= (long long)width ? gate(LogicGraph::Gates::AND,{x[i],off}) : mux(x[i],x[(size_t)from],b[j]);
+                    }
+
+                    x.swap(next);
+                }
+
+                for(unsigned i = 0; i < width; ++i) graph.openOutput(x[i],i);
+                break;
+            }
+
+            default:
+                for(unsigned i = 0; i < width; ++i) graph.openOutput(mux(a[i],b[i],b[width]),i);
+                break;
+            }
+
+            return graph;
+        }
+
+        Kind kind;
+        unsigned width;
+    };
+
+    const unsigned WordOp::MAX_WIDTH;
+}
+
+#endif//LOGIC_WORD_OP
@@ -0,0 +1,100 @@
+/// A fixed set of worker threads draining a shared task queue.
+#ifndef LOGIC_WORKER_POOL
+#define LOGIC_WORKER_POOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LogicGraph
+{
+    /// <summary>
+    /// Runs queued tasks on a fixed number of threads, first in first out.
+    /// Destroying the pool finishes the tasks already queued, then joins the threads.
+    /// </summary>
+    class WorkerPool
+    {
+    public:
+
+        typedef std::function<void()> Task;
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// <params>
+        /// threadCount: The number of workers; 0 for one per hardware thread.
+        /// </params>
+        explicit WorkerPool(unsigned threadCount = 0)
+        {
+            if(threadCount == 0) threadCount = std::thread::hardware_concurrency();
+            if(threadCount == 0) threadCount = 1;
+
+            stopping = false;
+
+            for(unsigned t = 0; t < threadCount; ++t){
+
+                threads.emplace_back([this]{ work(); });
+            }
+        }
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+
+            wake.notify_all();
+
+            for(auto& t : threads) t.join();
+        }
+
+        unsigned getThreadCount() const
+        {
+            return (unsigned)threads.size();
+        }
+
+        void post(Task task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(task));
+            }
+
+            wake.notify_one();
+        }
+
+    private:
+
+        void work()
+        {
+            for(;;){
+
+                Task task;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock,[this]{ return stopping || !tasks.empty(); });
+
+                    if(tasks.empty()) return;
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::deque<Task> tasks;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping;
+    };
+}
+
+#endif//LOGIC_WORKER_POOL
@@ -0,0 +1,131 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace LogicSharp
+{
+    public unsafe class BatchEvaluator
+    {
+        #region DLL Imports
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        private delegate void BatchCallback(IntPtr user);
+
+        /// <summary>
+        /// Creates a batch evaluator with its own worker threads over a snapshot of the logic graph.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateBatchEvaluator(void* logicGraph,int threadCount);
+
+        /// <summary>
+        /// Destroys the batch evaluator once the batches already submitted are done.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyBatchEvaluator(void* batchEvaluator);
+
+        /// <summary>
+        /// Queues a batch of input vectors and returns at once.
+        /// </summary>
+        /// <returns>
+        /// A handle to the batch, to be released with DestroyBatch.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* submitBatch(void* batchEvaluator,string vectors,int vectorCount,sbyte* results,BatchCallback callback,IntPtr user);
+
+        /// <summary>
+        /// Releases the batch handle. A batch still running finishes, and calls back, regardless.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyBatch(void* batch);
+
+        #endregion
+
+        /// <summary>
+        /// A batch in flight: where its results go and who waits for them.
+        /// </summary>
+        private class Pending
+        {
+            public TaskCompletionSource<sbyte[,]> Source;
+
+            public sbyte[,] Results;
+
+            public GCHandle Pin;
+        }
+
+        //Held for the life of the process so the native side can always call back.
+        private static readonly BatchCallback onBatchDone = batchDone;
+
+        private void* instance;
+
+        private int inputCount;
+
+        private int outputCount;
+
+        /// <summary>
+        /// Creates a batch evaluator over the graph as it is now.
+        /// Later edits to the graph do not reach the evaluator.
+        /// </summary>
+        /// <params>
+        /// threadCount: The number of native workers; 0 for one per hardware thread.
+        /// </params>
+        public BatchEvaluator(LogicGraph logicGraph,int threadCount = 0)
+        {
+            instance = CreateBatchEvaluator(logicGraph.Instance,threadCount);
+            inputCount = logicGraph.InputCount;
+            outputCount = logicGraph.OutputCount;
+        }
+
+        ~BatchEvaluator()
+        {
+            DestroyBatchEvaluator(instance);
+        }
+
+        /// <summary>
+        /// Evaluates the vectors, each a string of '0'/'1' as for LogicGraph.feedInputString,
+        /// on the native workers without blocking the calling thread.
+        /// </summary>
+        /// <returns>
+        /// A task for the outputs, indexed [vector, output], each coded as LogicGraph.getOutput.
+        /// </returns>
+        public Task<sbyte[,]> evaluateAsync(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'0'),0,inputCount);
+                ++count;
+            }
+
+            Pending pending = new Pending();
+            pending.Source = new TaskCompletionSource<sbyte[,]>();
+            pending.Results = new sbyte[count,outputCount];
+            pending.Pin = GCHandle.Alloc(pending.Results,GCHandleType.Pinned);
+
+            GCHandle user = GCHandle.Alloc(pending);
+
+            void* batch = submitBatch(instance,packed.ToString(),count,(sbyte*)pending.Pin.AddrOfPinnedObject(),onBatchDone,GCHandle.ToIntPtr(user));
+
+            DestroyBatch(batch);
+
+            return pending.Source.Task;
+        }
+
+        private static void batchDone(IntPtr user)
+        {
+            GCHandle handle = GCHandle.FromIntPtr(user);
+            Pending pending = (Pending)handle.Target;
+
+            handle.Free();
+            pending.Pin.Free();
+
+            //Continuations run on the managed pool, not on the native worker.
+            ThreadPool.QueueUserWorkItem(state => pending.Source.SetResult(pending.Results));
+        }
+    }
+}
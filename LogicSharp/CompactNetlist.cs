@@ -0,0 +1,94 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class CompactNetlist
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Packs a snapshot of the logic graph into a compact netlist of a few bytes per gate.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateCompactNetlist(void* logicGraph);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyCompactNetlist(void* compactNetlist);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern long simulateCompact(void* compactNetlist,string vectors,long vectorCount,sbyte[,] results);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern long getCompactNodeCount(void* compactNetlist);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern long getCompactByteSize(void* compactNetlist);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        private int outputCount;
+
+        /// <summary>
+        /// Packs the graph as it is now, modules flattened; later edits to the graph do not reach it.
+        /// </summary>
+        public CompactNetlist(LogicGraph logicGraph)
+        {
+            instance = CreateCompactNetlist(logicGraph.Instance);
+            inputCount = logicGraph.InputCount;
+            outputCount = logicGraph.OutputCount;
+        }
+
+        ~CompactNetlist()
+        {
+            DestroyCompactNetlist(instance);
+        }
+
+        /// <summary>
+        /// Simulates the vectors, each a string of '0'/'1' as for LogicGraph.feedInputString.
+        /// </summary>
+        /// <returns>
+        /// The outputs, indexed [vector, output] and coded as LogicGraph.getOutput.
+        /// </returns>
+        public sbyte[,] simulate(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'0'),0,inputCount);
+                ++count;
+            }
+
+            sbyte[,] results = new sbyte[count,outputCount];
+
+            simulateCompact(instance,packed.ToString(),count,results);
+
+            return results;
+        }
+
+        /// <summary>
+        /// The number of nodes, inputs and flattened module gates included.
+        /// </summary>
+        public long NodeCount
+        {
+            get { return getCompactNodeCount(instance); }
+        }
+
+        /// <summary>
+        /// The bytes the netlist takes.
+        /// </summary>
+        public long ByteSize
+        {
+            get { return getCompactByteSize(instance); }
+        }
+    }
+}
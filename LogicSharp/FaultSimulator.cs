@@ -0,0 +1,150 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class FaultSimulator
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a fault simulator over a snapshot of the logic graph.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateFaultSimulator(void* logicGraph);
+
+        /// <summary>
+        /// Destroys the fault simulator.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyFaultSimulator(void* faultSimulator);
+
+        /// <summary>
+        /// Returns the number of faults in the collapsed fault list.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getFaultCount(void* faultSimulator);
+
+        /// <summary>
+        /// Returns the number of faults detected so far.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getDetectedFaultCount(void* faultSimulator);
+
+        /// <summary>
+        /// Returns the detected share of the fault list, 0 to 1.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern double getFaultCoverage(void* faultSimulator);
+
+        /// <summary>
+        /// Simulates the undetected faults against the test vectors.
+        /// </summary>
+        /// <returns>
+        /// The number of faults detected by these vectors.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int simulateFaults(void* faultSimulator,string vectors,int vectorCount);
+
+        /// <summary>
+        /// Describes the indexed fault.
+        /// </summary>
+        /// <returns>
+        ///  1: Detected
+        ///  0: Not detected
+        /// -1: No such fault
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte getFault(void* faultSimulator,int index,out uint gate,out int pin,out int value);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        /// <summary>
+        /// Creates a fault simulator over the graph as it is now.
+        /// Later edits to the graph do not reach the simulator.
+        /// </summary>
+        public FaultSimulator(LogicGraph logicGraph)
+        {
+            instance = CreateFaultSimulator(logicGraph.Instance);
+            inputCount = logicGraph.InputCount;
+        }
+
+        ~FaultSimulator()
+        {
+            DestroyFaultSimulator(instance);
+        }
+
+        /// <summary>
+        /// The number of faults in the collapsed fault list.
+        /// </summary>
+        public int FaultCount
+        {
+            get { return getFaultCount(instance); }
+        }
+
+        /// <summary>
+        /// The number of faults detected so far.
+        /// </summary>
+        public int DetectedCount
+        {
+            get { return getDetectedFaultCount(instance); }
+        }
+
+        /// <summary>
+        /// The detected share of the fault list, 0 to 1.
+        /// </summary>
+        public double Coverage
+        {
+            get { return getFaultCoverage(instance); }
+        }
+
+        /// <summary>
+        /// Simulates the undetected faults against the test vectors,
+        /// each a string of '0'/'1' as for LogicGraph.feedInputString.
+        /// </summary>
+        /// <returns>
+        /// The number of faults detected by these vectors.
+        /// </returns>
+        public int simulate(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'0'),0,inputCount);
+                ++count;
+            }
+
+            return simulateFaults(instance,packed.ToString(),count);
+        }
+
+        /// <summary>
+        /// Describes the indexed fault.
+        /// </summary>
+        /// <params>
+        /// gate: The key of the node the fault sits on.
+        /// pin: -1 for the node's output, else the position of the faulty input in key order.
+        /// value: The stuck-at value.
+        /// </params>
+        /// <returns>
+        ///  1: Detected
+        ///  0: Not detected
+        /// -1: No such fault
+        /// </returns>
+        public sbyte getFault(int index,out uint gate,out int pin,out bool value)
+        {
+            int v;
+            sbyte c = getFault(instance,index,out gate,out pin,out v);
+            value = v != 0;
+            return c;
+        }
+    }
+}
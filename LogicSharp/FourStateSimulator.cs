@@ -0,0 +1,85 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    /// <summary>
+    /// The values of four-state simulation.
+    /// </summary>
+    public enum FourState : sbyte
+    {
+        Zero = 0,
+        One = 1,
+        X = 2,
+        Z = 3,
+        NoOutput = -3
+    }
+
+    public unsafe class FourStateSimulator
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a simulator over 0, 1, X and Z for the graph as it is now.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateFourStateSimulator(void* logicGraph);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyFourStateSimulator(void* fourStateSimulator);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int simulateFourState(void* fourStateSimulator,string vectors,int vectorCount,FourState[,] results);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        private int outputCount;
+
+        /// <summary>
+        /// Compiles the graph as it is now; later edits to the graph do not reach the simulator.
+        /// Nodes with no inputs drive Z, and gates read Z as X.
+        /// </summary>
+        public FourStateSimulator(LogicGraph logicGraph)
+        {
+            instance = CreateFourStateSimulator(logicGraph.Instance);
+            inputCount = logicGraph.InputCount;
+            outputCount = logicGraph.OutputCount;
+        }
+
+        ~FourStateSimulator()
+        {
+            DestroyFourStateSimulator(instance);
+        }
+
+        /// <summary>
+        /// Simulates the vectors, each a string of '0', '1', 'x' and 'z'; missing inputs are Z.
+        /// </summary>
+        /// <returns>
+        /// The outputs, indexed [vector, output].
+        /// </returns>
+        public FourState[,] simulate(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'z'),0,inputCount);
+                ++count;
+            }
+
+            FourState[,] results = new FourState[count,outputCount];
+
+            simulateFourState(instance,packed.ToString(),count,results);
+
+            return results;
+        }
+    }
+}
@@ -0,0 +1,185 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class GraphFork
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a copy-on-write fork of the logic graph.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateGraphFork(void* logicGraph);
+
+        /// <summary>
+        /// Creates a fork of a fork.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* ForkGraphFork(void* graphFork);
+
+        /// <summary>
+        /// Destroys the fork.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyGraphFork(void* graphFork);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint forkAddGate(void* graphFork,int type);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte forkConnectGates(void* graphFork,uint gate,uint input);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte forkDisconnectGates(void* graphFork,uint gate,uint input);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte forkRemoveGate(void* graphFork,uint gate);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte forkReplaceGate(void* graphFork,uint gate,int type);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void forkSetInputVal(void* graphFork,int index,bool value);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void forkOpenOutput(void* graphFork,uint gate,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void forkCloseOutput(void* graphFork,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte forkGetOutput(void* graphFork,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int forkGetEditCount(void* graphFork);
+
+        #endregion
+
+        private void* instance;
+
+        /// <summary>
+        /// Forks the graph as it is now. The fork shares the graph's structure and keeps
+        /// only the nodes it edits; later edits to the graph do not reach it.
+        /// </summary>
+        public GraphFork(LogicGraph logicGraph)
+        {
+            instance = CreateGraphFork(logicGraph.Instance);
+        }
+
+        private GraphFork(void* instance)
+        {
+            this.instance = instance;
+        }
+
+        ~GraphFork()
+        {
+            DestroyGraphFork(instance);
+        }
+
+        /// <summary>
+        /// The number of nodes this fork holds its own copy of.
+        /// </summary>
+        public int EditCount
+        {
+            get { return forkGetEditCount(instance); }
+        }
+
+        /// <summary>
+        /// Returns a fork of this fork; the two share everything but the edits made to either from here on.
+        /// </summary>
+        public GraphFork fork()
+        {
+            return new GraphFork(ForkGraphFork(instance));
+        }
+
+        /// <returns>
+        /// 0: Invalid type.
+        /// Else: The key of the gate added.
+        /// </returns>
+        public uint addGate(GateType type)
+        {
+            return forkAddGate(instance,(int)type);
+        }
+
+        /// <summary>
+        /// Connects two gates.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        ///  1: Input already exists
+        ///  2: Given key is an output
+        ///  3: (for inverter) No room for another input
+        /// -1: (for input) This is an input node, it cannot have an input added
+        /// -3: A key does not exist.
+        /// </returns>
+        public sbyte connectGates(uint gate,uint input)
+        {
+            return forkConnectGates(instance,gate,input);
+        }
+
+        /// <summary>
+        /// Removes an input from the gate.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// -1: Node has no inputs.
+        /// -2: Passed key is not an input.
+        /// -3: A key does not exist.
+        /// </returns>
+        public sbyte disconnectGates(uint gate,uint input)
+        {
+            return forkDisconnectGates(instance,gate,input);
+        }
+
+        /// <returns>
+        /// -3: That key does not exist.
+        ///  0: Success
+        /// </returns>
+        public sbyte removeGate(uint gate)
+        {
+            return forkRemoveGate(instance,gate);
+        }
+
+        /// <summary>
+        /// Changes the function of a gate, keeping its inputs.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// -1: The node is not a gate.
+        /// -3: That key does not exist.
+        /// -4: Invalid type.
+        /// </returns>
+        public sbyte replaceGate(uint gate,GateType type)
+        {
+            return forkReplaceGate(instance,gate,(int)type);
+        }
+
+        public void setInputVal(int index,bool value)
+        {
+            forkSetInputVal(instance,index,value);
+        }
+
+        public void openOutput(uint gate,int index)
+        {
+            forkOpenOutput(instance,gate,index);
+        }
+
+        public void closeOutput(int index)
+        {
+            forkCloseOutput(instance,index);
+        }
+
+        /// <summary>
+        /// Returns the indexed output, coded as LogicGraph.getOutput.
+        /// </summary>
+        public sbyte getOutput(int index)
+        {
+            return forkGetOutput(instance,index);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class InputQueue
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a queue of input updates for the logic graph's inputs.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateInputQueue(void* logicGraph);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyInputQueue(void* inputQueue);
+
+        /// <summary>
+        /// Queues a value for an input without blocking; safe from any thread.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool pushInput(void* inputQueue,int index,bool val);
+
+        /// <summary>
+        /// Sets every input pushed since the last drain to its last pushed value.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int drainInputQueue(void* inputQueue,void* logicGraph);
+
+        #endregion
+
+        private void* instance;
+
+        private LogicGraph logicGraph;
+
+        /// <summary>
+        /// Creates a queue for the graph's inputs. Any thread may push into it without
+        /// taking a lock; the thread that evaluates the graph drains it before evaluating.
+        /// </summary>
+        public InputQueue(LogicGraph logicGraph)
+        {
+            this.logicGraph = logicGraph;
+            instance = CreateInputQueue(logicGraph.Instance);
+        }
+
+        ~InputQueue()
+        {
+            DestroyInputQueue(instance);
+        }
+
+        /// <summary>
+        /// Queues a value for an input; a later push to the same input before the next drain replaces it.
+        /// </summary>
+        /// <returns>
+        /// False if there is no such input.
+        /// </returns>
+        public bool push(int index,bool val)
+        {
+            return pushInput(instance,index,val);
+        }
+
+        /// <summary>
+        /// Sets every input pushed since the last drain to its last pushed value.
+        /// </summary>
+        /// <returns>
+        /// The number of inputs set.
+        /// </returns>
+        public int drain()
+        {
+            return drainInputQueue(instance,logicGraph.Instance);
+        }
+    }
+}
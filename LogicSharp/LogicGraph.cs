@@ -13,9 +13,26 @@ namespace LogicSharp
         Not = 2,
         Nand = 3,
         Nor = 4,
-        Xor = 5
+        Xor = 5,
+        Parity = 6,
+        Xnor = 7,
+        Majority = 8
     }
 
+    /// <summary>
+    /// An output whose value differs from the last one reported for it, coded as LogicGraph.getOutput.
+    /// </summary>
+    public struct OutputChange
+    {
+        public int Index;
+
+        public sbyte OldValue;
+
+        public sbyte NewValue;
+    }
+
+    public delegate void OutputChangedHandler(OutputChange change);
+
     public unsafe class LogicGraph
     {
         #region DLL Imports
@@ -32,6 +49,12 @@ namespace LogicSharp
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
         private static extern void DestroyLogicGraph(void* logicGraph);
 
+        /// <summary>
+        /// Creates a deep copy of the LogicGraph instance.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CloneLogicGraph(void* logicGraph);
+
         /// <summary>
         /// Adds a gate to the logic graph.
         /// </sumary>
@@ -42,7 +65,10 @@ namespace LogicSharp
         /// 2: NOT
         /// 3: NAND
         /// 4: NOR
-        /// 5: XOR
+        /// 5: XOR (exactly one input true)
+        /// 6: PARITY (an odd number of inputs true)
+        /// 7: XNOR (an even number of inputs true)
+        /// 8: MAJORITY (more than half of the inputs true)
         /// </params>
         /// <returns>
         /// 0: Invalid type.
@@ -51,6 +77,24 @@ namespace LogicSharp
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
         private static extern uint addGate(void* logicGraph,int type);
 
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint addThresholdGate(void* logicGraph,int k);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint addMux(void* logicGraph,int selects);
+
+        /// <summary>
+        /// Adds a lookup table node of up to six inputs to the logic graph.
+        /// Bit m of the table is the output when input i, in connection order, is bit i of m.
+        /// </summary>
+        /// <returns>
+        /// The key of the node added.
+        /// </returns>
+        public uint addLut(ulong table)
+        {
+            return addLut(instance,table);
+        }
+
         /// <summary>
         /// Connects two gates.
         /// </summary>
@@ -58,8 +102,9 @@ namespace LogicSharp
         ///  0: Success
         ///  1: Input already exists
         ///  2: Given key is an output
-        ///  3: (for inverter) Already has an input
+        ///  3: (for inverter, lookup table, instance or port) No room for another input
         /// -1: (for input) This is an input node, it cannot have an input added
+        /// -2: The input is a module instance; connect one of its ports instead.
         /// </returns>
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
         private static extern sbyte connectGates(void* logicGraph,uint gate,uint input);
@@ -105,6 +150,27 @@ namespace LogicSharp
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
         private static extern uint createKey(void* logicGraph);
 
+        /// <summary>
+        /// Returns one past the largest key handed out so far.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint getKeyLimit(void* logicGraph);
+
+        /// <summary>
+        /// Renumbers the nodes from 1 with no gaps and rebuilds them in that order.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint compact(void* logicGraph,uint[] remap);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint addInstance(void* logicGraph,void* module);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint getPortKey(void* logicGraph,uint instance,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int flatten(void* logicGraph);
+
         /// <summary>
         /// Sets the value of the indexed input.
         /// </summary>
@@ -136,6 +202,39 @@ namespace LogicSharp
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
         private static extern sbyte getOutput(void* logicGraph,int index);
 
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getSupportSize(void* logicGraph,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getSupport(void* logicGraph,int index,int[] inputs);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getConeSize(void* logicGraph,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool evaluateSlice(void* logicGraph,int nodeBudget,int microseconds);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool isOutputSettled(void* logicGraph,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void setInputWord(void* logicGraph,int first,int width,ulong value);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte getOutputWord(void* logicGraph,int first,int width,out ulong value);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void setResultCacheCapacity(void* logicGraph,int capacity);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool evaluateInputs(void* logicGraph,ulong[] inputs,sbyte[] results);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void getResultCacheStats(void* logicGraph,out ulong hits,out ulong misses);
+
         /// <summary>
         /// Returns the output of the gate based on the inputs.
         /// </summary>
@@ -155,7 +254,7 @@ namespace LogicSharp
         ///  0: Success
         ///  1: Input already exists
         ///  2: Given key is an output
-        ///  3: (for inverter) Already has an input
+        ///  3: (for inverter or lookup table) No room for another input
         /// -1: (for input) This is an input node, it cannot have an input added
         /// </returns>
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
@@ -195,13 +294,105 @@ namespace LogicSharp
         [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
         public static extern sbyte removeConnection(void* logicGraph,uint gate0,uint gate1);
 
+        /// <summary>
+        /// Checks that two logic graphs compute the same outputs for every input.
+        /// </summary>
+        /// <returns>
+        ///  1: Equivalent
+        ///  0: Not equivalent, see the counterexamples.
+        /// -1: Undecided within the conflict budget.
+        /// -2: A map entry is out of range or two inputs of A drive the same input of B.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte equivalent(void* logicGraphA,void* logicGraphB,int[] inputMap,int[] outputMap,StringBuilder counterexampleA,StringBuilder counterexampleB,int conflictBudget);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern uint addLut(void* logicGraph,ulong table);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int mapToLuts(void* logicGraph,int lutSize);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int replaceNode(void* logicGraph,uint old,uint with);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int fraig(void* logicGraph,int rounds,int conflictBudget,out int removed);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern long simulateFile(void* logicGraph,string stimulusPath,string resultPath);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte setGateDelay(void* logicGraph,uint gate,uint rise,uint fall);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        private delegate void OutputChangedCallback(int index,sbyte oldValue,sbyte newValue,IntPtr user);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int applyInputChanges(void* logicGraph,int[] indexes,int[] values,int count,int[] changedIndexes,sbyte[] oldValues,sbyte[] newValues);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int addOutputCallback(void* logicGraph,OutputChangedCallback callback,IntPtr user);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool removeOutputCallback(void* logicGraph,int id);
+
         #endregion
 
         private void* instance;
 
+        private int inputCount;
+
+        private int outputCount;
+
+        //Keeps the delegates handed to the native side alive until they are removed.
+        private Dictionary<int,OutputChangedCallback> callbacks = new Dictionary<int,OutputChangedCallback>();
+
         public LogicGraph(int inputCount,int outputCount)
         {
             instance = CreateLogicGraph(inputCount,outputCount);
+            this.inputCount = inputCount;
+            this.outputCount = outputCount;
+        }
+
+        private LogicGraph(void* instance,int inputCount,int outputCount)
+        {
+            this.instance = instance;
+            this.inputCount = inputCount;
+            this.outputCount = outputCount;
+        }
+
+        /// <summary>
+        /// Returns a deep copy with the same keys, gates, input values and outputs.
+        /// Output callbacks are not copied.
+        /// </summary>
+        public LogicGraph clone()
+        {
+            return new LogicGraph(CloneLogicGraph(instance),inputCount,outputCount);
+        }
+
+        /// <summary>
+        /// The native LogicGraph instance, for the other native wrappers.
+        /// </summary>
+        internal void* Instance
+        {
+            get { return instance; }
+        }
+
+        /// <summary>
+        /// The number of inputs the graph was created with.
+        /// </summary>
+        public int InputCount
+        {
+            get { return inputCount; }
+        }
+
+        /// <summary>
+        /// The number of outputs the graph was created with.
+        /// </summary>
+        public int OutputCount
+        {
+            get { return outputCount; }
         }
 
         ~LogicGraph()
@@ -219,7 +410,10 @@ namespace LogicSharp
         /// 2: NOT
         /// 3: NAND
         /// 4: NOR
-        /// 5: XOR
+        /// 5: XOR (exactly one input true)
+        /// 6: PARITY (an odd number of inputs true)
+        /// 7: XNOR (an even number of inputs true)
+        /// 8: MAJORITY (more than half of the inputs true)
         /// </params>
         /// <returns>
         /// 0: Invalid type.
@@ -230,6 +424,27 @@ namespace LogicSharp
             return addGate(instance,(int)type);
         }
 
+        /// <summary>
+        /// Adds a gate that is true when k or more of its inputs are.
+        /// </summary>
+        public uint addThresholdGate(int k)
+        {
+            return addThresholdGate(instance,k);
+        }
+
+        /// <summary>
+        /// Adds a multiplexer of 1 or 2 select inputs. Connect the 2 or 4 data inputs first,
+        /// then the selects, lowest bit first.
+        /// </summary>
+        /// <returns>
+        /// 0: selects is not 1 or 2.
+        /// Else: The key of the node added.
+        /// </returns>
+        public uint addMux(int selects)
+        {
+            return addMux(instance,selects);
+        }
+
         /// <summary>
         /// Connects two gates.
         /// </summary>
@@ -237,8 +452,9 @@ namespace LogicSharp
         ///  0: Success
         ///  1: Input already exists
         ///  2: Given key is an output
-        ///  3: (for inverter) Already has an input
+        ///  3: (for inverter, lookup table, instance or port) No room for another input
         /// -1: (for input) This is an input node, it cannot have an input added
+        /// -2: The input is a module instance; connect one of its ports instead.
         /// </returns>
         public sbyte connectGates(uint gate, uint input)
         {
@@ -278,6 +494,19 @@ namespace LogicSharp
             return removeGate(instance,gate);
         }
 
+        /// <summary>
+        /// Sets the time the gate takes to switch to true and to false, for timing simulation.
+        /// Gates start with both at 1.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// -3: That key does not exist.
+        /// </returns>
+        public sbyte setGateDelay(uint gate,uint rise,uint fall)
+        {
+            return setGateDelay(instance,gate,rise,fall);
+        }
+
         /// <summary>
         /// Gets the key of the indexed input gate.
         /// </summary>
@@ -294,6 +523,55 @@ namespace LogicSharp
             return createKey(instance);
         }
 
+        /// <summary>
+        /// Renumbers the nodes from 1 with no gaps: the inputs, then each output's cone depth
+        /// first with every node after its inputs, then the rest. Nodes are rebuilt in that
+        /// order so nodes that feed each other sit together in memory.
+        /// </summary>
+        /// <returns>
+        /// The new key of every old key, indexed by old key; 0 for keys with no node.
+        /// </returns>
+        public uint[] compact()
+        {
+            uint[] remap = new uint[getKeyLimit(instance)];
+
+            compact(instance,remap);
+
+            return remap;
+        }
+
+        /// <summary>
+        /// Adds an instance of the module, and a port node for each of its outputs. Connect the
+        /// module's inputs to the instance in order, and read its outputs from the ports.
+        /// </summary>
+        /// <returns>
+        /// The key of the instance.
+        /// </returns>
+        public uint addInstance(Module module)
+        {
+            return addInstance(instance,module.Instance);
+        }
+
+        /// <summary>
+        /// Returns the key of the port reading the indexed output of an instance, or 0 if there is none.
+        /// </summary>
+        public uint getPortKey(uint instance,int index)
+        {
+            return getPortKey(this.instance,instance,index);
+        }
+
+        /// <summary>
+        /// Replaces every instance whose inputs are all connected by a copy of its module's gates.
+        /// Ports keep their keys.
+        /// </summary>
+        /// <returns>
+        /// The number of instances replaced.
+        /// </returns>
+        public int flatten()
+        {
+            return flatten(instance);
+        }
+
         /// <summary>
         /// Sets the value of the indexed input.
         /// </summary>
@@ -333,6 +611,126 @@ namespace LogicSharp
             return getOutput(instance,index);
         }
 
+        /// <summary>
+        /// Returns the indexes of the inputs the output is connected to through any path, in
+        /// ascending order; none for a closed output. Setting any other input leaves the output as it is.
+        /// </summary>
+        public int[] getSupport(int index)
+        {
+            int[] inputs = new int[getSupportSize(instance,index)];
+
+            getSupport(instance,index,inputs);
+
+            return inputs;
+        }
+
+        /// <summary>
+        /// Returns the number of nodes the output depends on, itself and its support included.
+        /// </summary>
+        public int getConeSize(int index)
+        {
+            return getConeSize(instance,index);
+        }
+
+        /// <summary>
+        /// Works towards the value of every open output for a limited time, picking up where the
+        /// last call stopped, so a large evaluation can be spread over frames of a UI thread.
+        /// </summary>
+        /// <params>
+        /// nodeBudget: Nodes to evaluate at most; 0 for no limit.
+        /// microseconds: Time to spend at most; 0 for no limit.
+        /// </params>
+        /// <returns>
+        /// Whether every open output is settled.
+        /// </returns>
+        public bool evaluateSlice(int nodeBudget,int microseconds)
+        {
+            return evaluateSlice(instance,nodeBudget,microseconds);
+        }
+
+        /// <summary>
+        /// Whether the indexed output is closed or its value is known, so getOutput returns at once.
+        /// </summary>
+        public bool isSettled(int index)
+        {
+            return isOutputSettled(instance,index);
+        }
+
+        /// <summary>
+        /// Sets width inputs from first on to the bits of value, lowest bit first.
+        /// </summary>
+        public void setInputWord(int first,int width,ulong value)
+        {
+            setInputWord(instance,first,width,value);
+        }
+
+        /// <summary>
+        /// Reads width outputs from first on into the bits of value, lowest bit first.
+        /// </summary>
+        /// <returns>
+        ///  0: Success
+        /// Else: The error of the first output that has one, as getOutput.
+        /// </returns>
+        public sbyte getOutputWord(int first,int width,out ulong value)
+        {
+            return getOutputWord(instance,first,width,out value);
+        }
+
+        /// <summary>
+        /// Keeps the outputs of up to capacity input vectors passed to evaluate, dropping the
+        /// least recently used first; 0, the default, keeps none. Empties the cache and its counts.
+        /// </summary>
+        public void setResultCacheCapacity(int capacity)
+        {
+            setResultCacheCapacity(instance,capacity);
+        }
+
+        /// <summary>
+        /// Sets the inputs to a vector and reads every output, or answers from the result cache
+        /// without touching the graph if the vector is there. Editing the graph, or opening or
+        /// closing an output, empties the cache.
+        /// </summary>
+        /// <params>
+        /// inputs: (InputCount + 63) / 64 words, input i in bit i % 64 of word i / 64.
+        /// </params>
+        /// <returns>
+        /// Each output, coded as getOutput.
+        /// </returns>
+        public sbyte[] evaluate(ulong[] inputs)
+        {
+            sbyte[] results = new sbyte[outputCount];
+
+            evaluateInputs(instance,inputs,results);
+
+            return results;
+        }
+
+        /// <summary>
+        /// The number of vectors evaluate answered from the result cache.
+        /// </summary>
+        public ulong ResultCacheHits
+        {
+            get
+            {
+                ulong hits,misses;
+                getResultCacheStats(instance,out hits,out misses);
+                return hits;
+            }
+        }
+
+        /// <summary>
+        /// The number of vectors evaluate looked for in the result cache and had to simulate.
+        /// </summary>
+        public ulong ResultCacheMisses
+        {
+            get
+            {
+                ulong hits,misses;
+                getResultCacheStats(instance,out hits,out misses);
+                return misses;
+            }
+        }
+
         /// <summary>
         /// Returns the output of the gate based on the inputs.
         /// </summary>
@@ -354,7 +752,7 @@ namespace LogicSharp
         ///  0: Success
         ///  1: Input already exists
         ///  2: Given key is an output
-        ///  3: (for inverter) Already has an input
+        ///  3: (for inverter or lookup table) No room for another input
         /// -1: (for input) This is an input node, it cannot have an input added
         /// </returns>
         public sbyte inputToGate(uint gate,int index)
@@ -412,5 +810,169 @@ namespace LogicSharp
                     value: input[i] == '1');
             }
         }
+
+        /// <summary>
+        /// Checks that two logic graphs compute the same outputs for every input.
+        /// </summary>
+        /// <params>
+        /// inputMap: For each input of a, the input of b it drives, or -1. Inputs of b left out are free.
+        /// outputMap: For each output of a, the output of b that must match it, or -1 to skip it.
+        /// counterexampleA: On a difference, an input string of a (as feedInputString) that shows it.
+        /// counterexampleB: The matching input string of b.
+        /// conflictBudget: Conflicts the solver may spend on each output pair; negative for no limit.
+        /// </params>
+        /// <returns>
+        ///  1: Equivalent
+        ///  0: Not equivalent, see the counterexamples.
+        /// -1: Undecided within the conflict budget.
+        /// -2: A map entry is out of range or two inputs of a drive the same input of b.
+        /// </returns>
+        public static sbyte equivalent(LogicGraph a,LogicGraph b,int[] inputMap,int[] outputMap,out string counterexampleA,out string counterexampleB,int conflictBudget = -1)
+        {
+            if(inputMap.Length != a.inputCount || outputMap.Length != a.outputCount)
+            {
+                throw new ArgumentException("The maps must cover every input and output of a.");
+            }
+
+            StringBuilder counterA = new StringBuilder(a.inputCount + 1);
+            StringBuilder counterB = new StringBuilder(b.inputCount + 1);
+
+            sbyte c = equivalent(a.instance,b.instance,inputMap,outputMap,counterA,counterB,conflictBudget);
+
+            counterexampleA = c == 0 ? counterA.ToString() : null;
+            counterexampleB = c == 0 ? counterB.ToString() : null;
+
+            return c;
+        }
+
+        /// <summary>
+        /// Maps the graph in place onto lookup table nodes of at most lutSize inputs.
+        /// Gates bound to an output keep their keys; gates absorbed into a table are removed.
+        /// </summary>
+        /// <returns>
+        /// -1: The table size is not 1 to 6.
+        /// Else: The number of lookup table nodes in the graph.
+        /// </returns>
+        public int mapToLuts(int lutSize = 6)
+        {
+            return mapToLuts(instance,lutSize);
+        }
+
+        /// <summary>
+        /// Moves every node reading the old node, and every output bound to it, over to the new one,
+        /// then removes the old node and the part of its cone nothing reads any more.
+        /// </summary>
+        /// <returns>
+        /// -1: A node reading old reads with already.
+        /// -2: with is fed by old, so moving its readers would close a loop.
+        /// -3: A key does not exist, old is an input or an instance, with is an instance, or the two are the same.
+        /// Else: The number of nodes removed.
+        /// </returns>
+        public int replaceNode(uint old,uint with)
+        {
+            return replaceNode(instance,old,with);
+        }
+
+        /// <summary>
+        /// Merges the nodes that compute the same function: random simulation picks the
+        /// candidates and the SAT solver proves each before it is merged.
+        /// Instances are flattened first.
+        /// </summary>
+        /// <params>
+        /// rounds: Simulation rounds of 64 patterns.
+        /// conflictBudget: Conflicts the solver may spend on each candidate; negative for no limit.
+        /// removed: The number of nodes removed, the merged ones included.
+        /// </params>
+        /// <returns>
+        /// The number of nodes merged into another.
+        /// </returns>
+        public int fraig(out int removed,int rounds = 4,int conflictBudget = 1000)
+        {
+            return fraig(instance,rounds,conflictBudget,out removed);
+        }
+
+        /// <summary>
+        /// Streams every vector of a stimulus file through the graph into a result file.
+        /// </summary>
+        /// <params>
+        /// stimulusPath: One vector per line as for feedInputString, or (InputCount + 7) / 8 bytes per vector
+        /// with input i in bit i % 8 of byte i / 8.
+        /// resultPath: Receives (OutputCount + 7) / 8 bytes per vector, output o in bit o % 8 of byte o / 8.
+        /// Outputs that are closed or report an error read 0.
+        /// </params>
+        /// <returns>
+        /// -1: The stimulus file could not be opened.
+        /// -2: The result file could not be written.
+        /// Else: The number of vectors simulated.
+        /// </returns>
+        public long simulateFile(string stimulusPath,string resultPath)
+        {
+            return simulateFile(instance,stimulusPath,resultPath);
+        }
+
+        /// <summary>
+        /// Sets the inputs, then returns the outputs whose values differ from the last ones reported.
+        /// Only the outputs the changes propagated to are read. Outputs opened, closed or rewired
+        /// since the last report count as well; an output never reported before had the value -3.
+        /// </summary>
+        public OutputChange[] applyInputChanges(int[] indexes,bool[] values)
+        {
+            if(indexes.Length != values.Length)
+            {
+                throw new ArgumentException("Every input index needs a value.");
+            }
+
+            int[] changedIndexes = new int[outputCount];
+            sbyte[] oldValues = new sbyte[outputCount];
+            sbyte[] newValues = new sbyte[outputCount];
+
+            int count = applyInputChanges(instance,indexes,values.Select(v => v ? 1 : 0).ToArray(),indexes.Length,changedIndexes,oldValues,newValues);
+
+            OutputChange[] changed = new OutputChange[count];
+
+            for(int i = 0; i < count; ++i)
+            {
+                changed[i].Index = changedIndexes[i];
+                changed[i].OldValue = oldValues[i];
+                changed[i].NewValue = newValues[i];
+            }
+
+            return changed;
+        }
+
+        /// <summary>
+        /// Registers a handler for each change applyInputChanges reports.
+        /// The handler must not edit the graph.
+        /// </summary>
+        /// <returns>
+        /// The id to remove the handler with.
+        /// </returns>
+        public int addOutputCallback(OutputChangedHandler handler)
+        {
+            OutputChangedCallback callback = (index,oldValue,newValue,user) =>
+            {
+                OutputChange change;
+                change.Index = index;
+                change.OldValue = oldValue;
+                change.NewValue = newValue;
+                handler(change);
+            };
+
+            int id = addOutputCallback(instance,callback,IntPtr.Zero);
+
+            callbacks[id] = callback;
+
+            return id;
+        }
+
+        /// <returns>
+        /// Whether a handler had that id.
+        /// </returns>
+        public bool removeOutputCallback(int id)
+        {
+            callbacks.Remove(id);
+
+            return removeOutputCallback(instance,id);
+        }
     }
 }
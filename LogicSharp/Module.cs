@@ -0,0 +1,109 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    /// <summary>
+    /// The operation of a word-level datapath cell, with its inputs and outputs, each width bits unless noted.
+    /// </summary>
+    public enum WordOp
+    {
+        Add = 0,            //A, B -> A + B, then the carry out (1 bit)
+        Sub = 1,            //A, B -> A - B, then the borrow out (1 bit)
+        And = 2,            //A, B -> A & B
+        Or = 3,             //A, B -> A | B
+        Xor = 4,            //A, B -> A ^ B
+        Equal = 5,          //A, B -> A == B (1 bit)
+        Less = 6,           //A, B -> A < B unsigned (1 bit)
+        ShiftLeft = 7,      //A, amount (enough bits for width - 1) -> A << amount
+        ShiftRight = 8,     //A, amount (enough bits for width - 1) -> A >> amount
+        Mux = 9             //A, B, select (1 bit) -> select ? B : A
+    }
+
+    /// <summary>
+    /// A circuit defined once by a logic graph and added to graphs any number of times
+    /// with LogicGraph.addInstance; every instance shares the module's gates.
+    /// </summary>
+    public unsafe class Module
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a module from the graph; the module keeps its own copy.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateModule(void* logicGraph);
+
+        /// <summary>
+        /// Releases the module; instances keep it alive as long as they need it.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyModule(void* module);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getModuleInputCount(void* module);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getModuleOutputCount(void* module);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateWordModule(int kind,int width);
+
+        #endregion
+
+        private void* instance;
+
+        /// <summary>
+        /// Makes a module of the graph as it is now: its inputs and outputs become the module's.
+        /// </summary>
+        public Module(LogicGraph definition)
+        {
+            instance = CreateModule(definition.Instance);
+        }
+
+        private Module(void* instance)
+        {
+            this.instance = instance;
+        }
+
+        /// <summary>
+        /// Makes a word-level datapath cell of 1 to 64 bits, which graphs evaluate on native integers.
+        /// Connect an instance's inputs operand A first, least significant bit first; its ports
+        /// give the result bits, then the carry or borrow.
+        /// </summary>
+        public static Module word(WordOp kind,int width)
+        {
+            void* instance = CreateWordModule((int)kind,width);
+
+            if(instance == null) throw new ArgumentOutOfRangeException("width");
+
+            return new Module(instance);
+        }
+
+        ~Module()
+        {
+            DestroyModule(instance);
+        }
+
+        /// <summary>
+        /// The native module, for LogicGraph.addInstance.
+        /// </summary>
+        internal void* Instance
+        {
+            get { return instance; }
+        }
+
+        public int InputCount
+        {
+            get { return getModuleInputCount(instance); }
+        }
+
+        public int OutputCount
+        {
+            get { return getModuleOutputCount(instance); }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class OutputSolver
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates an output solver over a snapshot of the logic graph.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateOutputSolver(void* logicGraph);
+
+        /// <summary>
+        /// Destroys the output solver.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyOutputSolver(void* outputSolver);
+
+        /// <summary>
+        /// Looks for inputs that give the indexed output the value.
+        /// </summary>
+        /// <returns>
+        ///  1: Found, see inputs.
+        ///  0: No input vector gives the output that value.
+        /// -1: No inputs (from Node.output)
+        /// -3: An output does not exist.
+        /// -4: Undecided within the conflict budget.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern sbyte solveOutput(void* outputSolver,int index,bool value,string assumptions,StringBuilder inputs,int conflictBudget);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        /// <summary>
+        /// Creates an output solver over the graph as it is now.
+        /// Later edits to the graph do not reach the solver.
+        /// </summary>
+        public OutputSolver(LogicGraph logicGraph)
+        {
+            instance = CreateOutputSolver(logicGraph.Instance);
+            inputCount = logicGraph.InputCount;
+        }
+
+        ~OutputSolver()
+        {
+            DestroyOutputSolver(instance);
+        }
+
+        /// <summary>
+        /// Looks for inputs that give the indexed output the value.
+        /// What the solver learns is kept for the next query.
+        /// </summary>
+        /// <params>
+        /// assumptions: Null, or one character per input: '0' or '1' holds the input at that value
+        /// for this query, anything else leaves it free.
+        /// inputs: On success, the input string (as feedInputString) that gives the output the value.
+        /// conflictBudget: Conflicts the solver may spend; negative for no limit.
+        /// </params>
+        /// <returns>
+        ///  1: Found, see inputs.
+        ///  0: No input vector gives the output that value.
+        /// -1: No inputs (from Node.output)
+        /// -3: An output does not exist.
+        /// -4: Undecided within the conflict budget.
+        /// </returns>
+        public sbyte solve(int index,bool value,string assumptions,out string inputs,int conflictBudget = -1)
+        {
+            if(assumptions != null && assumptions.Length < inputCount)
+            {
+                assumptions = assumptions.PadRight(inputCount,'-');
+            }
+
+            StringBuilder found = new StringBuilder(inputCount + 1);
+
+            sbyte c = solveOutput(instance,index,value,assumptions,found,conflictBudget);
+
+            inputs = c == 1 ? found.ToString() : null;
+
+            return c;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class SelfTester
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a self-tester for the graph: LFSR patterns in, MISR signature out.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateSelfTester(void* logicGraph,int lfsrWidth,ulong lfsrTaps,ulong seed,int misrWidth,ulong misrTaps);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroySelfTester(void* selfTester);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong runSelfTest(void* selfTester,ulong patternCount);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong getSelfTestPatternCount(void* selfTester);
+
+        #endregion
+
+        private void* instance;
+
+        /// <summary>
+        /// Compiles the graph as it is now; later edits to the graph do not reach the tester.
+        /// Input i of pattern t is bit t + i of the LFSR stream; output o feeds MISR bit o mod misrWidth.
+        /// </summary>
+        /// <params>
+        /// lfsrWidth, misrWidth: 1 to 64.
+        /// lfsrTaps, misrTaps: Bit j stands for the x^j term of the polynomial; 0 takes x^32 + x^22 + x^2 + x + 1.
+        /// seed: The first lfsrWidth bits of the pattern stream; must not be 0.
+        /// </params>
+        public SelfTester(LogicGraph logicGraph,int lfsrWidth = 32,ulong lfsrTaps = 0,ulong seed = 1,int misrWidth = 32,ulong misrTaps = 0)
+        {
+            instance = CreateSelfTester(logicGraph.Instance,lfsrWidth,lfsrTaps,seed,misrWidth,misrTaps);
+        }
+
+        ~SelfTester()
+        {
+            DestroySelfTester(instance);
+        }
+
+        /// <summary>
+        /// Applies the next patterns, continuing from the last run.
+        /// </summary>
+        /// <returns>
+        /// The signature after the last pattern.
+        /// </returns>
+        public ulong run(ulong patternCount)
+        {
+            return runSelfTest(instance,patternCount);
+        }
+
+        /// <summary>
+        /// The number of patterns applied so far.
+        /// </summary>
+        public ulong PatternCount
+        {
+            get { return getSelfTestPatternCount(instance); }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class ShardedSimulator
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Cuts a snapshot of the logic graph into shards and starts a worker process for each.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateShardedSimulator(void* logicGraph,int shardCount);
+
+        /// <summary>
+        /// Stops the worker processes and destroys the sharded simulator.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyShardedSimulator(void* shardedSimulator);
+
+        /// <returns>
+        /// -1: The workers are not running, or one of them stopped answering; they are shut down.
+        /// Else: The number of vectors simulated.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern long simulateSharded(void* shardedSimulator,string vectors,int vectorCount,sbyte[,] results);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getShardCount(void* shardedSimulator);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getShardCutCount(void* shardedSimulator);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        private int outputCount;
+
+        /// <summary>
+        /// Cuts the graph as it is now into shards with few edges between them, each simulated
+        /// by its own worker process. Later edits to the graph do not reach the simulator.
+        /// Workers only run on POSIX systems.
+        /// </summary>
+        public ShardedSimulator(LogicGraph logicGraph,int shardCount)
+        {
+            instance = CreateShardedSimulator(logicGraph.Instance,shardCount);
+            inputCount = logicGraph.InputCount;
+            outputCount = logicGraph.OutputCount;
+        }
+
+        ~ShardedSimulator()
+        {
+            DestroyShardedSimulator(instance);
+        }
+
+        /// <summary>
+        /// The number of shards the graph was cut into.
+        /// </summary>
+        public int ShardCount
+        {
+            get { return getShardCount(instance); }
+        }
+
+        /// <summary>
+        /// The number of edges between gates of different shards.
+        /// </summary>
+        public int CutCount
+        {
+            get { return getShardCutCount(instance); }
+        }
+
+        /// <summary>
+        /// Simulates the vectors, each a string of '0'/'1' as for LogicGraph.feedInputString.
+        /// </summary>
+        /// <returns>
+        /// The outputs, indexed [vector, output], each coded as LogicGraph.getOutput,
+        /// or null if the workers are not running.
+        /// </returns>
+        public sbyte[,] simulate(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'0'),0,inputCount);
+                ++count;
+            }
+
+            sbyte[,] results = new sbyte[count,outputCount];
+
+            if(simulateSharded(instance,packed.ToString(),count,results) < 0) return null;
+
+            return results;
+        }
+    }
+}
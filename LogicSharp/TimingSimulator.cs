@@ -0,0 +1,140 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class TimingSimulator
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a timing simulator over a snapshot of the logic graph and its gate delays.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateTimingSimulator(void* logicGraph);
+
+        /// <summary>
+        /// Destroys the timing simulator.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyTimingSimulator(void* timingSimulator);
+
+        /// <summary>
+        /// Applies the vectors in order, each once the previous one has settled.
+        /// </summary>
+        /// <returns>
+        /// The longest time any of the vectors took to settle.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong simulateTiming(void* timingSimulator,string vectors,int vectorCount);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong getGlitchCount(void* timingSimulator,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong getSettleTime(void* timingSimulator,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong getEventCount(void* timingSimulator);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getWaveformLength(void* timingSimulator,int index);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void getWaveform(void* timingSimulator,int index,ulong[] times,sbyte[] values);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void clearWaveforms(void* timingSimulator);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        /// <summary>
+        /// Creates a timing simulator over the graph and its gate delays as they are now,
+        /// settled on all-zero inputs. Later edits to the graph do not reach the simulator.
+        /// </summary>
+        public TimingSimulator(LogicGraph logicGraph)
+        {
+            instance = CreateTimingSimulator(logicGraph.Instance);
+            inputCount = logicGraph.InputCount;
+        }
+
+        ~TimingSimulator()
+        {
+            DestroyTimingSimulator(instance);
+        }
+
+        /// <summary>
+        /// The number of switches simulated so far.
+        /// </summary>
+        public ulong EventCount
+        {
+            get { return getEventCount(instance); }
+        }
+
+        /// <summary>
+        /// Applies the vectors in order, each a string of '0'/'1' as for LogicGraph.feedInputString,
+        /// and each once the previous one has settled.
+        /// </summary>
+        /// <returns>
+        /// The longest time any of the vectors took to settle.
+        /// </returns>
+        public ulong simulate(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'0'),0,inputCount);
+                ++count;
+            }
+
+            return simulateTiming(instance,packed.ToString(),count);
+        }
+
+        /// <summary>
+        /// Returns the number of pulses on the indexed output that came and went within one vector.
+        /// </summary>
+        public ulong getGlitchCount(int index)
+        {
+            return getGlitchCount(instance,index);
+        }
+
+        /// <summary>
+        /// Returns the longest time the indexed output took to settle after a vector was applied.
+        /// </summary>
+        public ulong getSettleTime(int index)
+        {
+            return getSettleTime(instance,index);
+        }
+
+        /// <summary>
+        /// Returns the switches of the indexed output: when each happened and the value switched to.
+        /// </summary>
+        public KeyValuePair<ulong,bool>[] getWaveform(int index)
+        {
+            int length = getWaveformLength(instance,index);
+            ulong[] times = new ulong[length];
+            sbyte[] values = new sbyte[length];
+
+            getWaveform(instance,index,times,values);
+
+            return times.Select((t,i) => new KeyValuePair<ulong,bool>(t,values[i] != 0)).ToArray();
+        }
+
+        /// <summary>
+        /// Empties every waveform; glitch counts and settle times are kept.
+        /// </summary>
+        public void clearWaveforms()
+        {
+            clearWaveforms(instance);
+        }
+    }
+}
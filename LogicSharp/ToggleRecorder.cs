@@ -0,0 +1,121 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    public unsafe class ToggleRecorder
+    {
+        #region DLL Imports
+
+        /// <summary>
+        /// Creates a toggle recorder over a snapshot of the logic graph.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void* CreateToggleRecorder(void* logicGraph);
+
+        /// <summary>
+        /// Destroys the toggle recorder.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void DestroyToggleRecorder(void* toggleRecorder);
+
+        /// <summary>
+        /// Simulates the vectors in order, counting every node's changes of value.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void recordToggles(void* toggleRecorder,string vectors,int vectorCount);
+
+        /// <summary>
+        /// Forgets the counts and the last vector.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void resetToggles(void* toggleRecorder);
+
+        /// <summary>
+        /// Returns the number of nodes counted, inputs included.
+        /// </summary>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern int getToggleNodeCount(void* toggleRecorder);
+
+        /// <summary>
+        /// Exports the node to toggle count table.
+        /// </summary>
+        /// <returns>
+        /// The number of vectors recorded.
+        /// </returns>
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern ulong getToggleCounts(void* toggleRecorder,uint[] keys,ulong[] counts);
+
+        #endregion
+
+        private void* instance;
+
+        private int inputCount;
+
+        /// <summary>
+        /// Creates a toggle recorder over the graph as it is now.
+        /// Later edits to the graph do not reach the recorder.
+        /// </summary>
+        public ToggleRecorder(LogicGraph logicGraph)
+        {
+            instance = CreateToggleRecorder(logicGraph.Instance);
+            inputCount = logicGraph.InputCount;
+        }
+
+        ~ToggleRecorder()
+        {
+            DestroyToggleRecorder(instance);
+        }
+
+        /// <summary>
+        /// Simulates the vectors in order, each a string of '0'/'1' as for LogicGraph.feedInputString,
+        /// counting every node's changes of value from one vector to the next.
+        /// The first vector follows on from the last vector of the previous call.
+        /// </summary>
+        public void simulate(IEnumerable<string> vectors)
+        {
+            StringBuilder packed = new StringBuilder();
+            int count = 0;
+
+            foreach(string vector in vectors)
+            {
+                packed.Append(vector.PadRight(inputCount,'0'),0,inputCount);
+                ++count;
+            }
+
+            recordToggles(instance,packed.ToString(),count);
+        }
+
+        /// <summary>
+        /// Forgets the counts and the last vector.
+        /// </summary>
+        public void reset()
+        {
+            resetToggles(instance);
+        }
+
+        /// <summary>
+        /// Returns every node's toggle count by key, inputs included.
+        /// </summary>
+        public Dictionary<uint,ulong> getToggleCounts(out ulong vectorCount)
+        {
+            int nodes = getToggleNodeCount(instance);
+            uint[] keys = new uint[nodes];
+            ulong[] counts = new ulong[nodes];
+
+            vectorCount = getToggleCounts(instance,keys,counts);
+
+            Dictionary<uint,ulong> table = new Dictionary<uint,ulong>(nodes);
+
+            for(int n = 0; n < nodes; ++n)
+            {
+                table[keys[n]] = counts[n];
+            }
+
+            return table;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace LogicSharp
+{
+    /// <summary>
+    /// Timeline tracing of graph operations on every thread, exported as Chrome trace JSON.
+    /// </summary>
+    public static class Tracer
+    {
+        #region DLL Imports
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void setTracing(bool enabled);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void setTraceCapacity(int capacity);
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern void clearTrace();
+
+        [DllImport("LogicGraph.dll",CallingConvention = CallingConvention.Cdecl)]
+        private static extern long exportTrace(string path);
+
+        #endregion
+
+        /// <summary>
+        /// Turns tracing on or off; while off, operations record nothing and cost next to nothing more.
+        /// </summary>
+        public static void enable(bool enabled)
+        {
+            setTracing(enabled);
+        }
+
+        /// <summary>
+        /// Sets the events each thread keeps, the latest once its buffer is full.
+        /// </summary>
+        public static void setCapacity(int capacity)
+        {
+            setTraceCapacity(capacity);
+        }
+
+        /// <summary>
+        /// Drops every recorded event.
+        /// </summary>
+        public static void clear()
+        {
+            clearTrace();
+        }
+
+        /// <summary>
+        /// Writes the recorded events to a file that chrome://tracing and Perfetto open.
+        /// </summary>
+        /// <returns>
+        /// -1: The file could not be written.
+        /// Else: The number of events written.
+        /// </returns>
+        public static long export(string path)
+        {
+            return exportTrace(path);
+        }
+    }
+}
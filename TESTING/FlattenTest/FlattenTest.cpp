@@ -0,0 +1,137 @@
+// FlattenTest.cpp : Checks that flattening a graph, and compiling it to a netlist, keep the value of
+// every output, errors included, on random graphs of gates and module instances.
+#include "../../LogicGraph/WordOp.h"
+#include <iostream>
+#include <random>
+#include <vector>
+
+typedef LogicGraph::LogicGraph Graph;
+typedef Graph::Key Key;
+
+/// <summary>
+/// Builds a module of a few gates over four inputs, with an output per gate.
+/// </summary>
+static std::shared_ptr<const LogicGraph::Module> buildModule()
+{
+    Graph m(4,3);
+    Key a = m.addGate(Graph::Gates::AND);
+    Key o = m.addGate(Graph::Gates::OR);
+    Key x = m.addGate(Graph::Gates::XOR);
+
+    m.connectGates(a,m.getInputKey(0));
+    m.connectGates(a,m.getInputKey(1));
+    m.connectGates(o,m.getInputKey(2));
+    m.connectGates(o,m.getInputKey(3));
+    m.connectGates(x,a);
+    m.connectGates(x,m.getInputKey(3));
+
+    m.openOutput(a,0);
+    m.openOutput(o,1);
+    m.openOutput(x,2);
+
+    return std::make_shared<const LogicGraph::Module>(m);
+}
+
+/// <summary>
+/// Builds a random graph of gates and instances. In every other graph a gate left without
+/// inputs reads -1 and feeds some of the others, and some instances miss an input, so errors
+/// reach part of the graph.
+/// </summary>
+static Graph buildRandom(unsigned seed,std::shared_ptr<const LogicGraph::Module> sub,std::shared_ptr<const LogicGraph::WordOp> word)
+{
+    const unsigned in = 4,out = 4;
+    Graph g(in,out);
+    std::mt19937 r(seed);
+    std::vector<Key> ks;
+
+    for(unsigned i = 0; i < in; ++i) ks.push_back(g.getInputKey(i));
+
+    if(seed % 2 == 0) ks.push_back(g.addGate(Graph::Gates::AND));
+
+    for(unsigned j = 0; j < 16; ++j){
+
+        if(r() % 3 != 0){
+
+            Key k = r() % 2 ? g.addGate(Graph::Gates::OR) : g.addGate(Graph::Gates::XOR);
+
+            for(int q = 0; q < 2; ++q) g.connectGates(k,ks[r() % ks.size()]);
+
+            ks.push_back(k);
+            continue;
+        }
+
+        std::shared_ptr<const Graph::ModuleBody> module = r() % 2 ? std::shared_ptr<const Graph::ModuleBody>(sub) : word;
+        Key i = g.addInstance(module);
+        unsigned connected = r() % 8 == 0 ? module->getInputCount() - 1 : module->getInputCount();
+
+        //Buffered, as an instance reads each node once.
+        for(unsigned q = 0; q < connected; ++q){
+
+            Key b = g.addGate(Graph::Gates::OR);
+            g.connectGates(b,ks[r() % ks.size()]);
+            g.connectGates(i,b);
+        }
+
+        for(unsigned p = 0; p < module->getOutputCount(); ++p) ks.push_back(g.getPortKey(i,p));
+    }
+
+    for(unsigned o = 0; o < out; ++o) g.openOutput(ks[ks.size() - 1 - r() % 8],o);
+
+    return g;
+}
+
+/// <returns>
+/// True if the graph, its flattened clone and its netlist agreed on every output of every vector.
+/// </returns>
+static bool testFlatten()
+{
+    std::cout << "FLATTEN TEST\n\n";
+
+    auto sub = buildModule();
+    auto word = std::make_shared<const LogicGraph::WordOp>(LogicGraph::WordOp::ADD,2);
+    unsigned mismatches = 0,errors = 0;
+
+    for(unsigned seed = 0; seed < 500; ++seed){
+
+        Graph g = buildRandom(seed,sub,word);
+        Graph flat = g.clone();
+        LogicGraph::Netlist netlist(g);
+        std::vector<LogicGraph::Netlist::Word> words(g.getInputCount()),values(netlist.size());
+
+        flat.flatten();
+
+        for(unsigned v = 0; v < (1u << g.getInputCount()); ++v){
+
+            for(unsigned i = 0; i < g.getInputCount(); ++i){
+
+                g.setInputVal(i,((v >> i) & 1) != 0);
+                flat.setInputVal(i,((v >> i) & 1) != 0);
+                words[i] = (v >> i) & 1;
+            }
+
+            netlist.simulate(words.data(),values.data());
+
+            for(unsigned o = 0; o < g.getOutputCount(); ++o){
+
+                Graph::SByte want = g.getOutput(o);
+
+                if(want < 0) ++errors;
+
+                if(flat.getOutput(o) != want || netlist.getOutput(o,values.data(),0) != want){
+
+                    if(++mismatches <= 5) std::cout << "seed " << seed << " vector " << v << " output " << o << " differs\n";
+                }
+            }
+        }
+    }
+
+    std::cout << "mismatches: " << mismatches << " (outputs in error: " << errors << ")\n";
+    std::cout << (mismatches == 0 ? "PASS" : "FAIL") << "\n\n";
+
+    return mismatches == 0;
+}
+
+int main()
+{
+    return testFlatten() ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+// HotPathTest.cpp : Checks that setting inputs and reading outputs allocates nothing once the graph
+// is warm, then measures how the hot path scales with threads each driving a graph of its own.
+#include "../../LogicGraph/WordOp.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Replacing the global operator new counts every allocation in the program, the containers' included.
+static std::atomic<unsigned long long> allocations(0);
+
+//Kept out of line, so the compiler does not inline a free where it sees the pointer came from new.
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE __declspec(noinline)
+#endif
+
+NOINLINE void* operator new(size_t size)
+{
+    ++allocations;
+
+    void* p = std::malloc(size == 0 ? 1 : size);
+
+    if(p == nullptr) throw std::bad_alloc();
+
+    return p;
+}
+
+NOINLINE void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p,size_t) noexcept
+{
+    ::operator delete(p);
+}
+
+typedef LogicGraph::LogicGraph Graph;
+typedef Graph::Key Key;
+
+/// <summary>
+/// Builds a graph of every node kind the hot path walks: gates, inverters, lookup tables,
+/// muxes, a module instance and a word-level cell, each output an OR of a dozen of them.
+/// </summary>
+static Graph buildMixed(unsigned in,unsigned out,std::shared_ptr<const LogicGraph::Module> sub,std::shared_ptr<const LogicGraph::WordOp> word)
+{
+    Graph g(in,out);
+    std::mt19937 r(1);
+
+    auto input = [&](){
+        return g.getInputKey(r() % in);
+    };
+
+    for(unsigned o = 0; o < out; ++o){
+
+        Key top = g.addGate(Graph::Gates::OR);
+
+        for(unsigned j = 0; j < 12; ++j){
+
+            Key a;
+
+            switch(j % 6){
+            case 0:
+                a = g.addGate(Graph::Gates::AND);
+                for(int q = 0; q < 3; ++q) g.connectGates(a,input());
+                break;
+
+            case 1:
+                a = g.addInverter();
+                g.connectGates(a,input());
+                break;
+
+            case 2:
+                a = g.addLut(r());
+                for(int q = 0; q < 4; ++q) g.connectGates(a,input());
+                break;
+
+            case 3:
+                a = g.addMux(1);
+                for(int q = 0; q < 3; ++q) g.connectGates(a,input());
+                break;
+
+            case 4:
+            {
+                Key i = g.addInstance(sub);
+
+                //Buffered, as an instance reads each node once.
+                for(unsigned q = 0; q < sub->getInputCount(); ++q){
+
+                    Key b = g.addGate(Graph::Gates::OR);
+                    g.connectGates(b,input());
+                    g.connectGates(i,b);
+                }
+
+                a = g.getPortKey(i,0);
+                break;
+            }
+
+            default:
+            {
+                Key i = g.addInstance(word);
+
+                for(unsigned q = 0; q < word->getInputCount(); ++q){
+
+                    Key b = g.addGate(Graph::Gates::AND);
+                    g.connectGates(b,input());
+                    g.connectGates(i,b);
+                }
+
+                a = g.getPortKey(i,r() % word->getOutputCount());
+                break;
+            }
+            }
+
+            g.connectGates(top,a);
+        }
+
+        g.openOutput(top,o);
+    }
+
+    return g;
+}
+
+static std::shared_ptr<const LogicGraph::Module> buildMajority()
+{
+    Graph majority(3,1);
+    Key m = majority.addGate(Graph::Gates::MAJORITY);
+
+    for(unsigned i = 0; i < 3; ++i) majority.connectGates(m,majority.getInputKey(i));
+
+    majority.openOutput(m,0);
+
+    return std::make_shared<const LogicGraph::Module>(majority);
+}
+
+static const unsigned IN = 32;
+static const unsigned OUT = 8;
+
+/// <returns>
+/// True if the steady state made no allocation.
+/// </returns>
+static bool testAllocations()
+{
+    std::cout << "ALLOCATION TEST\n\n";
+
+    auto sub = buildMajority();
+    auto word = std::make_shared<const LogicGraph::WordOp>(LogicGraph::WordOp::ADD,4);
+    const unsigned in = IN,out = OUT;
+    Graph g = buildMixed(in,out,sub,word);
+    std::mt19937 r(5);
+    long long sum = 0;
+
+    //Warm up: the first evaluations size the cones, slots and scratch buffers.
+    for(unsigned i = 0; i < 20000; ++i){
+
+        g.setInputVal(r() % in,(r() & 1) != 0);
+        sum += g.getOutput(i % out);
+    }
+
+    unsigned long long before = allocations.load();
+
+    for(unsigned i = 0; i < 10000; ++i){
+
+        g.setInputVal(r() % in,(r() & 1) != 0);
+
+        for(unsigned o = 0; o < out; ++o) sum += g.getOutput(o);
+    }
+
+    unsigned long long made = allocations.load() - before;
+
+    std::cout << "allocations in 10000 set/get rounds: " << made << " (checksum " << sum << ")\n";
+    std::cout << (made == 0 ? "PASS" : "FAIL") << "\n\n";
+
+    return made == 0;
+}
+
+/// <summary>
+/// Runs the hot path on 1, 2, 4 and so on up to every hardware thread, each thread with a graph
+/// of its own. The graphs share their module bodies, as instances in separate graphs do, so this
+/// shows any cache line the threads still contend for; spread over sockets by the scheduler, it
+/// is the multi-socket case. Per thread times should stay flat as threads are added.
+/// </summary>
+static void benchmarkThreads()
+{
+    std::cout << "THREAD SCALING\n\n";
+
+    auto sub = buildMajority();
+    auto word = std::make_shared<const LogicGraph::WordOp>(LogicGraph::WordOp::ADD,4);
+    unsigned most = std::max(1u,std::thread::hardware_concurrency());
+    const unsigned rounds = 200000;
+
+    for(unsigned threads = 1;; threads = std::min(most,threads * 2)){
+
+        std::vector<Graph> graphs;
+
+        for(unsigned t = 0; t < threads; ++t) graphs.push_back(buildMixed(IN,OUT,sub,word));
+
+        std::vector<std::thread> workers;
+        std::atomic<long long> sum(0);
+        auto start = std::chrono::steady_clock::now();
+
+        for(unsigned t = 0; t < threads; ++t){
+
+            workers.emplace_back([&,t](){
+                std::mt19937 r(t);
+                long long s = 0;
+
+                for(unsigned i = 0; i < rounds; ++i){
+
+                    graphs[t].setInputVal(r() % IN,(r() & 1) != 0);
+                    s += graphs[t].getOutput(i % OUT);
+                }
+
+                sum += s;
+            });
+        }
+
+        for(auto& w : workers) w.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << threads << " thread(s): " << seconds * 1e9 / rounds << " ns per set/get per thread, "
+            << threads * rounds / seconds / 1e6 << " M per second in all (checksum " << sum.load() << ")\n";
+
+        if(threads == most) break;
+    }
+
+    std::cout << '\n';
+}
+
+int main()
+{
+    bool passed = testAllocations();
+
+    benchmarkThreads();
+
+    return passed ? 0 : 1;
+}